@@ -0,0 +1,428 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+// ============================================================================
+// MICROBENCHMARK: COLA DE EVENTOS LISTA / HEAP 4-ARIO / CALENDARIO
+// ============================================================================
+//
+// Compara la lista doblemente enlazada ordenada (implementación original),
+// el heap 4-ario con desempate FIFO (paraleloPrueba.c) y la cola calendario
+// con cubetas de ancho paso_simulacion (estados2.c) usando el modelo "hold":
+// con N eventos pendientes se extrae el siguiente evento y se reprograma un
+// nuevo evento a tiempo actual + incremento aleatorio.
+//
+// Compilar: gcc -O2 -o benchColaEventos benchColaEventos.c -lm
+
+typedef struct {
+    double tiempo;
+    int tipo;
+    int id_auto;
+    int direccion;
+    void* vehiculo;
+    int prioridad;
+} Evento;
+
+// ============================================================================
+// IMPLEMENTACIÓN 1: LISTA DOBLEMENTE ENLAZADA ORDENADA
+// ============================================================================
+
+typedef struct Nodo {
+    Evento evento;
+    struct Nodo* siguiente;
+    struct Nodo* anterior;
+} Nodo;
+
+typedef struct {
+    Nodo* inicio;
+    Nodo* fin;
+    int size;
+} ColaLista;
+
+void lista_insertar(ColaLista* cola, Evento evento) {
+    Nodo* nuevo = (Nodo*)malloc(sizeof(Nodo));
+    if (!nuevo) return;
+
+    nuevo->evento = evento;
+    nuevo->siguiente = nuevo->anterior = NULL;
+
+    if (!cola->inicio) {
+        cola->inicio = cola->fin = nuevo;
+    } else if (evento.tiempo >= cola->fin->evento.tiempo) {
+        nuevo->anterior = cola->fin;
+        cola->fin->siguiente = nuevo;
+        cola->fin = nuevo;
+    } else if (evento.tiempo < cola->inicio->evento.tiempo) {
+        nuevo->siguiente = cola->inicio;
+        cola->inicio->anterior = nuevo;
+        cola->inicio = nuevo;
+    } else {
+        Nodo* actual = cola->fin;
+        while (actual && actual->evento.tiempo > evento.tiempo) {
+            actual = actual->anterior;
+        }
+
+        nuevo->siguiente = actual->siguiente;
+        nuevo->anterior = actual;
+        if (actual->siguiente) actual->siguiente->anterior = nuevo;
+        else cola->fin = nuevo;
+        actual->siguiente = nuevo;
+    }
+    cola->size++;
+}
+
+int lista_extraer(ColaLista* cola, Evento* salida) {
+    if (!cola->inicio) return 0;
+
+    Nodo* nodo = cola->inicio;
+    *salida = nodo->evento;
+
+    cola->inicio = nodo->siguiente;
+    if (cola->inicio) cola->inicio->anterior = NULL;
+    else cola->fin = NULL;
+
+    free(nodo);
+    cola->size--;
+    return 1;
+}
+
+void lista_destruir(ColaLista* cola) {
+    Evento e;
+    while (lista_extraer(cola, &e));
+}
+
+// ============================================================================
+// IMPLEMENTACIÓN 2: HEAP 4-ARIO CON DESEMPATE FIFO
+// ============================================================================
+
+#define ARIDAD_HEAP 4
+
+typedef struct {
+    Evento evento;
+    unsigned long long secuencia;
+} EntradaHeap;
+
+typedef struct {
+    EntradaHeap* datos;
+    int capacidad;
+    int size;
+    unsigned long long siguiente_secuencia;
+} ColaHeap;
+
+static inline int entrada_precede(const EntradaHeap* a, const EntradaHeap* b) {
+    if (a->evento.tiempo != b->evento.tiempo) {
+        return a->evento.tiempo < b->evento.tiempo;
+    }
+    return a->secuencia < b->secuencia;
+}
+
+void heap_insertar(ColaHeap* cola, Evento evento) {
+    if (cola->size == cola->capacidad) {
+        int nueva_capacidad = cola->capacidad > 0 ? cola->capacidad * 2 : 256;
+        EntradaHeap* nuevos = (EntradaHeap*)realloc(cola->datos, nueva_capacidad * sizeof(EntradaHeap));
+        if (!nuevos) return;
+        cola->datos = nuevos;
+        cola->capacidad = nueva_capacidad;
+    }
+
+    EntradaHeap nueva = {evento, cola->siguiente_secuencia++};
+    int i = cola->size;
+    while (i > 0) {
+        int padre = (i - 1) / ARIDAD_HEAP;
+        if (!entrada_precede(&nueva, &cola->datos[padre])) break;
+        cola->datos[i] = cola->datos[padre];
+        i = padre;
+    }
+    cola->datos[i] = nueva;
+    cola->size++;
+}
+
+int heap_extraer(ColaHeap* cola, Evento* salida) {
+    if (cola->size == 0) return 0;
+
+    *salida = cola->datos[0].evento;
+    cola->size--;
+    if (cola->size > 0) {
+        EntradaHeap ultima = cola->datos[cola->size];
+        int i = 0;
+        while (1) {
+            int primer_hijo = i * ARIDAD_HEAP + 1;
+            if (primer_hijo >= cola->size) break;
+
+            int menor = primer_hijo;
+            int fin_hijos = primer_hijo + ARIDAD_HEAP;
+            if (fin_hijos > cola->size) fin_hijos = cola->size;
+            for (int h = primer_hijo + 1; h < fin_hijos; h++) {
+                if (entrada_precede(&cola->datos[h], &cola->datos[menor])) menor = h;
+            }
+
+            if (!entrada_precede(&cola->datos[menor], &ultima)) break;
+            cola->datos[i] = cola->datos[menor];
+            i = menor;
+        }
+        cola->datos[i] = ultima;
+    }
+    return 1;
+}
+
+void heap_destruir(ColaHeap* cola) {
+    free(cola->datos);
+    cola->datos = NULL;
+    cola->size = cola->capacidad = 0;
+}
+
+// ============================================================================
+// IMPLEMENTACIÓN 3: COLA CALENDARIO (MISMA LÓGICA QUE estados2.c)
+// ============================================================================
+
+#define ANCHO_CUBETA 0.05
+
+typedef struct {
+    Nodo** inicio;
+    Nodo** fin;
+    int num_cubetas;
+    long long cubeta_actual;
+    int size;
+} ColaCalendario;
+
+void insertar_nodo_ordenado(Nodo** inicio, Nodo** fin, Nodo* nuevo) {
+    double tiempo = nuevo->evento.tiempo;
+
+    if (!*inicio) {
+        *inicio = *fin = nuevo;
+    } else if (tiempo >= (*fin)->evento.tiempo) {
+        nuevo->anterior = *fin;
+        (*fin)->siguiente = nuevo;
+        *fin = nuevo;
+    } else if (tiempo < (*inicio)->evento.tiempo) {
+        nuevo->siguiente = *inicio;
+        (*inicio)->anterior = nuevo;
+        *inicio = nuevo;
+    } else {
+        Nodo* actual = *fin;
+        while (actual && actual->evento.tiempo > tiempo) {
+            actual = actual->anterior;
+        }
+
+        nuevo->siguiente = actual->siguiente;
+        nuevo->anterior = actual;
+        if (actual->siguiente) actual->siguiente->anterior = nuevo;
+        else *fin = nuevo;
+        actual->siguiente = nuevo;
+    }
+}
+
+Nodo* extraer_primer_nodo(Nodo** inicio, Nodo** fin) {
+    Nodo* nodo = *inicio;
+    *inicio = nodo->siguiente;
+    if (*inicio) (*inicio)->anterior = NULL;
+    else *fin = NULL;
+    return nodo;
+}
+
+long long cubeta_virtual(double tiempo) {
+    return (long long)floor(tiempo / ANCHO_CUBETA);
+}
+
+void calendario_redimensionar(ColaCalendario* cola) {
+    int nuevas = cola->num_cubetas * 2;
+    Nodo** nuevos_inicio = (Nodo**)calloc(nuevas, sizeof(Nodo*));
+    Nodo** nuevos_fin = (Nodo**)calloc(nuevas, sizeof(Nodo*));
+    if (!nuevos_inicio || !nuevos_fin) {
+        free(nuevos_inicio);
+        free(nuevos_fin);
+        return;
+    }
+
+    for (int i = 0; i < cola->num_cubetas; i++) {
+        while (cola->inicio[i]) {
+            Nodo* nodo = extraer_primer_nodo(&cola->inicio[i], &cola->fin[i]);
+            int indice = (int)(cubeta_virtual(nodo->evento.tiempo) & (nuevas - 1));
+            nodo->siguiente = nodo->anterior = NULL;
+            insertar_nodo_ordenado(&nuevos_inicio[indice], &nuevos_fin[indice], nodo);
+        }
+    }
+
+    free(cola->inicio);
+    free(cola->fin);
+    cola->inicio = nuevos_inicio;
+    cola->fin = nuevos_fin;
+    cola->num_cubetas = nuevas;
+}
+
+void calendario_insertar(ColaCalendario* cola, Evento evento) {
+    if (!cola->inicio) {
+        cola->num_cubetas = 512;
+        cola->inicio = (Nodo**)calloc(cola->num_cubetas, sizeof(Nodo*));
+        cola->fin = (Nodo**)calloc(cola->num_cubetas, sizeof(Nodo*));
+    }
+    if (cola->size >= 2 * cola->num_cubetas) {
+        calendario_redimensionar(cola);
+    }
+
+    Nodo* nuevo = (Nodo*)malloc(sizeof(Nodo));
+    if (!nuevo) return;
+    nuevo->evento = evento;
+    nuevo->siguiente = nuevo->anterior = NULL;
+
+    long long virtual = cubeta_virtual(evento.tiempo);
+    int indice = (int)(virtual & (cola->num_cubetas - 1));
+    insertar_nodo_ordenado(&cola->inicio[indice], &cola->fin[indice], nuevo);
+
+    if (cola->size == 0 || virtual < cola->cubeta_actual) {
+        cola->cubeta_actual = virtual;
+    }
+    cola->size++;
+}
+
+int calendario_extraer(ColaCalendario* cola, Evento* salida) {
+    if (cola->size == 0) return 0;
+
+    Nodo* nodo = NULL;
+    for (int n = 0; n < cola->num_cubetas && !nodo; n++) {
+        int indice = (int)(cola->cubeta_actual & (cola->num_cubetas - 1));
+        Nodo* primero = cola->inicio[indice];
+        if (primero && cubeta_virtual(primero->evento.tiempo) == cola->cubeta_actual) {
+            nodo = extraer_primer_nodo(&cola->inicio[indice], &cola->fin[indice]);
+        } else {
+            cola->cubeta_actual++;
+        }
+    }
+
+    if (!nodo) {
+        int indice_min = -1;
+        for (int i = 0; i < cola->num_cubetas; i++) {
+            Nodo* primero = cola->inicio[i];
+            if (primero && (indice_min < 0 ||
+                            primero->evento.tiempo < cola->inicio[indice_min]->evento.tiempo)) {
+                indice_min = i;
+            }
+        }
+        cola->cubeta_actual = cubeta_virtual(cola->inicio[indice_min]->evento.tiempo);
+        nodo = extraer_primer_nodo(&cola->inicio[indice_min], &cola->fin[indice_min]);
+    }
+
+    *salida = nodo->evento;
+    free(nodo);
+    cola->size--;
+    return 1;
+}
+
+void calendario_destruir(ColaCalendario* cola) {
+    Evento e;
+    while (calendario_extraer(cola, &e));
+    free(cola->inicio);
+    free(cola->fin);
+    cola->inicio = cola->fin = NULL;
+}
+
+// ============================================================================
+// GENERADOR DE INCREMENTOS Y MEDICIÓN
+// ============================================================================
+
+// Mezcla de incrementos parecida a la simulación: la mayoría son pasos fijos
+// de 0.05 s (ACTUALIZACION_VEHICULO) y el resto entradas/reintentos aleatorios.
+static unsigned int semilla_bench = 12345u;
+
+double siguiente_incremento() {
+    semilla_bench = semilla_bench * 1103515245u + 12345u;
+    unsigned int r = (semilla_bench >> 8) % 100;
+    if (r < 90) return 0.05;
+    return 0.1 + (double)((semilla_bench >> 4) % 1000) / 100.0;
+}
+
+double segundos_desde(clock_t inicio) {
+    return (double)(clock() - inicio) / CLOCKS_PER_SEC;
+}
+
+double medir_lista(int pendientes, int operaciones) {
+    ColaLista cola = {0};
+    semilla_bench = 12345u;
+
+    for (int i = 0; i < pendientes; i++) {
+        Evento e = {i * 0.001, 2, i, 0, NULL, 0};
+        lista_insertar(&cola, e);
+    }
+
+    clock_t inicio = clock();
+    Evento e;
+    for (int i = 0; i < operaciones; i++) {
+        lista_extraer(&cola, &e);
+        e.tiempo += siguiente_incremento();
+        lista_insertar(&cola, e);
+    }
+    double segundos = segundos_desde(inicio);
+
+    lista_destruir(&cola);
+    return segundos * 1e9 / operaciones;
+}
+
+double medir_heap(int pendientes, int operaciones) {
+    ColaHeap cola = {0};
+    semilla_bench = 12345u;
+
+    for (int i = 0; i < pendientes; i++) {
+        Evento e = {i * 0.001, 2, i, 0, NULL, 0};
+        heap_insertar(&cola, e);
+    }
+
+    clock_t inicio = clock();
+    Evento e;
+    for (int i = 0; i < operaciones; i++) {
+        heap_extraer(&cola, &e);
+        e.tiempo += siguiente_incremento();
+        heap_insertar(&cola, e);
+    }
+    double segundos = segundos_desde(inicio);
+
+    heap_destruir(&cola);
+    return segundos * 1e9 / operaciones;
+}
+
+double medir_calendario(int pendientes, int operaciones) {
+    ColaCalendario cola = {0};
+    semilla_bench = 12345u;
+
+    for (int i = 0; i < pendientes; i++) {
+        Evento e = {i * 0.001, 2, i, 0, NULL, 0};
+        calendario_insertar(&cola, e);
+    }
+
+    clock_t inicio = clock();
+    Evento e;
+    for (int i = 0; i < operaciones; i++) {
+        calendario_extraer(&cola, &e);
+        e.tiempo += siguiente_incremento();
+        calendario_insertar(&cola, e);
+    }
+    double segundos = segundos_desde(inicio);
+
+    calendario_destruir(&cola);
+    return segundos * 1e9 / operaciones;
+}
+
+int main() {
+    int tamanos[] = {1000, 10000, 100000, 1000000};
+    int num_tamanos = sizeof(tamanos) / sizeof(tamanos[0]);
+
+    printf("=== MICROBENCHMARK COLA DE EVENTOS (modelo hold) ===\n");
+    printf("%10s | %14s | %14s | %14s\n", "Pendientes", "Lista (ns/op)", "Heap (ns/op)", "Calend. (ns/op)");
+    printf("-----------|----------------|----------------|----------------\n");
+
+    for (int i = 0; i < num_tamanos; i++) {
+        int n = tamanos[i];
+
+        // La lista es O(N) por inserción: limitar operaciones en tamaños grandes
+        int ops_lista = 200000000 / n;
+        int ops_heap = 2000000;
+
+        double ns_lista = medir_lista(n, ops_lista);
+        double ns_heap = medir_heap(n, ops_heap);
+        double ns_calendario = medir_calendario(n, ops_heap);
+
+        printf("%10d | %14.1f | %14.1f | %14.1f\n", n, ns_lista, ns_heap, ns_calendario);
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lectorTrazas.h"
+
+// ============================================================================
+// CONSULTA DE TRAZAS DE ESTADOS (.csv o .trz)
+// ============================================================================
+//
+// Extrae un vehículo y/o una ventana de tiempo de una traza usando el índice
+// de lectorTrazas.h (se construye la primera vez y se guarda como .idx).
+// El resultado sale en el formato CSV de estados, con su encabezado.
+//
+// Compilar: gcc -O2 -o consultaTrazas consultaTrazas.c -pthread -lm
+// Ejemplos:
+//   ./consultaTrazas estados_20250901_194627.csv --vehiculo 1042 --desde 300 --hasta 400
+//   ./consultaTrazas estados_interseccion_X.trz --en 1200 --salida t1200.csv
+//   ./consultaTrazas estados_20250901_194627.csv --info
+
+void escribir_entrada(const LectorTrazas* l, const EntradaTraza* e, void* contexto) {
+    lector_trazas_escribir_csv(l, e, (FILE*)contexto);
+}
+
+void mostrar_uso(const char* programa) {
+    fprintf(stderr,
+            "Uso: %s traza [opciones]\n"
+            "  --vehiculo ID     solo ese vehículo\n"
+            "  --desde T         tiempo inicial en segundos\n"
+            "  --hasta T         tiempo final en segundos\n"
+            "  --en T            solo el instante T (--desde T --hasta T)\n"
+            "  --salida ARCHIVO  escribir el CSV en ARCHIVO en vez de la salida estándar\n"
+            "  --reindexar       reconstruir el índice aunque exista\n"
+            "  --info            resumen de la traza y del índice\n",
+            programa);
+}
+
+void mostrar_info(const LectorTrazas* l) {
+    int32_t tiempo_min = INT32_MAX, tiempo_max = INT32_MIN;
+    for (uint64_t b = 0; b < l->indice.num_bloques; b++) {
+        if (l->bloques[b].tiempo_min < tiempo_min) tiempo_min = l->bloques[b].tiempo_min;
+        if (l->bloques[b].tiempo_max > tiempo_max) tiempo_max = l->bloques[b].tiempo_max;
+    }
+
+    printf("Formato: %s\n", (l->formato == FORMATO_TRAZA_BINARIO) ? "binario .trz" : "CSV");
+    printf("Tamaño: %.1f MB\n", l->tam / (1024.0 * 1024.0));
+    printf("Columnas: %s\n", l->columnas_csv);
+    printf("Registros: %llu en %llu bloques de %d\n",
+           (unsigned long long)l->indice.num_registros,
+           (unsigned long long)l->indice.num_bloques, LECTOR_REGISTROS_POR_BLOQUE);
+    if (tiempo_min <= tiempo_max) {
+        printf("Tiempo: %.2f - %.2f s\n", traza_desde_centesimas(tiempo_min), traza_desde_centesimas(tiempo_max));
+        printf("IDs: %d - %d\n", l->indice.id_min, l->indice.id_max);
+    }
+    printf("Índice: %.1f MB\n", l->tam_memoria_indice / (1024.0 * 1024.0));
+    if (l->texto[0]) {
+        printf("--- Encabezado ---\n%s", l->texto);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        mostrar_uso(argv[0]);
+        return 1;
+    }
+
+    const char* ruta = argv[1];
+    const char* ruta_salida = NULL;
+    int32_t id = -1;
+    double desde = -1e9, hasta = 1e9;
+    int hay_tiempo = 0, reindexar = 0, info = 0;
+
+    for (int a = 2; a < argc; a++) {
+        int hay_valor = (a + 1 < argc);
+        if (strcmp(argv[a], "--vehiculo") == 0 && hay_valor) {
+            id = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--desde") == 0 && hay_valor) {
+            desde = atof(argv[++a]);
+            hay_tiempo = 1;
+        } else if (strcmp(argv[a], "--hasta") == 0 && hay_valor) {
+            hasta = atof(argv[++a]);
+            hay_tiempo = 1;
+        } else if (strcmp(argv[a], "--en") == 0 && hay_valor) {
+            desde = hasta = atof(argv[++a]);
+            hay_tiempo = 1;
+        } else if (strcmp(argv[a], "--salida") == 0 && hay_valor) {
+            ruta_salida = argv[++a];
+        } else if (strcmp(argv[a], "--reindexar") == 0) {
+            reindexar = 1;
+        } else if (strcmp(argv[a], "--info") == 0) {
+            info = 1;
+        } else {
+            mostrar_uso(argv[0]);
+            return 1;
+        }
+    }
+    if (id < 0 && !hay_tiempo) info = 1;
+
+    LectorTrazas lector;
+    if (!lector_trazas_abrir(&lector, ruta, reindexar ? LECTOR_REINDEXAR : LECTOR_CON_INDICE)) {
+        fprintf(stderr, "ERROR: no se pudo abrir o indexar %s\n", ruta);
+        return 1;
+    }
+    fprintf(stderr, "Índice %s en %.1f ms\n",
+            lector.indice_cargado ? "cargado" : "construido", lector.segundos_indice * 1000.0);
+
+    if (info) {
+        mostrar_info(&lector);
+        lector_trazas_cerrar(&lector);
+        return 0;
+    }
+
+    // Binario: la salida tiene los mismos bytes ('\n') en todas las plataformas
+    FILE* salida = stdout;
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    if (ruta_salida) {
+        salida = fopen(ruta_salida, "wb");
+        if (!salida) {
+            perror(ruta_salida);
+            lector_trazas_cerrar(&lector);
+            return 1;
+        }
+    }
+    setvbuf(salida, NULL, _IOFBF, 1 << 20);
+    fprintf(salida, "%s\n", lector.columnas_csv);
+
+    // Límites en centésimas, saturados al rango de int32
+    int32_t desde_cs = (desde < -2e7) ? INT32_MIN : traza_centesimas(desde);
+    int32_t hasta_cs = (hasta > 2e7) ? INT32_MAX : traza_centesimas(hasta);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long long encontrados = (id >= 0)
+        ? lector_trazas_por_vehiculo(&lector, id, desde_cs, hasta_cs, escribir_entrada, salida)
+        : lector_trazas_por_tiempo(&lector, desde_cs, hasta_cs, escribir_entrada, salida);
+    fflush(salida);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    fprintf(stderr, "%lld registros en %.2f ms\n", encontrados,
+            ((t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9) * 1000.0);
+
+    if (ruta_salida) fclose(salida);
+    lector_trazas_cerrar(&lector);
+    return 0;
+}
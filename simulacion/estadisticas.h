@@ -0,0 +1,196 @@
+#ifndef ESTADISTICAS_H
+#define ESTADISTICAS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// ESTADÍSTICAS EN FLUJO
+// ============================================================================
+//
+// Cada métrica se actualiza una vez por vehículo al salir, con memoria fija:
+//  - media y varianza por Welford, mínimo y máximo;
+//  - histograma log-lineal estilo HDR: cubetas de ancho 1 centésima hasta
+//    2 * HDR_SUBCUBETAS y después HDR_SUBCUBETAS por octava, con error
+//    relativo menor que 1/HDR_SUBCUBETAS.
+//
+// Los cuantiles (p50/p95/p99) salen del histograma y heredan su error. Un
+// estimador P² ocupa menos, pero con pocos cientos de vehículos y tiempos
+// bimodales (los que pasan en verde y los que esperan) se desvía más de un
+// 20% en p95 y no se puede fusionar.
+//
+// Dos métricas se fusionan sumando histogramas y combinando los momentos
+// (Chan et al.), así que cada thread puede llevar las suyas.
+//
+// Entre réplicas independientes, la media de cada réplica es una
+// observación y el intervalo de confianza de la media sale de t de Student.
+//
+// Uso compartido por estados2.c, paraleloPrueba.c y redCuadricula.c.
+
+#define HDR_BITS_SUBCUBETA 7
+#define HDR_SUBCUBETAS (1 << HDR_BITS_SUBCUBETA)   // Por octava
+#define HDR_OCTAVAS 26                               // Hasta ~1.7e8 en centésimas
+#define HDR_NUM_CUBETAS (2 * HDR_SUBCUBETAS + HDR_OCTAVAS * HDR_SUBCUBETAS)
+#define HDR_RESOLUCION 0.01                          // Unidad de la cubeta 0
+
+typedef struct {
+    long long n;
+    double media;
+    double m2;        // Suma de cuadrados de las desviaciones
+    double minimo;
+    double maximo;
+    uint32_t cubetas[HDR_NUM_CUBETAS];
+} EstadisticaFlujo;
+
+// ----------------------------------------------------------------------------
+// Histograma
+// ----------------------------------------------------------------------------
+
+static inline int hdr_indice(double x) {
+    if (!(x > 0.0)) return 0;
+    double unidades = floor(x / HDR_RESOLUCION + 1e-9);  // 2.55 cae en la cubeta 255
+    uint64_t maximo = (uint64_t)1 << (HDR_BITS_SUBCUBETA + 1 + HDR_OCTAVAS);
+    uint64_t v = (unidades >= (double)maximo) ? maximo - 1 : (uint64_t)unidades;
+    if (v < 2 * HDR_SUBCUBETAS) return (int)v;
+
+    int bit_alto = 63 - __builtin_clzll(v);
+    int desplazamiento = bit_alto - HDR_BITS_SUBCUBETA;
+    return 2 * HDR_SUBCUBETAS + (desplazamiento - 1) * HDR_SUBCUBETAS +
+           (int)((v >> desplazamiento) - HDR_SUBCUBETAS);
+}
+
+// Rango [desde, hasta) que cubre una cubeta, en las unidades de la métrica
+static inline void hdr_rango(int indice, double* desde, double* hasta) {
+    if (indice < 2 * HDR_SUBCUBETAS) {
+        *desde = indice * HDR_RESOLUCION;
+        *hasta = (indice + 1) * HDR_RESOLUCION;
+        return;
+    }
+    int j = indice - 2 * HDR_SUBCUBETAS;
+    int desplazamiento = j / HDR_SUBCUBETAS + 1;
+    uint64_t inicio = (uint64_t)(HDR_SUBCUBETAS + j % HDR_SUBCUBETAS) << desplazamiento;
+    *desde = inicio * HDR_RESOLUCION;
+    *hasta = (inicio + ((uint64_t)1 << desplazamiento)) * HDR_RESOLUCION;
+}
+
+// ----------------------------------------------------------------------------
+// Métrica
+// ----------------------------------------------------------------------------
+
+static inline void estadistica_iniciar(EstadisticaFlujo* e) {
+    memset(e, 0, sizeof(EstadisticaFlujo));
+}
+
+static inline void estadistica_agregar(EstadisticaFlujo* e, double x) {
+    e->n++;
+    double delta = x - e->media;
+    e->media += delta / e->n;
+    e->m2 += delta * (x - e->media);
+    if (e->n == 1 || x < e->minimo) e->minimo = x;
+    if (e->n == 1 || x > e->maximo) e->maximo = x;
+    e->cubetas[hdr_indice(x)]++;
+}
+
+// Acumula 'origen' en 'destino'
+static inline void estadistica_fusionar(EstadisticaFlujo* destino, const EstadisticaFlujo* origen) {
+    if (origen->n == 0) return;
+    if (destino->n == 0) {
+        *destino = *origen;
+        return;
+    }
+
+    long long n = destino->n + origen->n;
+    double delta = origen->media - destino->media;
+    destino->media += delta * origen->n / n;
+    destino->m2 += origen->m2 + delta * delta * ((double)destino->n * origen->n / n);
+    destino->n = n;
+    if (origen->minimo < destino->minimo) destino->minimo = origen->minimo;
+    if (origen->maximo > destino->maximo) destino->maximo = origen->maximo;
+
+    for (int i = 0; i < HDR_NUM_CUBETAS; i++) destino->cubetas[i] += origen->cubetas[i];
+}
+
+static inline double estadistica_varianza(const EstadisticaFlujo* e) {
+    return (e->n > 1) ? e->m2 / (e->n - 1) : 0.0;
+}
+
+static inline double estadistica_desviacion(const EstadisticaFlujo* e) {
+    return sqrt(estadistica_varianza(e));
+}
+
+// Cuantil 0.975 de t de Student con 'grados' grados de libertad; más allá
+// de la tabla, Cornish-Fisher (error menor que 0.001)
+static inline double t_student_975(long long grados) {
+    static const double tabla[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (grados < 1) return INFINITY;
+    if (grados <= 30) return tabla[grados - 1];
+    double g = (double)grados;
+    return 1.959964 + 2.372 / g + 2.823 / (g * g);
+}
+
+// Semiancho del intervalo de confianza del 95% de la media
+static inline double estadistica_ic95(const EstadisticaFlujo* e) {
+    if (e->n < 2) return 0.0;
+    return t_student_975(e->n - 1) * estadistica_desviacion(e) / sqrt((double)e->n);
+}
+
+// Cuantil p: punto medio de la cubeta que contiene el rango ceil(p * n)
+static inline double estadistica_cuantil(const EstadisticaFlujo* e, double p) {
+    if (e->n == 0) return 0.0;
+    long long rango = (long long)ceil(p * e->n);
+    if (rango < 1) rango = 1;
+
+    long long acumulado = 0;
+    for (int i = 0; i < HDR_NUM_CUBETAS; i++) {
+        acumulado += e->cubetas[i];
+        if (acumulado >= rango) {
+            double desde, hasta;
+            hdr_rango(i, &desde, &hasta);
+            double valor = (desde + hasta) / 2.0;
+            if (valor < e->minimo) valor = e->minimo;
+            if (valor > e->maximo) valor = e->maximo;
+            return valor;
+        }
+    }
+    return e->maximo;
+}
+
+// ----------------------------------------------------------------------------
+// Salida
+// ----------------------------------------------------------------------------
+
+static inline void estadistica_imprimir(const char* nombre, const EstadisticaFlujo* e, const char* unidad) {
+    if (e->n == 0) return;
+    printf("  %-22s media %7.2f %s (desv %.2f)  min %.2f  max %.2f  p50 %.2f  p95 %.2f  p99 %.2f\n",
+           nombre, e->media, unidad, estadistica_desviacion(e), e->minimo, e->maximo,
+           estadistica_cuantil(e, 0.50), estadistica_cuantil(e, 0.95), estadistica_cuantil(e, 0.99));
+}
+
+static inline void estadistica_csv_encabezado(FILE* csv) {
+    fprintf(csv, "Grupo,Metrica,N,Media,Desviacion,Minimo,Maximo,P50,P95,P99\n");
+}
+
+static inline void estadistica_csv(FILE* csv, const char* grupo, const char* nombre, const EstadisticaFlujo* e) {
+    fprintf(csv, "%s,%s,%lld,%.4f,%.4f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+            grupo, nombre, e->n, e->media, estadistica_desviacion(e), e->minimo, e->maximo,
+            estadistica_cuantil(e, 0.50), estadistica_cuantil(e, 0.95), estadistica_cuantil(e, 0.99));
+}
+
+// Cubetas no vacías del histograma
+static inline void estadistica_csv_histograma(FILE* csv, const char* grupo, const char* nombre,
+                                              const EstadisticaFlujo* e) {
+    for (int i = 0; i < HDR_NUM_CUBETAS; i++) {
+        if (e->cubetas[i] == 0) continue;
+        double desde, hasta;
+        hdr_rango(i, &desde, &hasta);
+        fprintf(csv, "%s,%s,%.2f,%.2f,%u\n", grupo, nombre, desde, hasta, e->cubetas[i]);
+    }
+}
+
+#endif
@@ -3,6 +3,8 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include "trazas.h"
+#include "estadisticas.h"
 
 // ============================================================================
 // DEFINICIÓN DE CONSTANTES ESCALABLES
@@ -11,6 +13,29 @@
 #define ENTRADA 0
 #define SALIDA 1
 #define ACTUALIZACION_VEHICULO 2
+#define SEMAFORO_CAMBIO 3
+
+// Implementaciones de la cola de eventos
+#define COLA_LISTA 0
+#define COLA_CALENDARIO 1
+
+// Avance de los vehículos en flujo libre
+#define AVANCE_PASO_FIJO 0   // Una actualización por paso_simulacion
+#define AVANCE_ANALITICO 1   // Un evento por interacción (líder, semáforo, salida)
+
+// Motivo por el que un vehículo detenido no genera eventos
+#define ESPERA_NINGUNA 0
+#define ESPERA_SEMAFORO 1    // En la lista del semáforo hasta que deje el rojo
+#define ESPERA_LIDER 2       // Hasta que su líder avance lo suficiente
+
+// Rangos de interacción entre vehículos
+#define MAX_AUTOS_CONFIGURABLE 1000000000
+#define MAX_AUTOS_POR_DEFECTO 50
+#define TIEMPO_LIMITE_MAXIMO 604800.0   // Una semana simulada
+#define CAPACIDAD_INICIAL_VEHICULOS 64  // El arreglo de activos crece por duplicación
+
+#define RANGO_BUSQUEDA_LIDER 50.0
+#define RANGO_DENSIDAD 30.0
 
 // Parámetros configurables de simulación
 typedef struct {
@@ -19,9 +44,12 @@ typedef struct {
     double longitud_total;
     double posicion_semaforo;
     double paso_simulacion;
-    int max_autos;
+    int max_autos;                      // 0 = sin tope (llegadas hasta tiempo_limite_simulacion)
     double intervalo_entrada_vehiculos;
-    double tiempo_limite_simulacion;
+    double tiempo_limite_simulacion;    // Cierre de las llegadas; 0 = sin límite
+    int tipo_cola_eventos;  // COLA_LISTA o COLA_CALENDARIO
+    int formato_trazas;     // FORMATO_TRAZA_CSV o FORMATO_TRAZA_BINARIO
+    int modo_avance;        // AVANCE_PASO_FIJO o AVANCE_ANALITICO
 } ConfiguracionSimulacion;
 
 // Configuración por defecto
@@ -31,9 +59,12 @@ ConfiguracionSimulacion config = {
     .longitud_total = 200.0,
     .posicion_semaforo = 150.0,
     .paso_simulacion = 0.05,
-    .max_autos = 50,
+    .max_autos = MAX_AUTOS_POR_DEFECTO,
     .intervalo_entrada_vehiculos = 2.0,
-    .tiempo_limite_simulacion = 0.0  // 0 = sin límite de tiempo
+    .tiempo_limite_simulacion = 0.0,  // 0 = llegan los max_autos sin límite de tiempo
+    .tipo_cola_eventos = COLA_CALENDARIO,
+    .formato_trazas = FORMATO_TRAZA_CSV,
+    .modo_avance = AVANCE_PASO_FIJO
 };
 
 // ============================================================================
@@ -56,7 +87,7 @@ typedef enum {
     ROJO
 } EstadoSemaforo;
 
-typedef struct {
+typedef struct Vehiculo {
     int id;
     double posicion;
     int seccion;
@@ -80,6 +111,21 @@ typedef struct {
     // Campos para debugging
     int actualizaciones_count;
     double ultimo_cambio_estado;
+    
+    // Fila de la calle: sin rebases, el orden de entrada es el de posición
+    struct Vehiculo* lider;     // Vehículo inmediatamente adelante
+    struct Vehiculo* seguidor;  // Vehículo inmediatamente atrás
+    int indice_activo;          // Posición en vehiculos_activos
+    
+    // Avance analítico: pasos a velocidad constante aún sin aplicar, contados
+    // desde inicio_libre. Mientras tanto seccion es -1 (fuera del índice).
+    long long pasos_libres;
+    double inicio_libre;
+    
+    // Espera detenida: pasos acreditados desde inicio_libre al despertar
+    int espera;                        // ESPERA_*
+    int despertar_programado;          // Ya tiene su evento de despertar
+    struct Vehiculo* siguiente_espera; // Lista de espera del semáforo
 } Vehiculo;
 
 typedef struct {
@@ -97,10 +143,23 @@ typedef struct Nodo {
 } Nodo;
 
 typedef struct {
+    int tipo; // COLA_LISTA o COLA_CALENDARIO
+    
+    // Lista enlazada ordenada
     Nodo* inicio;
     Nodo* fin;
+    
+    // Cola calendario: cubetas de ancho fijo, cada una una lista ordenada
+    Nodo** cubetas_inicio;
+    Nodo** cubetas_fin;
+    int num_cubetas;           // Potencia de 2
+    double ancho_cubeta;
+    long long cubeta_actual;   // Cubeta virtual (sin modulo) del último evento extraído
+    
+    Nodo* libres; // Nodos reciclados para evitar malloc/free por evento
     int size;
     int max_size_alcanzado;
+    int asignaciones_cola; // Llamadas a malloc hechas por la cola (solo sus nodos y cubetas)
 } ColaEventos;
 
 // Sistema escalable con arrays dinámicos
@@ -108,8 +167,15 @@ typedef struct {
     Vehiculo** vehiculos_activos;
     int num_vehiculos_activos;
     int capacidad_vehiculos;
+    Vehiculo* primero_fila;  // El más adelantado
+    Vehiculo* ultimo_fila;   // El más cercano a la entrada
     double tiempo_actual;
     
+    // Índice espacial por secciones de config.longitud_seccion metros
+    int* ocupacion_seccion;            // Vehículos en cada sección
+    Vehiculo** cabeza_seccion;         // Vehículo más adelantado de cada sección
+    double* tiempo_ocupacion_seccion;  // Vehículo-segundos acumulados por sección
+    
     // Estadísticas del sistema
     int total_vehiculos_creados;
     int total_vehiculos_completados;
@@ -134,10 +200,12 @@ typedef struct {
 typedef struct {
     double ultimo_cambio;
     EstadoSemaforo estado;
+    double proximo_cambio;       // Instante del siguiente SEMAFORO_CAMBIO
     double duracion_verde;
     double duracion_amarillo;
     double duracion_rojo;
     int ciclos_completados;
+    struct Vehiculo* en_espera; // Vehículos detenidos esperando el verde
 } SemaforoControl;
 
 // ============================================================================
@@ -170,15 +238,26 @@ SemaforoControl semaforo = {
 // ============================================================================
 
 void inicializar_sistema() {
-    calle.capacidad_vehiculos = config.max_autos + 10; // Buffer extra
+    calle.capacidad_vehiculos = CAPACIDAD_INICIAL_VEHICULOS;
     calle.vehiculos_activos = (Vehiculo**)calloc(calle.capacidad_vehiculos, sizeof(Vehiculo*));
     calle.num_vehiculos_activos = 0;
+    calle.primero_fila = NULL;
+    calle.ultimo_fila = NULL;
     calle.total_vehiculos_creados = 0;
     calle.total_vehiculos_completados = 0;
+    // Las secciones cubren toda la calle aunque cambie longitud_total
+    config.num_secciones = (int)ceil(config.longitud_total / config.longitud_seccion);
+    if (config.num_secciones < 1) config.num_secciones = 1;
+    calle.ocupacion_seccion = (int*)calloc(config.num_secciones, sizeof(int));
+    calle.cabeza_seccion = (Vehiculo**)calloc(config.num_secciones, sizeof(Vehiculo*));
+    calle.tiempo_ocupacion_seccion = (double*)calloc(config.num_secciones, sizeof(double));
+    
     calle.memoria_utilizada = sizeof(SistemaCalle) + 
-                             calle.capacidad_vehiculos * sizeof(Vehiculo*);
+                             calle.capacidad_vehiculos * sizeof(Vehiculo*) +
+                             config.num_secciones * (sizeof(int) + sizeof(Vehiculo*) + sizeof(double));
     
-    if (!calle.vehiculos_activos) {
+    if (!calle.vehiculos_activos || !calle.ocupacion_seccion ||
+        !calle.cabeza_seccion || !calle.tiempo_ocupacion_seccion) {
         fprintf(stderr, "ERROR: No se pudo asignar memoria para vehiculos\n");
         exit(1);
     }
@@ -192,6 +271,12 @@ void limpiar_sistema() {
         free(calle.vehiculos_activos);
         calle.vehiculos_activos = NULL;
     }
+    free(calle.ocupacion_seccion);
+    free(calle.cabeza_seccion);
+    free(calle.tiempo_ocupacion_seccion);
+    calle.ocupacion_seccion = NULL;
+    calle.cabeza_seccion = NULL;
+    calle.tiempo_ocupacion_seccion = NULL;
     printf("Sistema limpiado. Memoria liberada.\n");
 }
 
@@ -219,33 +304,329 @@ int redimensionar_sistema_si_necesario() {
     return 1;
 }
 
+// ============================================================================
+// POOL DE VEHÍCULOS Y RESUMEN DE COMPLETADOS
+// ============================================================================
+//
+// Los vehículos se reservan por bloques y vuelven a una lista libre al salir
+// de la calle, de modo que la memoria sigue al máximo de vehículos activos y
+// no al total de la corrida. Antes de devolverse, cada vehículo completado
+// deja su fila de resultados en un archivo temporal y suma sus tiempos a los
+// estadísticas en flujo de las que salen los promedios finales.
+
+#define VEHICULOS_POR_BLOQUE 256
+#define FILAS_EN_PANTALLA 10
+
+typedef struct BloqueVehiculos {
+    struct BloqueVehiculos* siguiente;
+    Vehiculo vehiculos[VEHICULOS_POR_BLOQUE];
+} BloqueVehiculos;
+
+typedef struct {
+    BloqueVehiculos* bloques;
+    Vehiculo* libres;  // Enlazados por siguiente_espera
+    int en_uso;
+    int max_en_uso;
+    int num_bloques;
+} PoolVehiculos;
+
+// Fila de DATOS_VEHICULOS de un vehículo que completó el recorrido
+typedef struct {
+    int id;
+    double entrada;
+    double semaforo;
+    double salida;
+    double detenido;
+    double velocidad_promedio;
+} ResumenVehiculo;
+
+typedef struct {
+    FILE* filas;  // Filas CSV en orden de salida
+    char ruta_filas[64];  // Vacía si 'filas' viene de tmpfile()
+    int completados;
+    EstadisticaFlujo recorrido;
+    EstadisticaFlujo detenido;
+    EstadisticaFlujo velocidad;
+    ResumenVehiculo primeros[FILAS_EN_PANTALLA];  // Para la tabla en terminal
+} SumideroResumenes;
+
+PoolVehiculos pool = {0};
+SumideroResumenes resumenes = {0};
+
+// Devuelve un vehículo en cero, reutilizando uno liberado si lo hay
+Vehiculo* obtener_vehiculo() {
+    if (!pool.libres) {
+        BloqueVehiculos* bloque = (BloqueVehiculos*)malloc(sizeof(BloqueVehiculos));
+        if (!bloque) return NULL;
+        bloque->siguiente = pool.bloques;
+        pool.bloques = bloque;
+        pool.num_bloques++;
+        for (int i = VEHICULOS_POR_BLOQUE - 1; i >= 0; i--) {
+            bloque->vehiculos[i].siguiente_espera = pool.libres;
+            pool.libres = &bloque->vehiculos[i];
+        }
+        calle.memoria_utilizada += sizeof(BloqueVehiculos);
+    }
+    Vehiculo* v = pool.libres;
+    pool.libres = v->siguiente_espera;
+    memset(v, 0, sizeof(Vehiculo));
+    if (++pool.en_uso > pool.max_en_uso) pool.max_en_uso = pool.en_uso;
+    return v;
+}
+
+void devolver_vehiculo(Vehiculo* v) {
+    v->siguiente_espera = pool.libres;
+    pool.libres = v;
+    pool.en_uso--;
+}
+
+void liberar_pool_vehiculos() {
+    while (pool.bloques) {
+        BloqueVehiculos* siguiente = pool.bloques->siguiente;
+        free(pool.bloques);
+        pool.bloques = siguiente;
+    }
+    pool.libres = NULL;
+    pool.en_uso = 0;
+}
+
+void inicializar_resumenes() {
+    memset(&resumenes, 0, sizeof(resumenes));
+    estadistica_iniciar(&resumenes.recorrido);
+    estadistica_iniciar(&resumenes.detenido);
+    estadistica_iniciar(&resumenes.velocidad);
+    resumenes.filas = tmpfile();
+    if (!resumenes.filas) {
+        // En Windows tmpfile() suele fallar por permisos en la raíz del disco:
+        // archivo propio junto al CSV de resultados, que se borra al cerrar
+        time_t ahora = time(NULL);
+        strftime(resumenes.ruta_filas, sizeof(resumenes.ruta_filas), "filas_%Y%m%d_%H%M%S.tmp", localtime(&ahora));
+        resumenes.filas = fopen(resumenes.ruta_filas, "w+b");
+    }
+    if (!resumenes.filas) {
+        fprintf(stderr, "ERROR: Sin archivo temporal ni %s para las filas por vehiculo\n", resumenes.ruta_filas);
+        exit(1);
+    }
+}
+
+// Registra un vehículo que acaba de salir de la calle
+void emitir_resumen(Vehiculo* v) {
+    ResumenVehiculo r = {v->id, v->tiempo_entrada, v->tiempo_llegada_semaforo,
+                         v->tiempo_salida, v->tiempo_total_detenido, 0.0};
+    double tiempo_recorrido = v->tiempo_salida - v->tiempo_entrada;
+    if (tiempo_recorrido > 0) {
+        r.velocidad_promedio = config.longitud_total / tiempo_recorrido;
+    }
+    
+    estadistica_agregar(&resumenes.recorrido, tiempo_recorrido);
+    estadistica_agregar(&resumenes.detenido, r.detenido);
+    estadistica_agregar(&resumenes.velocidad, r.velocidad_promedio);
+    if (resumenes.completados < FILAS_EN_PANTALLA) resumenes.primeros[resumenes.completados] = r;
+    resumenes.completados++;
+    
+    if (resumenes.filas) {
+        fprintf(resumenes.filas, "%d,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                r.id, r.entrada, r.semaforo, r.salida, r.detenido, r.velocidad_promedio);
+    }
+}
+
+// Copia las filas acumuladas al CSV de resultados
+void volcar_resumenes(FILE* csv) {
+    if (!resumenes.filas || !csv) return;
+    char buffer[4096];
+    size_t leidos;
+    rewind(resumenes.filas);
+    while ((leidos = fread(buffer, 1, sizeof(buffer), resumenes.filas)) > 0) {
+        fwrite(buffer, 1, leidos, csv);
+    }
+}
+
+void cerrar_resumenes() {
+    if (resumenes.filas) fclose(resumenes.filas);
+    if (resumenes.ruta_filas[0]) remove(resumenes.ruta_filas);
+    resumenes.filas = NULL;
+    resumenes.ruta_filas[0] = '\0';
+}
+
 // ============================================================================
 // FUNCIONES DE CONTROL DE TRÁFICO MEJORADAS
 // ============================================================================
 
-Vehiculo* encontrar_vehiculo_adelante_optimizado(double posicion, Vehiculo* vehiculo_actual) {
-    Vehiculo* mas_cercano = NULL;
-    double distancia_minima = config.longitud_total;
+// ============================================================================
+// ÍNDICE ESPACIAL POR SECCIONES
+// ============================================================================
+//
+// Cada sección cuenta sus vehículos y apunta al más adelantado. Como la fila
+// está ordenada por posición, los vehículos de una sección son un tramo
+// contiguo de la fila que empieza en cabeza_seccion.
+
+int seccion_de_posicion(double posicion) {
+    int s = (int)(posicion / config.longitud_seccion);
+    if (s < 0) s = 0;
+    if (s >= config.num_secciones) s = config.num_secciones - 1;
+    return s;
+}
+
+void salir_de_seccion(Vehiculo* v) {
+    int s = v->seccion;
+    calle.ocupacion_seccion[s]--;
+    if (calle.cabeza_seccion[s] == v) {
+        Vehiculo* siguiente = v->seguidor;
+        calle.cabeza_seccion[s] = (siguiente && siguiente->seccion == s) ? siguiente : NULL;
+    }
+}
+
+void entrar_en_seccion(Vehiculo* v, int s) {
+    v->seccion = s;
+    calle.ocupacion_seccion[s]++;
+    // Es la cabeza si su líder no está en la misma sección
+    if (!v->lider || v->lider->seccion != s) {
+        calle.cabeza_seccion[s] = v;
+    }
+}
+
+// Llamar después de cambiar la posición del vehículo
+void actualizar_seccion_vehiculo(Vehiculo* v) {
+    int s = seccion_de_posicion(v->posicion);
+    if (s != v->seccion) {
+        salir_de_seccion(v);
+        entrar_en_seccion(v, s);
+    }
+}
+
+// Cuenta los vehículos de la sección s a no más de 'rango' de la posición
+int contar_en_seccion(int s, double posicion, double rango) {
+    int cuenta = 0;
+    for (Vehiculo* v = calle.cabeza_seccion[s]; v && v->seccion == s; v = v->seguidor) {
+        if (fabs(v->posicion - posicion) <= rango) cuenta++;
+    }
+    return cuenta;
+}
+
+// Agrega un vehículo al final de la fila y del array de activos, en O(1)
+void agregar_vehiculo_activo(Vehiculo* v) {
+    v->lider = calle.ultimo_fila;
+    v->seguidor = NULL;
+    if (calle.ultimo_fila) {
+        calle.ultimo_fila->seguidor = v;
+    } else {
+        calle.primero_fila = v;
+    }
+    calle.ultimo_fila = v;
     
-    // Búsqueda optimizada: solo en un rango relevante
-    double rango_busqueda = 50.0; // Búsqueda hasta 50m adelante
+    v->indice_activo = calle.num_vehiculos_activos;
+    calle.vehiculos_activos[calle.num_vehiculos_activos++] = v;
     
-    for (int i = 0; i < calle.num_vehiculos_activos; i++) {
-        Vehiculo* v = calle.vehiculos_activos[i];
-        
-        if (v == vehiculo_actual || !v) continue;
-        
-        // Solo considerar vehiculos en rango relevante
-        double diferencia_pos = v->posicion - posicion;
-        if (diferencia_pos > 0 && diferencia_pos <= rango_busqueda) {
-            if (diferencia_pos < distancia_minima) {
-                distancia_minima = diferencia_pos;
-                mas_cercano = v;
-            }
+    entrar_en_seccion(v, seccion_de_posicion(v->posicion));
+}
+
+// Saca un vehículo de la fila y del array de activos, en O(1)
+void quitar_vehiculo_activo(Vehiculo* v) {
+    salir_de_seccion(v);
+    
+    if (v->lider) {
+        v->lider->seguidor = v->seguidor;
+    } else {
+        calle.primero_fila = v->seguidor;
+    }
+    if (v->seguidor) {
+        v->seguidor->lider = v->lider;
+    } else {
+        calle.ultimo_fila = v->lider;
+    }
+    v->lider = v->seguidor = NULL;
+    
+    // Intercambio con el último del array
+    int i = v->indice_activo;
+    Vehiculo* ultimo = calle.vehiculos_activos[calle.num_vehiculos_activos - 1];
+    calle.vehiculos_activos[i] = ultimo;
+    ultimo->indice_activo = i;
+    calle.vehiculos_activos[calle.num_vehiculos_activos - 1] = NULL;
+    calle.num_vehiculos_activos--;
+}
+
+// ============================================================================
+// AVANCE ANALÍTICO EN FLUJO LIBRE
+// ============================================================================
+//
+// Un vehículo a velocidad máxima sin líder a menos de RANGO_BUSQUEDA_LIDER y
+// lejos de la línea de frenado del semáforo repite el mismo paso trivial
+// (posición += v*dt) hasta que algo cambie. En modo AVANCE_ANALITICO ese
+// tramo no genera eventos: se guarda cuántos pasos quedan y se aplican de
+// golpe cuando otro vehículo necesita su posición o cuando despierta.
+// Posiciones e instantes se acumulan con la misma suma repetida que el modo
+// de paso fijo, así que coinciden; esos pasos solo no se escriben en la traza.
+
+long long pasos_analiticos = 0; // Pasos aplicados sin evento
+
+// Primer paso j (1 = el siguiente) que empieza en una posición >= x
+long long primer_paso_desde(double p0, double d, double x) {
+    if (x <= p0) return 1;
+    return 1 + (long long)ceil((x - p0) / d);
+}
+
+// Aplica los pasos de flujo libre pendientes con instante <= 'tiempo', con
+// las mismas estadísticas que el paso normal. Los instantes se acumulan
+// sumando paso_simulacion igual que la cadena de eventos del modo de paso
+// fijo, así que un paso que cae "justo" en 'tiempo' se considera procesado
+// antes que el evento en curso, como ocurre con el líder en ese modo.
+void sincronizar_vehiculo(Vehiculo* v, double tiempo) {
+    if (v->pasos_libres <= 0) return;
+    
+    double dt = config.paso_simulacion;
+    double d = v->velocidad * dt;
+    long long aplicados = 0;
+    
+    while (v->pasos_libres > 0 && v->inicio_libre + dt <= tiempo) {
+        v->inicio_libre += dt;
+        if (v->tiempo_llegada_semaforo == 0.0 && v->posicion >= config.posicion_semaforo) {
+            v->tiempo_llegada_semaforo = v->inicio_libre;
         }
+        v->tiempo_en_estado += dt;
+        if (v->velocidad < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
+        v->posicion += d;
+        v->distancia_recorrida += d;
+        calle.tiempo_ocupacion_seccion[seccion_de_posicion(v->posicion)] += dt;
+        v->pasos_libres--;
+        aplicados++;
+    }
+    if (aplicados == 0) return;
+    pasos_analiticos += aplicados;
+    
+    double tiempo_transcurrido = v->inicio_libre - v->tiempo_entrada;
+    if (tiempo_transcurrido > 0) {
+        v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
+    }
+}
+
+void sincronizar_todos(double tiempo) {
+    if (config.modo_avance != AVANCE_ANALITICO) return;
+    for (int i = 0; i < calle.num_vehiculos_activos; i++) {
+        sincronizar_vehiculo(calle.vehiculos_activos[i], tiempo);
+    }
+}
+
+// El vehículo de adelante es el líder en la fila, si está en rango
+Vehiculo* encontrar_vehiculo_adelante_optimizado(double posicion, Vehiculo* vehiculo_actual) {
+    double rango_busqueda = RANGO_BUSQUEDA_LIDER;
+    Vehiculo* lider = vehiculo_actual->lider;
+    
+    if (!lider) return NULL;
+    
+    double diferencia_pos = lider->posicion - posicion;
+    if (diferencia_pos > 0 && diferencia_pos <= rango_busqueda) {
+        return lider;
     }
     
-    return mas_cercano;
+    return NULL;
+}
+
+// La entrada está libre si el último de la fila (el de menor posición) ya
+// dejó espacio suficiente
+int entrada_libre() {
+    if (calle.ultimo_fila) sincronizar_vehiculo(calle.ultimo_fila, calle.tiempo_actual);
+    return !calle.ultimo_fila ||
+           calle.ultimo_fila->posicion >= params.longitud_vehiculo + params.distancia_seguridad_min;
 }
 
 double calcular_distancia_seguridad_adaptativa(double velocidad, int densidad_trafico) {
@@ -259,14 +640,31 @@ double calcular_distancia_seguridad_adaptativa(double velocidad, int densidad_tr
     return (base + reaccion + frenado * 0.6) * factor_densidad;
 }
 
-int calcular_densidad_trafico_local(double posicion) {
-    int vehiculos_cercanos = 0;
-    double rango_analisis = 30.0;
+// Vehículos a ±30 m: las secciones interiores del rango se suman con su
+// contador y solo las dos de los extremos se revisan vehículo por vehículo.
+// Los vehículos en flujo libre no están en el índice, pero su líder está a
+// más de RANGO_BUSQUEDA_LIDER, así que solo pueden estar adelante de este
+// vehículo (o ser él mismo) y basta con recorrer la fila hacia adelante.
+int calcular_densidad_trafico_local(Vehiculo* vehiculo) {
+    double posicion = vehiculo->posicion;
+    double rango_analisis = RANGO_DENSIDAD;
+    int desde = seccion_de_posicion(posicion - rango_analisis);
+    int hasta = seccion_de_posicion(posicion + rango_analisis);
+    
+    int vehiculos_cercanos = contar_en_seccion(desde, posicion, rango_analisis);
+    if (hasta != desde) {
+        vehiculos_cercanos += contar_en_seccion(hasta, posicion, rango_analisis);
+    }
+    for (int s = desde + 1; s < hasta; s++) {
+        vehiculos_cercanos += calle.ocupacion_seccion[s];
+    }
     
-    for (int i = 0; i < calle.num_vehiculos_activos; i++) {
-        Vehiculo* v = calle.vehiculos_activos[i];
-        if (v && fabs(v->posicion - posicion) <= rango_analisis) {
-            vehiculos_cercanos++;
+    if (config.modo_avance == AVANCE_ANALITICO) {
+        if (vehiculo->seccion < 0) vehiculos_cercanos++;
+        for (Vehiculo* a = vehiculo->lider; a; a = a->lider) {
+            sincronizar_vehiculo(a, calle.tiempo_actual);
+            if (a->posicion - posicion > rango_analisis) break;
+            if (a->seccion < 0) vehiculos_cercanos++;
         }
     }
     
@@ -279,7 +677,7 @@ void ajustar_por_trafico_mejorado(Vehiculo* vehiculo, double dt) {
     if (!adelante) return;
     
     double distancia_actual = adelante->posicion - vehiculo->posicion - params.longitud_vehiculo;
-    int densidad = calcular_densidad_trafico_local(vehiculo->posicion);
+    int densidad = calcular_densidad_trafico_local(vehiculo);
     double distancia_requerida = calcular_distancia_seguridad_adaptativa(vehiculo->velocidad, densidad);
     
     // Lógica de frenado más sofisticada
@@ -309,69 +707,366 @@ void ajustar_por_trafico_mejorado(Vehiculo* vehiculo, double dt) {
 // FUNCIONES DE CONTROL DEL Semaforo CON LÓGICA INTELIGENTE
 // ============================================================================
 
-void actualizar_semaforo_inteligente(double reloj) {
-    double ciclo_total = semaforo.duracion_verde + semaforo.duracion_amarillo + semaforo.duracion_rojo;
-    double t_ciclo = fmod(reloj, ciclo_total);
+// Los cambios de color son eventos SEMAFORO_CAMBIO programados de antemano:
+// semaforo.estado solo cambia al procesarlos y los vehículos lo leen tal
+// cual. Las consultas sobre instantes futuros recorren el ciclo desde el
+// color vigente con los mismos instantes que tendrán esos eventos.
+
+EstadoSemaforo color_siguiente(EstadoSemaforo estado) {
+    if (estado == VERDE) return AMARILLO;
+    if (estado == AMARILLO) return ROJO;
+    return VERDE;
+}
+
+double duracion_color(EstadoSemaforo estado) {
+    if (estado == VERDE) return semaforo.duracion_verde;
+    if (estado == AMARILLO) return semaforo.duracion_amarillo;
+    return semaforo.duracion_rojo;
+}
+
+// Color que tendrá el semáforo en 'reloj' (>= el último cambio procesado)
+EstadoSemaforo estado_semaforo_en(double reloj) {
+    EstadoSemaforo estado = semaforo.estado;
+    double fin = semaforo.proximo_cambio;
+    while (reloj >= fin) {
+        estado = color_siguiente(estado);
+        fin += duracion_color(estado);
+    }
+    return estado;
+}
+
+// Instante del primer cambio de color posterior a 'reloj'
+double proximo_cambio_semaforo(double reloj) {
+    EstadoSemaforo estado = semaforo.estado;
+    double fin = semaforo.proximo_cambio;
+    while (reloj >= fin) {
+        estado = color_siguiente(estado);
+        fin += duracion_color(estado);
+    }
+    return fin;
+}
+
+// Empieza el ciclo en verde; devuelve el instante del primer cambio
+double iniciar_semaforo() {
+    semaforo.estado = VERDE;
+    semaforo.ultimo_cambio = 0.0;
+    semaforo.proximo_cambio = semaforo.duracion_verde;
+    return semaforo.proximo_cambio;
+}
+
+// Procesa un SEMAFORO_CAMBIO: pasa al color siguiente. Devuelve el instante
+// del próximo cambio.
+double cambiar_color_semaforo(double reloj) {
+    semaforo.estado = color_siguiente(semaforo.estado);
+    semaforo.ultimo_cambio = reloj;
+    semaforo.proximo_cambio = reloj + duracion_color(semaforo.estado);
+    if (semaforo.estado == VERDE) {
+        semaforo.ciclos_completados++;
+    }
+    return semaforo.proximo_cambio;
+}
+
+// ============================================================================
+// HORIZONTE DE FLUJO LIBRE
+// ============================================================================
+
+#define MARGEN_AVANCE 1e-6  // Holgura para despertar un paso antes ante redondeos
+
+// Cuántos de los siguientes pasos del vehículo (recién actualizado en 'reloj')
+// son triviales: velocidad constante sin líder en rango, sin reaccionar al
+// semáforo y sin salir. Devuelve 0 si no está en flujo libre.
+long long calcular_pasos_libres(Vehiculo* v, double reloj) {
+    if (v->estado != VELOCIDAD_CONSTANTE || v->aceleracion != 0.0 ||
+        v->velocidad < 1.0 || v->velocidad < params.velocidad_maxima - 0.2) {
+        return 0;
+    }
     
-    EstadoSemaforo estado_anterior = semaforo.estado;
+    double dt = config.paso_simulacion;
+    double p0 = v->posicion;
+    double d = v->velocidad * dt;
     
-    if (t_ciclo < semaforo.duracion_verde) {
-        semaforo.estado = VERDE;
-    } else if (t_ciclo < semaforo.duracion_verde + semaforo.duracion_amarillo) {
-        semaforo.estado = AMARILLO;
-    } else {
-        semaforo.estado = ROJO;
+    // El paso que llega al final de la calle se procesa normalmente
+    long long limite = primer_paso_desde(p0, d, config.longitud_total - MARGEN_AVANCE) - 1;
+    
+    // El líder solo avanza, salvo el ajuste de hasta 1 m al detenerse junto
+    // al semáforo; con su posición actual la cota es conservadora
+    if (v->lider) {
+        sincronizar_vehiculo(v->lider, reloj);
+        double umbral = v->lider->posicion - 1.0 - RANGO_BUSQUEDA_LIDER - MARGEN_AVANCE;
+        long long j = primer_paso_desde(p0, d, umbral);
+        if (j < limite) limite = j;
     }
     
-    if (estado_anterior != semaforo.estado) {
-        semaforo.ultimo_cambio = reloj;
-        if (semaforo.estado == VERDE) {
-            semaforo.ciclos_completados++;
+    // Antes de cruzar el semáforo: despertar en el cambio de color o donde
+    // la lógica de rojo/amarillo empezaría a frenar
+    if (p0 < config.posicion_semaforo) {
+        long long j_cruce = primer_paso_desde(p0, d, config.posicion_semaforo + MARGEN_AVANCE);
+        
+        long long j_luz = (long long)ceil((proximo_cambio_semaforo(reloj) - MARGEN_AVANCE - reloj) / dt);
+        if (j_luz < 1) j_luz = 1;
+        
+        EstadoSemaforo estado = estado_semaforo_en(reloj);
+        if (estado != VERDE) {
+            double disparo = config.posicion_semaforo - 10.0;
+            if (estado == ROJO) {
+                double distancia_frenado = (v->velocidad * v->velocidad) / (2.0 * fabs(params.desaceleracion_maxima));
+                disparo = config.posicion_semaforo - 2.0 - distancia_frenado;
+            }
+            long long j = primer_paso_desde(p0, d, disparo - MARGEN_AVANCE);
+            if (j < j_luz) j_luz = j;
         }
+        
+        if (j_luz < j_cruce && j_luz < limite) limite = j_luz;
     }
+    
+    return (limite > 1) ? limite - 1 : 0;
 }
 
 // ============================================================================
-// FUNCIONES DE GESTIÓN DE EVENTOS MEJORADAS
+// COLAS DETENIDAS
 // ============================================================================
+//
+// Un vehículo parado en rojo antes del semáforo, o pegado a un líder también
+// parado, repite un paso en el que solo suma tiempo detenido. En modo
+// AVANCE_ANALITICO se duerme: con el rojo entra en la lista del semáforo y lo
+// despierta el evento SEMAFORO_CAMBIO; detrás de un líder lo despierta el
+// propio líder cuando avanza. Los pasos dormidos se acreditan con las mismas
+// sumas que el paso fijo; antes de que el líder se mueva se acredita lo
+// anterior, porque el choque por proximidad depende de su posición.
+
+long long pasos_detenidos = 0; // Pasos detenidos acreditados sin evento
+
+int colision_detenido(Vehiculo* v) {
+    Vehiculo* adelante = encontrar_vehiculo_adelante_optimizado(v->posicion, v);
+    return adelante &&
+           adelante->posicion - v->posicion - params.longitud_vehiculo < params.distancia_seguridad_min * 0.8;
+}
 
-void insertar_evento_optimizado(ColaEventos* cola, Evento evento) {
-    Nodo* nuevo = (Nodo*)malloc(sizeof(Nodo));
-    if (!nuevo) {
-        fprintf(stderr, "ERROR: No se pudo asignar memoria para evento\n");
-        return;
+// Acredita los pasos dormidos con instante < 'hasta'
+void acreditar_espera(Vehiculo* v, double hasta) {
+    double dt = config.paso_simulacion;
+    int colision = colision_detenido(v);
+    long long acreditados = 0;
+    
+    while (v->inicio_libre + dt < hasta) {
+        v->inicio_libre += dt;
+        if (v->tiempo_llegada_semaforo == 0.0 && v->posicion >= config.posicion_semaforo) {
+            v->tiempo_llegada_semaforo = v->inicio_libre;
+        }
+        v->tiempo_total_detenido += dt;  // Decisión con velocidad 0
+        v->tiempo_en_estado += dt;
+        v->tiempo_total_detenido += dt;  // Estadística del estado DETENIDO
+        if (v->velocidad < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
+        if (colision) v->tiempo_total_detenido += dt;
+        calle.tiempo_ocupacion_seccion[v->seccion] += dt;
+        acreditados++;
     }
+    if (acreditados == 0) return;
+    pasos_detenidos += acreditados;
     
-    nuevo->evento = evento;
-    nuevo->siguiente = nuevo->anterior = NULL;
+    double tiempo_transcurrido = v->inicio_libre - v->tiempo_entrada;
+    if (tiempo_transcurrido > 0) {
+        v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
+    }
+}
+
+// Con velocidad 0, el líder le deja arrancar (fuera de rango o a más de 1.5x)
+int lider_deja_avanzar(Vehiculo* v) {
+    Vehiculo* adelante = encontrar_vehiculo_adelante_optimizado(v->posicion, v);
+    return !adelante ||
+           adelante->posicion - v->posicion - params.longitud_vehiculo > params.distancia_seguridad_min * 1.5;
+}
+
+// Si el vehículo (recién actualizado en 'reloj') puede dormirse y por qué.
+// Su líder debe estar parado para que solo cambie de posición en su propio
+// paso; tampoco se duerme en el último metro antes del semáforo, donde el
+// rojo todavía lo haría retroceder hasta posicion_semaforo - 1.
+int calcular_espera(Vehiculo* v, double reloj) {
+    if (v->velocidad != 0.0 || v->aceleracion != 0.0 || v->estado != DETENIDO) {
+        return ESPERA_NINGUNA;
+    }
+    if (v->posicion > config.posicion_semaforo - 1.0 && v->posicion < config.posicion_semaforo) {
+        return ESPERA_NINGUNA;
+    }
+    
+    Vehiculo* adelante = encontrar_vehiculo_adelante_optimizado(v->posicion, v);
+    if (v->posicion < config.posicion_semaforo &&
+        estado_semaforo_en(reloj + config.paso_simulacion) == ROJO) {
+        if (adelante && adelante->velocidad != 0.0 && colision_detenido(v)) return ESPERA_NINGUNA;
+        return ESPERA_SEMAFORO;
+    }
+    if (adelante && adelante->velocidad == 0.0 && !lider_deja_avanzar(v)) {
+        return ESPERA_LIDER;
+    }
+    return ESPERA_NINGUNA;
+}
+
+// Primer instante de la cadena de pasos del vehículo que ya ve el cambio de
+// color procesado en 'cambio'
+double primer_paso_tras_cambio(Vehiculo* v, double cambio) {
+    double dt = config.paso_simulacion;
+    double t = v->inicio_libre;
+    while (t + dt < cambio) t += dt;
+    return t + dt;
+}
+
+// ============================================================================
+// FUNCIONES DE GESTIÓN DE EVENTOS MEJORADAS
+// ============================================================================
+
+// Inserta un nodo en una lista ordenada por tiempo (empates en orden FIFO)
+void insertar_nodo_ordenado(Nodo** inicio, Nodo** fin, Nodo* nuevo) {
+    double tiempo = nuevo->evento.tiempo;
     
     // Optimización: inserción al final si el tiempo es mayor que el último
-    if (!cola->inicio) {
-        cola->inicio = cola->fin = nuevo;
-    } else if (!cola->fin || evento.tiempo >= cola->fin->evento.tiempo) {
+    if (!*inicio) {
+        *inicio = *fin = nuevo;
+    } else if (tiempo >= (*fin)->evento.tiempo) {
         // Insertar al final (caso más común)
-        nuevo->anterior = cola->fin;
-        if (cola->fin) cola->fin->siguiente = nuevo;
-        cola->fin = nuevo;
-        if (!cola->inicio) cola->inicio = nuevo;
-    } else if (evento.tiempo < cola->inicio->evento.tiempo) {
+        nuevo->anterior = *fin;
+        (*fin)->siguiente = nuevo;
+        *fin = nuevo;
+    } else if (tiempo < (*inicio)->evento.tiempo) {
         // Insertar al inicio
-        nuevo->siguiente = cola->inicio;
-        cola->inicio->anterior = nuevo;
-        cola->inicio = nuevo;
+        nuevo->siguiente = *inicio;
+        (*inicio)->anterior = nuevo;
+        *inicio = nuevo;
     } else {
         // Búsqueda desde el final (más eficiente para eventos próximos)
-        Nodo* actual = cola->fin;
-        while (actual && actual->evento.tiempo > evento.tiempo) {
+        Nodo* actual = *fin;
+        while (actual && actual->evento.tiempo > tiempo) {
             actual = actual->anterior;
         }
         
         nuevo->siguiente = actual->siguiente;
         nuevo->anterior = actual;
         if (actual->siguiente) actual->siguiente->anterior = nuevo;
-        else cola->fin = nuevo;
+        else *fin = nuevo;
         actual->siguiente = nuevo;
     }
+}
+
+Nodo* extraer_primer_nodo(Nodo** inicio, Nodo** fin) {
+    Nodo* nodo = *inicio;
+    
+    *inicio = nodo->siguiente;
+    if (*inicio) {
+        (*inicio)->anterior = NULL;
+    } else {
+        *fin = NULL;
+    }
+    return nodo;
+}
+
+// ----------------------------------------------------------------------------
+// Cola calendario: cubetas de ancho paso_simulacion indexadas por
+// floor(tiempo / ancho) modulo num_cubetas. Cada cubeta es una lista ordenada,
+// por lo que las ACTUALIZACION_VEHICULO programadas a t + paso caen siempre
+// al final de la cubeta siguiente y se insertan/extraen en O(1).
+// ----------------------------------------------------------------------------
+
+long long cubeta_virtual(const ColaEventos* cola, double tiempo) {
+    return (long long)floor(tiempo / cola->ancho_cubeta);
+}
+
+int inicializar_calendario(ColaEventos* cola) {
+    // Un "año" del calendario debe cubrir el horizonte típico de programación
+    // (entradas y reintentos), con margen para no dar vueltas completas.
+    double horizonte = fmax(config.intervalo_entrada_vehiculos, 1.0) + config.paso_simulacion;
+    int minimo = (int)ceil(2.0 * horizonte / config.paso_simulacion);
+    int num_cubetas = 16;
+    while (num_cubetas < minimo) num_cubetas *= 2;
+    
+    cola->cubetas_inicio = (Nodo**)calloc(num_cubetas, sizeof(Nodo*));
+    cola->cubetas_fin = (Nodo**)calloc(num_cubetas, sizeof(Nodo*));
+    if (!cola->cubetas_inicio || !cola->cubetas_fin) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para la cola calendario\n");
+        free(cola->cubetas_inicio);
+        free(cola->cubetas_fin);
+        cola->cubetas_inicio = cola->cubetas_fin = NULL;
+        return 0;
+    }
+    
+    cola->num_cubetas = num_cubetas;
+    cola->ancho_cubeta = config.paso_simulacion;
+    cola->cubeta_actual = 0;
+    cola->asignaciones_cola += 2;
+    return 1;
+}
+
+// Duplica el número de cubetas manteniendo el ancho; cada cubeta nueva recibe
+// nodos de una sola cubeta vieja y en orden, así que el reparto es O(n).
+int redimensionar_calendario(ColaEventos* cola) {
+    int nuevas = cola->num_cubetas * 2;
+    Nodo** nuevos_inicio = (Nodo**)calloc(nuevas, sizeof(Nodo*));
+    Nodo** nuevos_fin = (Nodo**)calloc(nuevas, sizeof(Nodo*));
+    if (!nuevos_inicio || !nuevos_fin) {
+        free(nuevos_inicio);
+        free(nuevos_fin);
+        return 0;
+    }
+    
+    for (int i = 0; i < cola->num_cubetas; i++) {
+        while (cola->cubetas_inicio[i]) {
+            Nodo* nodo = extraer_primer_nodo(&cola->cubetas_inicio[i], &cola->cubetas_fin[i]);
+            int indice = (int)(cubeta_virtual(cola, nodo->evento.tiempo) & (nuevas - 1));
+            nodo->siguiente = nodo->anterior = NULL;
+            insertar_nodo_ordenado(&nuevos_inicio[indice], &nuevos_fin[indice], nodo);
+        }
+    }
+    
+    free(cola->cubetas_inicio);
+    free(cola->cubetas_fin);
+    cola->cubetas_inicio = nuevos_inicio;
+    cola->cubetas_fin = nuevos_fin;
+    cola->num_cubetas = nuevas;
+    cola->asignaciones_cola += 2;
+    return 1;
+}
+
+void inicializar_cola_eventos(ColaEventos* cola, int tipo) {
+    memset(cola, 0, sizeof(*cola));
+    cola->tipo = tipo;
+    
+    if (tipo == COLA_CALENDARIO && !inicializar_calendario(cola)) {
+        printf("ADVERTENCIA: Usando lista enlazada como cola de eventos\n");
+        cola->tipo = COLA_LISTA;
+    }
+}
+
+void insertar_evento_optimizado(ColaEventos* cola, Evento evento) {
+    Nodo* nuevo = cola->libres;
+    if (nuevo) {
+        cola->libres = nuevo->siguiente;
+    } else {
+        nuevo = (Nodo*)malloc(sizeof(Nodo));
+        if (!nuevo) {
+            fprintf(stderr, "ERROR: No se pudo asignar memoria para evento\n");
+            return;
+        }
+        cola->asignaciones_cola++;
+    }
+    
+    nuevo->evento = evento;
+    nuevo->siguiente = nuevo->anterior = NULL;
+    
+    if (cola->tipo == COLA_CALENDARIO) {
+        // Mantener pocas vueltas de calendario por cubeta al crecer la cola
+        if (cola->size >= 2 * cola->num_cubetas) {
+            redimensionar_calendario(cola);
+        }
+        
+        long long virtual = cubeta_virtual(cola, evento.tiempo);
+        int indice = (int)(virtual & (cola->num_cubetas - 1));
+        insertar_nodo_ordenado(&cola->cubetas_inicio[indice], &cola->cubetas_fin[indice], nuevo);
+        
+        // Un evento anterior a la cubeta actual la hace retroceder
+        if (cola->size == 0 || virtual < cola->cubeta_actual) {
+            cola->cubeta_actual = virtual;
+        }
+    } else {
+        insertar_nodo_ordenado(&cola->inicio, &cola->fin, nuevo);
+    }
     
     cola->size++;
     if (cola->size > cola->max_size_alcanzado) {
@@ -379,28 +1074,72 @@ void insertar_evento_optimizado(ColaEventos* cola, Evento evento) {
     }
 }
 
-Evento* obtener_siguiente_evento_seguro(ColaEventos* cola) {
-    if (!cola || !cola->inicio) return NULL;
+Nodo* extraer_nodo_calendario(ColaEventos* cola) {
+    // Recorrer a lo sumo un año buscando un evento de la cubeta virtual actual
+    for (int n = 0; n < cola->num_cubetas; n++) {
+        int indice = (int)(cola->cubeta_actual & (cola->num_cubetas - 1));
+        Nodo* primero = cola->cubetas_inicio[indice];
+        
+        if (primero && cubeta_virtual(cola, primero->evento.tiempo) == cola->cubeta_actual) {
+            return extraer_primer_nodo(&cola->cubetas_inicio[indice], &cola->cubetas_fin[indice]);
+        }
+        cola->cubeta_actual++;
+    }
     
-    Nodo* nodo = cola->inicio;
-    Evento* evento = (Evento*)malloc(sizeof(Evento));
-    if (!evento) {
-        fprintf(stderr, "ERROR: No se pudo asignar memoria para evento\n");
-        return NULL;
+    // Año vacío: búsqueda directa del mínimo entre las cabezas de cubeta
+    int indice_min = -1;
+    for (int i = 0; i < cola->num_cubetas; i++) {
+        Nodo* primero = cola->cubetas_inicio[i];
+        if (primero && (indice_min < 0 ||
+                        primero->evento.tiempo < cola->cubetas_inicio[indice_min]->evento.tiempo)) {
+            indice_min = i;
+        }
     }
     
-    *evento = nodo->evento;
+    cola->cubeta_actual = cubeta_virtual(cola, cola->cubetas_inicio[indice_min]->evento.tiempo);
+    return extraer_primer_nodo(&cola->cubetas_inicio[indice_min], &cola->cubetas_fin[indice_min]);
+}
+
+// Copia el siguiente evento en el espacio del llamador; devuelve 0 si la cola está vacía
+int obtener_siguiente_evento_seguro(ColaEventos* cola, Evento* salida) {
+    if (!cola || cola->size == 0) return 0;
     
-    cola->inicio = nodo->siguiente;
-    if (cola->inicio) {
-        cola->inicio->anterior = NULL;
+    Nodo* nodo;
+    if (cola->tipo == COLA_CALENDARIO) {
+        nodo = extraer_nodo_calendario(cola);
     } else {
-        cola->fin = NULL;
+        nodo = extraer_primer_nodo(&cola->inicio, &cola->fin);
     }
+    *salida = nodo->evento;
     
-    free(nodo);
+    // Devolver el nodo a la lista de libres
+    nodo->siguiente = cola->libres;
+    cola->libres = nodo;
     cola->size--;
-    return evento;
+    return 1;
+}
+
+void liberar_cola_eventos(ColaEventos* cola) {
+    Evento descartado;
+    while (obtener_siguiente_evento_seguro(cola, &descartado));
+    
+    while (cola->libres) {
+        Nodo* siguiente = cola->libres->siguiente;
+        free(cola->libres);
+        cola->libres = siguiente;
+    }
+    
+    free(cola->cubetas_inicio);
+    free(cola->cubetas_fin);
+    cola->cubetas_inicio = cola->cubetas_fin = NULL;
+}
+
+const char* tipo_cola_str(int tipo) {
+    switch (tipo) {
+        case COLA_LISTA: return "LISTA";
+        case COLA_CALENDARIO: return "CALENDARIO";
+        default: return "DESCONOCIDO";
+    }
 }
 
 // ============================================================================
@@ -443,7 +1182,7 @@ void imprimir_estado_detallado() {
         
         Vehiculo* adelante = encontrar_vehiculo_adelante_optimizado(v->posicion, v);
         double distancia = adelante ? (adelante->posicion - v->posicion - params.longitud_vehiculo) : -1;
-        int densidad = calcular_densidad_trafico_local(v->posicion);
+        int densidad = calcular_densidad_trafico_local(v);
         
         printf("ID:%2d Pos=%6.1fm Vel=%5.2fm/s %s", 
                v->id, v->posicion, v->velocidad, estado_str(v->estado));
@@ -458,12 +1197,26 @@ void imprimir_estado_detallado() {
         printf("... y %d vehiculos más\n", calle.num_vehiculos_activos - mostrar_hasta);
     }
     
+    // Los vehículos en flujo libre están fuera del índice; se suman aparte
+    int* libres_seccion = (int*)calloc(config.num_secciones, sizeof(int));
+    for (int i = 0; libres_seccion && i < calle.num_vehiculos_activos; i++) {
+        Vehiculo* v = calle.vehiculos_activos[i];
+        if (v->seccion < 0) libres_seccion[seccion_de_posicion(v->posicion)]++;
+    }
+    
+    printf("Ocupación por sección (%.0fm):", config.longitud_seccion);
+    for (int s = 0; s < config.num_secciones; s++) {
+        printf(" %d", calle.ocupacion_seccion[s] + (libres_seccion ? libres_seccion[s] : 0));
+    }
+    printf("\n");
+    free(libres_seccion);
+    
     printf("Memoria: %zu KB | Cola max: %d eventos\n", 
            calle.memoria_utilizada / 1024, 0); // Actualizar con stats de cola
     printf("\n");
 }
 
-void imprimir_estadisticas_finales(Vehiculo** todos_vehiculos, int total) {
+void imprimir_estadisticas_finales() {
     printf("\n==== ESTADISTICAS FINALES DE LA SIMULACIÓN ====\n");
     printf("Tiempo total: %.2f segundos\n", calle.tiempo_actual);
     printf("Vehiculos creados: %d\n", calle.total_vehiculos_creados);
@@ -487,26 +1240,10 @@ void imprimir_estadisticas_finales(Vehiculo** todos_vehiculos, int total) {
     }
 
     if (calle.total_vehiculos_completados > 0) {
-        double tiempo_promedio = 0.0;
-        double velocidad_promedio_total = 0.0;
-        double tiempo_detenido_promedio = 0.0;
-
-        for (int i = 0; i < total; i++) {
-            if (todos_vehiculos[i] && todos_vehiculos[i]->estado == SALIENDO) {
-                double tiempo_recorrido = todos_vehiculos[i]->tiempo_salida - todos_vehiculos[i]->tiempo_entrada;
-                tiempo_promedio += tiempo_recorrido;
-
-                if (tiempo_recorrido > 0) {
-                    velocidad_promedio_total += config.longitud_total / tiempo_recorrido;
-                }
-
-                tiempo_detenido_promedio += todos_vehiculos[i]->tiempo_total_detenido;
-            }
-        }
-
-        tiempo_promedio /= calle.total_vehiculos_completados;
-        velocidad_promedio_total /= calle.total_vehiculos_completados;
-        tiempo_detenido_promedio /= calle.total_vehiculos_completados;
+        // Medias en flujo, actualizadas por emitir_resumen al salir cada vehículo
+        double tiempo_promedio = resumenes.recorrido.media;
+        double velocidad_promedio_total = resumenes.velocidad.media;
+        double tiempo_detenido_promedio = resumenes.detenido.media;
 
         printf("Tiempo promedio de recorrido: %.2f segundos\n", tiempo_promedio);
         printf("Velocidad promedio: %.2f m/s (%.1f km/h)\n", 
@@ -514,6 +1251,11 @@ void imprimir_estadisticas_finales(Vehiculo** todos_vehiculos, int total) {
         printf("Tiempo promedio detenido: %.2f segundos\n", tiempo_detenido_promedio);
         printf("Eficiencia del sistema: %.1f%%\n", 
                (velocidad_promedio_total / params.velocidad_maxima) * 100.0);
+        
+        printf("Distribución por vehiculo:\n");
+        estadistica_imprimir("Tiempo de recorrido", &resumenes.recorrido, "s");
+        estadistica_imprimir("Tiempo detenido", &resumenes.detenido, "s");
+        estadistica_imprimir("Velocidad promedio", &resumenes.velocidad, "m/s");
 
         //  Guardar estadísticas generales en CSV
         if (csv) {
@@ -535,34 +1277,51 @@ void imprimir_estadisticas_finales(Vehiculo** todos_vehiculos, int total) {
     printf("ID | Entrada | Semaforo | Salida | Detenido | Vel.Prom\n");
     printf("---|---------|----------|--------|----------|----------\n");
 
-    //  Guardar TODOS los vehiculos completados
-    int contador_csv = 0;
-    for (int i = 0; i < total; i++) {
-        if (todos_vehiculos[i] && todos_vehiculos[i]->estado == SALIENDO) {
-            Vehiculo* v = todos_vehiculos[i];
-            double vel_promedio = 0.0;
-            if (v->tiempo_salida > v->tiempo_entrada) {
-                vel_promedio = config.longitud_total / (v->tiempo_salida - v->tiempo_entrada);
-            }
-
-            // Imprimir en terminal (solo primeros 10 para visualización)
-            if (contador_csv < 10) {
-                printf("%2d | %7.2f | %8.2f | %6.2f | %8.2f | %8.2f\n",
-                    v->id, v->tiempo_entrada, v->tiempo_llegada_semaforo,
-                    v->tiempo_salida, v->tiempo_total_detenido, vel_promedio);
-            }
+    // Los primeros en pantalla; todos al CSV desde el archivo temporal
+    int contador_csv = resumenes.completados;
+    for (int i = 0; i < contador_csv && i < FILAS_EN_PANTALLA; i++) {
+        ResumenVehiculo* r = &resumenes.primeros[i];
+        printf("%2d | %7.2f | %8.2f | %6.2f | %8.2f | %8.2f\n",
+            r->id, r->entrada, r->semaforo, r->salida, r->detenido, r->velocidad_promedio);
+    }
+    volcar_resumenes(csv);
 
-            // Guardar en CSV (TODOS los vehiculos)
-            if (csv) {
-                fprintf(csv, "%d,%.2f,%.2f,%.2f,%.2f,%.2f\n",
-                        v->id, v->tiempo_entrada, v->tiempo_llegada_semaforo,
-                        v->tiempo_salida, v->tiempo_total_detenido, vel_promedio);
-                fflush(csv);  // Forzar escritura
+    // Ocupación media de cada sección durante la simulación
+    int seccion_max = 0;
+    for (int s = 1; s < config.num_secciones; s++) {
+        if (calle.tiempo_ocupacion_seccion[s] > calle.tiempo_ocupacion_seccion[seccion_max]) {
+            seccion_max = s;
+        }
+    }
+    if (calle.tiempo_actual > 0) {
+        printf("\nSección más ocupada: %.0f-%.0fm (%.2f vehiculos en promedio)\n",
+               seccion_max * config.longitud_seccion, (seccion_max + 1) * config.longitud_seccion,
+               calle.tiempo_ocupacion_seccion[seccion_max] / calle.tiempo_actual);
+        
+        if (csv) {
+            fprintf(csv, "# OCUPACION_SECCIONES\n");
+            fprintf(csv, "Seccion,Inicio (m),OcupacionMedia\n");
+            for (int s = 0; s < config.num_secciones; s++) {
+                fprintf(csv, "%d,%.1f,%.3f\n", s, s * config.longitud_seccion,
+                        calle.tiempo_ocupacion_seccion[s] / calle.tiempo_actual);
             }
-            contador_csv++;
         }
     }
 
+    // Momentos, cuantiles e histogramas de los completados
+    if (csv && resumenes.completados > 0) {
+        fprintf(csv, "# ESTADISTICAS_FLUJO\n");
+        estadistica_csv_encabezado(csv);
+        estadistica_csv(csv, "Calle", "TiempoRecorrido", &resumenes.recorrido);
+        estadistica_csv(csv, "Calle", "TiempoDetenido", &resumenes.detenido);
+        estadistica_csv(csv, "Calle", "VelocidadPromedio", &resumenes.velocidad);
+        fprintf(csv, "# HISTOGRAMAS\n");
+        fprintf(csv, "Grupo,Metrica,Desde,Hasta,Vehiculos\n");
+        estadistica_csv_histograma(csv, "Calle", "TiempoRecorrido", &resumenes.recorrido);
+        estadistica_csv_histograma(csv, "Calle", "TiempoDetenido", &resumenes.detenido);
+        estadistica_csv_histograma(csv, "Calle", "VelocidadPromedio", &resumenes.velocidad);
+    }
+
     //  Cerrar CSV
     if (csv) {
         fclose(csv);
@@ -579,81 +1338,145 @@ void imprimir_estadisticas_finales(Vehiculo** todos_vehiculos, int total) {
 // FUNCIONES PARA CSV DE ESTADOS DETALLADOS
 // ============================================================================
 
-FILE *csv_estados = NULL;
+// El archivo de estados se escribe con el escritor asíncrono de trazas.h:
+// registrar un estado solo formatea la línea y la copia a un bloque en memoria.
+EscritorTrazas trazas_estados;
+int trazas_abiertas = 0;
 
-// Abrir archivo CSV de estados
+// Abrir archivo de estados (CSV o binario .trz según config.formato_trazas)
 void inicializar_csv_estados() {
     char nombre_archivo[128];
     time_t ahora = time(NULL);
     struct tm *t = localtime(&ahora);
-    strftime(nombre_archivo, sizeof(nombre_archivo), "estados_%Y%m%d_%H%M%S.csv", t);
+    strftime(nombre_archivo, sizeof(nombre_archivo),
+             (config.formato_trazas == FORMATO_TRAZA_BINARIO) ? "estados_%Y%m%d_%H%M%S.trz"
+                                                              : "estados_%Y%m%d_%H%M%S.csv", t);
 
-    csv_estados = fopen(nombre_archivo, "w");
-    if (!csv_estados) {
+    trazas_abiertas = escritor_trazas_abrir(&trazas_estados, nombre_archivo, 1);
+    if (!trazas_abiertas) {
         printf("❌ ERROR: No se pudo crear archivo de estados: %s\n", nombre_archivo);
         perror("Detalle del error");
         return;
     }
 
     // Encabezado
-    fprintf(csv_estados, "Tiempo,ID,Posicion,Velocidad,Aceleracion,EstadoVehiculo,Semaforo\n");
-    fflush(csv_estados);
+    const char* columnas = "Tiempo,ID,Posicion,Velocidad,Aceleracion,EstadoVehiculo,Semaforo";
+    if (config.formato_trazas == FORMATO_TRAZA_BINARIO) {
+        char texto[TRAZA_MAX_TEXTO];
+        int n = snprintf(texto, sizeof(texto),
+                         "simulador=calle\ncsv_columnas=%s\nestados=", columnas);
+        for (int e = ENTRANDO; e <= SALIENDO; e++) {
+            n += snprintf(texto + n, sizeof(texto) - n, "%s%s", estado_str(e), (e < SALIENDO) ? "," : "\n");
+        }
+        n += snprintf(texto + n, sizeof(texto) - n, "semaforo=");
+        for (int e = VERDE; e <= ROJO; e++) {
+            n += snprintf(texto + n, sizeof(texto) - n, "%s%s", color_semaforo(e), (e < ROJO) ? "," : "\n");
+        }
+        snprintf(texto + n, sizeof(texto) - n,
+                 "paso_simulacion=%g\nlongitud_total=%g\nposicion_semaforo=%g\n"
+                 "max_autos=%d\nintervalo_entrada_vehiculos=%g\nvelocidad_maxima=%g\nmodo_avance=%d\n",
+                 config.paso_simulacion, config.longitud_total, config.posicion_semaforo,
+                 config.max_autos, config.intervalo_entrada_vehiculos, params.velocidad_maxima,
+                 config.modo_avance);
+        escritor_trazas_encabezado_binario(&trazas_estados, texto);
+    } else {
+        char encabezado[128];
+        int n = snprintf(encabezado, sizeof(encabezado), "%s\n", columnas);
+        escritor_trazas_encabezado(&trazas_estados, encabezado, n);
+    }
 
     printf("✅ Archivo de estados creado: %s\n", nombre_archivo);
 }
 
 // Registrar estado de vehículo
 void registrar_estado_vehiculo(Vehiculo* v) {
-    if (!csv_estados || !v) return;
+    if (!trazas_abiertas || !v) return;
+
+    if (config.formato_trazas == FORMATO_TRAZA_BINARIO) {
+        RegistroTraza r = {
+            .tiempo = traza_centesimas(calle.tiempo_actual),
+            .id = v->id,
+            .posicion = traza_centesimas(v->posicion),
+            .velocidad = traza_centesimas(v->velocidad),
+            .aceleracion = traza_centesimas(v->aceleracion),
+            .estado = (uint8_t)v->estado,
+            .semaforo = (uint8_t)semaforo.estado
+        };
+        escritor_trazas_registro(&trazas_estados, 0, &r);
+        return;
+    }
 
-    fprintf(csv_estados, "%.2f,%d,%.2f,%.2f,%.2f,%s,%s\n",
-            calle.tiempo_actual,
-            v->id,
-            v->posicion,
-            v->velocidad,
-            v->aceleracion,
-            estado_str(v->estado),
-            color_semaforo(semaforo.estado));
-    fflush(csv_estados);
+    char linea[160];
+    int n = snprintf(linea, sizeof(linea), "%.2f,%d,%.2f,%.2f,%.2f,%s,%s\n",
+                     calle.tiempo_actual,
+                     v->id,
+                     v->posicion,
+                     v->velocidad,
+                     v->aceleracion,
+                     estado_str(v->estado),
+                     color_semaforo(semaforo.estado));
+    if (n > 0 && n < (int)sizeof(linea)) {
+        escritor_trazas_escribir(&trazas_estados, 0, linea, n);
+    }
 }
 
 // Cerrar CSV de estados
 void cerrar_csv_estados() {
-    if (csv_estados) {
-        fclose(csv_estados);
-        csv_estados = NULL;
-        printf("✅ Archivo de estados cerrado correctamente.\n");
+    if (trazas_abiertas) {
+        escritor_trazas_cerrar(&trazas_estados);
+        trazas_abiertas = 0;
+        printf("✅ Archivo de estados cerrado correctamente (%.1f MB en %d escrituras, %d esperas del simulador).\n",
+               trazas_estados.bytes_escritos / (1024.0 * 1024.0),
+               trazas_estados.escrituras, trazas_estados.esperas);
     }
 }
 
-
 // ============================================================================
 // FUNCIÓN PRINCIPAL MEJORADA Y ESCALABLE
 // ============================================================================
 
+// Una entrada programada para 'tiempo' todavía se admite. Sin tope de autos
+// las llegadas se cierran en tiempo_limite_simulacion (la que cae justo en
+// el límite ya no entra, como en paraleloPrueba.c) y los que ya entraron
+// completan el recorrido.
+int llegadas_abiertas(double tiempo) {
+    if (config.max_autos > 0 && calle.total_vehiculos_creados >= config.max_autos) return 0;
+    if (config.tiempo_limite_simulacion > 0.0 && tiempo >= config.tiempo_limite_simulacion) return 0;
+    return 1;
+}
+
+// Cota de vehículos de la corrida, para progreso y estimaciones
+long long vehiculos_previstos() {
+    long long por_tiempo = -1;
+    if (config.tiempo_limite_simulacion > 0.0) {
+        por_tiempo = (long long)(config.tiempo_limite_simulacion / config.intervalo_entrada_vehiculos) + 1;
+    }
+    if (config.max_autos > 0 && (por_tiempo < 0 || config.max_autos < por_tiempo)) return config.max_autos;
+    return (por_tiempo > 0) ? por_tiempo : 1;
+}
+
 void procesar_eventos_escalable() {
-    ColaEventos cola = {0};
+    ColaEventos cola;
+    inicializar_cola_eventos(&cola, config.tipo_cola_eventos);
     int id_auto = 1;
-    Vehiculo** todos_vehiculos = (Vehiculo**)calloc(config.max_autos, sizeof(Vehiculo*));
-    
-    if (!todos_vehiculos) {
-        fprintf(stderr, "ERROR: No se pudo asignar memoria para array de vehiculos\n");
-        return;
-    }
+    inicializar_resumenes();
     
     // Evento inicial
     Evento primer_evento = {0.0, ENTRADA, id_auto, NULL, 1};
     insertar_evento_optimizado(&cola, primer_evento);
+    Evento primer_cambio = {iniciar_semaforo(), SEMAFORO_CAMBIO, 0, NULL, 1};
+    insertar_evento_optimizado(&cola, primer_cambio);
     
-    int eventos_procesados = 0;
+    long long eventos_procesados = 0;
     double ultimo_reporte = 0.0;
     
     // BUCLE PRINCIPAL MEJORADO - SIN LÍMITE DE TIEMPO
-    while ((cola.inicio || calle.num_vehiculos_activos > 0)) {
+    while ((cola.size > 0 || calle.num_vehiculos_activos > 0)) {
         
-        Evento* e = obtener_siguiente_evento_seguro(&cola);
+        Evento evento_actual;
+        Evento* e = &evento_actual;
         
-        if (!e) {
+        if (!obtener_siguiente_evento_seguro(&cola, e)) {
             if (calle.num_vehiculos_activos > 0) {
                 printf("ADVERTENCIA: Sin eventos pero %d vehiculos activos en t=%.2f\n", 
                        calle.num_vehiculos_activos, calle.tiempo_actual);
@@ -671,17 +1494,20 @@ void procesar_eventos_escalable() {
             break;
         }
         
+        // El ciclo del semáforo por sí solo no prolonga la simulación
+        if (e->tipo == SEMAFORO_CAMBIO && cola.size == 0 && calle.num_vehiculos_activos == 0) break;
+        
         calle.tiempo_actual = e->tiempo;
-        actualizar_semaforo_inteligente(calle.tiempo_actual);
         eventos_procesados++;
         
         // Protección contra bucles infinitos (basada en eventos, no tiempo)
-        if (eventos_procesados > config.max_autos * 50000) {
-            printf("ADVERTENCIA: Demasiados eventos procesados (%d). Verificando estado...\n", 
+        if (eventos_procesados > vehiculos_previstos() * 50000) {
+            printf("ADVERTENCIA: Demasiados eventos procesados (%lld). Verificando estado...\n", 
                    eventos_procesados);
             
             // Verificar si hay progreso
             static double ultima_posicion_maxima = 0.0;
+            sincronizar_todos(calle.tiempo_actual);
             double posicion_maxima_actual = 0.0;
             
             for (int i = 0; i < calle.num_vehiculos_activos; i++) {
@@ -701,16 +1527,9 @@ void procesar_eventos_escalable() {
             ultima_posicion_maxima = posicion_maxima_actual;
             eventos_procesados = 0; // Reiniciar contador
         }
-        if (e->tipo == ENTRADA && calle.total_vehiculos_creados < config.max_autos) {
+        if (e->tipo == ENTRADA && llegadas_abiertas(e->tiempo)) {
             // Verificar espacio para entrada
-            int puede_entrar = 1;
-            for (int i = 0; i < calle.num_vehiculos_activos; i++) {
-                Vehiculo* v = calle.vehiculos_activos[i];
-                if (v && v->posicion < params.longitud_vehiculo + params.distancia_seguridad_min) {
-                    puede_entrar = 0;
-                    break;
-                }
-            }
+            int puede_entrar = entrada_libre();
             
             if (puede_entrar) {
                 if (!redimensionar_sistema_si_necesario()) {
@@ -718,10 +1537,9 @@ void procesar_eventos_escalable() {
                     break;
                 }
                 
-                Vehiculo* v = (Vehiculo*)calloc(1, sizeof(Vehiculo));
+                Vehiculo* v = obtener_vehiculo();
                 if (!v) {
                     fprintf(stderr, "ERROR: No se pudo crear vehiculo\n");
-                    free(e);
                     continue;
                 }
                 
@@ -732,9 +1550,8 @@ void procesar_eventos_escalable() {
                 v->tiempo_entrada = e->tiempo;
                 v->ultimo_cambio_estado = e->tiempo;
                 
-                // Agregar a arrays
-                todos_vehiculos[calle.total_vehiculos_creados] = v;
-                calle.vehiculos_activos[calle.num_vehiculos_activos++] = v;
+                // Agregar a la fila
+                agregar_vehiculo_activo(v);
                 calle.total_vehiculos_creados++;
                 
                 printf("[%.2f] Vehiculo %d entra (total activos: %d)\n", 
@@ -747,14 +1564,14 @@ void procesar_eventos_escalable() {
                 id_auto++;
                 
                 // Programar siguiente entrada si no hemos alcanzado el límite
-                if (calle.total_vehiculos_creados < config.max_autos) {
-                    double siguiente_entrada = e->tiempo + config.intervalo_entrada_vehiculos;
+                double siguiente_entrada = e->tiempo + config.intervalo_entrada_vehiculos;
+                if (llegadas_abiertas(siguiente_entrada)) {
                     Evento sig = {siguiente_entrada, ENTRADA, id_auto, NULL, 1};
                     insertar_evento_optimizado(&cola, sig);
                 }
             } else {
                 // Reintentar entrada más tarde
-                if (calle.total_vehiculos_creados < config.max_autos) {
+                if (llegadas_abiertas(e->tiempo + 1.0)) {
                     Evento reintento = {e->tiempo + 1.0, ENTRADA, id_auto, NULL, 1};
                     insertar_evento_optimizado(&cola, reintento);
                 }
@@ -765,10 +1582,29 @@ void procesar_eventos_escalable() {
             Vehiculo* v = e->vehiculo;
             
             if (!v || v->estado == SALIENDO) {
-                free(e);
                 continue;
             }
             
+            // Fin de un tramo de flujo libre: aplicar lo pendiente y volver al índice
+            if (v->seccion < 0) {
+                sincronizar_vehiculo(v, calle.tiempo_actual);
+                entrar_en_seccion(v, seccion_de_posicion(v->posicion));
+            }
+            if (v->lider) sincronizar_vehiculo(v->lider, calle.tiempo_actual);
+            
+            // Fin de una espera detenida: acreditar los pasos dormidos
+            if (v->espera != ESPERA_NINGUNA) {
+                acreditar_espera(v, calle.tiempo_actual);
+                v->espera = ESPERA_NINGUNA;
+                v->despertar_programado = 0;
+            }
+            
+            // El seguidor dormido ve la posición actual hasta este instante
+            Vehiculo* seguidor = v->seguidor;
+            if (seguidor && seguidor->espera != ESPERA_NINGUNA) {
+                acreditar_espera(seguidor, calle.tiempo_actual);
+            }
+            
             v->actualizaciones_count++;
             double dt = config.paso_simulacion;
             double velocidad_anterior = v->velocidad;
@@ -848,6 +1684,9 @@ void procesar_eventos_escalable() {
             if (v->velocidad < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
             
             // ACTUALIZAR FÍSICA
+            // Queda escalar: cada evento mueve un solo vehículo y la colisión
+            // se mide contra la posición ya actualizada del de adelante, así
+            // que no hay un lote que integrar con el kernel de paraleloPrueba.c
             double nueva_velocidad = v->velocidad + v->aceleracion * dt;
             
             // Aplicar límites físicos
@@ -894,6 +1733,9 @@ void procesar_eventos_escalable() {
                 v->posicion = fmin(v->posicion, config.posicion_semaforo - 1.0);
             }
             
+            actualizar_seccion_vehiculo(v);
+            calle.tiempo_ocupacion_seccion[v->seccion] += dt;
+            
             // Contar reanudaciones
             if (v->velocidad > 0 && velocidad_anterior == 0) {
                 v->eventos_reanudacion++;
@@ -910,7 +1752,9 @@ void procesar_eventos_escalable() {
             registrar_estado_vehiculo(v);
 
             // VERIFICAR SALIDA DEL SISTEMA
+            int completado = 0;
             if (v->posicion >= config.longitud_total) {
+                completado = 1;
                 v->tiempo_salida = calle.tiempo_actual;
                 v->estado = SALIENDO;
                 calle.total_vehiculos_completados++;
@@ -920,67 +1764,118 @@ void procesar_eventos_escalable() {
                        calle.tiempo_actual, v->id, tiempo_total, v->velocidad_promedio);
                 
                 // Remover de vehiculos activos
-                for (int i = 0; i < calle.num_vehiculos_activos; i++) {
-                    if (calle.vehiculos_activos[i] == v) {
-                        calle.vehiculos_activos[i] = calle.vehiculos_activos[calle.num_vehiculos_activos - 1];
-                        calle.vehiculos_activos[calle.num_vehiculos_activos - 1] = NULL;
-                        calle.num_vehiculos_activos--;
-                        break;
+                quitar_vehiculo_activo(v);
+                emitir_resumen(v);
+            } else {
+                // Programar siguiente actualización; en flujo libre se salta
+                // directamente al primer paso que no sea trivial
+                long long libres = (config.modo_avance == AVANCE_ANALITICO)
+                                   ? calcular_pasos_libres(v, calle.tiempo_actual) : 0;
+                int espera = (config.modo_avance == AVANCE_ANALITICO && libres == 0)
+                             ? calcular_espera(v, calle.tiempo_actual) : ESPERA_NINGUNA;
+                double tiempo_siguiente = e->tiempo + config.paso_simulacion;
+                if (libres > 0) {
+                    salir_de_seccion(v);
+                    v->seccion = -1;
+                    v->pasos_libres = libres;
+                    v->inicio_libre = e->tiempo;
+                    for (long long k = 0; k < libres; k++) tiempo_siguiente += config.paso_simulacion;
+                }
+                if (espera == ESPERA_NINGUNA) {
+                    Evento siguiente = {tiempo_siguiente, ACTUALIZACION_VEHICULO, v->id, v, 0};
+                    insertar_evento_optimizado(&cola, siguiente);
+                } else {
+                    // Dormir: sin evento hasta que cambie el semáforo o avance el líder
+                    v->espera = espera;
+                    v->inicio_libre = e->tiempo;
+                    if (espera == ESPERA_SEMAFORO) {
+                        // Ordenada del más nuevo al más antiguo, como se
+                        // desempatan las cadenas del paso fijo
+                        Vehiculo** pos = &semaforo.en_espera;
+                        while (*pos && (*pos)->id > v->id) pos = &(*pos)->siguiente_espera;
+                        v->siguiente_espera = *pos;
+                        *pos = v;
                     }
                 }
-            } else {
-                // Programar siguiente actualización
-                Evento siguiente = {e->tiempo + config.paso_simulacion, ACTUALIZACION_VEHICULO, v->id, v, 0};
-                insertar_evento_optimizado(&cola, siguiente);
             }
+            
+            // Despertar al seguidor que esperaba a que este vehículo avanzara
+            if (seguidor && seguidor->espera == ESPERA_LIDER && !seguidor->despertar_programado &&
+                lider_deja_avanzar(seguidor)) {
+                seguidor->despertar_programado = 1;
+                Evento despertar = {seguidor->inicio_libre + config.paso_simulacion,
+                                    ACTUALIZACION_VEHICULO, seguidor->id, seguidor, 0};
+                insertar_evento_optimizado(&cola, despertar);
+            }
+            
+            // Ya sin eventos pendientes ni referencias desde la fila
+            if (completado) devolver_vehiculo(v);
+        }
+        // CAMBIO DE COLOR: al salir del rojo despertar la lista de espera del
+        // semáforo, cada uno en el primer paso de su cadena con el color nuevo
+        else if (e->tipo == SEMAFORO_CAMBIO) {
+            double siguiente_cambio = cambiar_color_semaforo(e->tiempo);
+            
+            Vehiculo* v = (semaforo.estado != ROJO) ? semaforo.en_espera : NULL;
+            if (v) semaforo.en_espera = NULL;
+            while (v) {
+                Vehiculo* siguiente_espera = v->siguiente_espera;
+                v->siguiente_espera = NULL;
+                v->despertar_programado = 1;
+                Evento despertar = {primer_paso_tras_cambio(v, e->tiempo), ACTUALIZACION_VEHICULO, v->id, v, 0};
+                insertar_evento_optimizado(&cola, despertar);
+                v = siguiente_espera;
+            }
+            
+            Evento cambio_luz = {siguiente_cambio, SEMAFORO_CAMBIO, 0, NULL, 1};
+            insertar_evento_optimizado(&cola, cambio_luz);
         }
         
         // REPORTES PERIÓDICOS (cada 10 segundos) - Menos frecuentes para simulaciones largas
         if (calle.tiempo_actual - ultimo_reporte >= 20.0) {
+            sincronizar_todos(calle.tiempo_actual);
             imprimir_estado_detallado();
             ultimo_reporte = calle.tiempo_actual;
             
             // Mostrar progreso de completitud
-            double porcentaje_completado = (double)calle.total_vehiculos_completados / config.max_autos * 100.0;
-            printf(">>> PROGRESO: %.1f%% completado (%d/%d vehiculos) - Tiempo: %.1fs <<<\n\n", 
-                   porcentaje_completado, calle.total_vehiculos_completados, config.max_autos, calle.tiempo_actual);
+            double porcentaje_completado = (double)calle.total_vehiculos_completados / vehiculos_previstos() * 100.0;
+            printf(">>> PROGRESO: %.1f%% completado (%d/%lld vehiculos) - Tiempo: %.1fs <<<\n\n", 
+                   porcentaje_completado, calle.total_vehiculos_completados, vehiculos_previstos(), calle.tiempo_actual);
         }
-        
-        free(e);
     }
     
     // LIMPIEZA Y REPORTES FINALES
     printf("\n=== SIMULACION COMPLETADA ===\n");
-    printf("Eventos procesados: %d\n", eventos_procesados);
+    printf("Eventos procesados: %lld\n", eventos_procesados);
+    if (config.modo_avance == AVANCE_ANALITICO) {
+        printf("Pasos avanzados analíticamente: %lld\n", pasos_analiticos);
+        printf("Pasos detenidos acreditados sin evento: %lld\n", pasos_detenidos);
+    }
     
     // Verificar si todos los vehiculos completaron el recorrido
-    if (calle.total_vehiculos_completados == config.max_autos) {
-        printf("✓ EXITO: Todos los %d vehiculos completaron el recorrido\n", config.max_autos);
+    if (calle.total_vehiculos_completados == calle.total_vehiculos_creados && calle.num_vehiculos_activos == 0) {
+        printf("✓ EXITO: Todos los %d vehiculos completaron el recorrido\n", calle.total_vehiculos_creados);
     } else {
         printf("⚠ INCOMPLETO: %d/%d vehiculos completaron el recorrido\n", 
-               calle.total_vehiculos_completados, config.max_autos);
+               calle.total_vehiculos_completados, calle.total_vehiculos_creados);
         printf("Vehiculos restantes en el sistema: %d\n", calle.num_vehiculos_activos);
     }
     
     printf("Tiempo total de simulacion: %.2f segundos\n", calle.tiempo_actual);
+    printf("Cola de eventos (%s): maximo %d pendientes, %d asignaciones de memoria de la cola\n",
+           tipo_cola_str(cola.tipo), cola.max_size_alcanzado, cola.asignaciones_cola);
     
-    imprimir_estadisticas_finales(todos_vehiculos, calle.total_vehiculos_creados);
+    printf("Pool de vehiculos: maximo %d en uso, %d bloques de %d\n",
+           pool.max_en_uso, pool.num_bloques, VEHICULOS_POR_BLOQUE);
     
-    // Liberar memoria de vehiculos restantes en la cola
-    while (cola.inicio) {
-        Evento* e = obtener_siguiente_evento_seguro(&cola);
-        if (e) free(e);
-    }
+    imprimir_estadisticas_finales();
+    cerrar_resumenes();
     
-    // Liberar memoria de todos los vehiculos
-    for (int i = 0; i < calle.total_vehiculos_creados; i++) {
-        if (todos_vehiculos[i]) {
-            free(todos_vehiculos[i]);
-            todos_vehiculos[i] = NULL;
-        }
-    }
+    // Liberar eventos restantes y nodos reciclados de la cola
+    liberar_cola_eventos(&cola);
     
-    free(todos_vehiculos);
+    // Los que no llegaron a salir siguen en el pool; se liberan con sus bloques
+    liberar_pool_vehiculos();
     printf("Memoria de vehiculos liberada correctamente.\n");
 }
 
@@ -994,8 +1889,13 @@ int validar_configuracion() {
     printf("\n=== VALIDACION FINAL ===\n");
     
     // Validar límites básicos
-    if (config.max_autos <= 0 || config.max_autos > 5000) {
-        fprintf(stderr, "ERROR: max_autos debe estar entre 1 y 5000 (actual: %d)\n", config.max_autos);
+    if (config.max_autos < 0) {
+        fprintf(stderr, "ERROR: max_autos debe ser 0 (sin tope) o positivo (actual: %d)\n", config.max_autos);
+        errores++;
+    }
+    
+    if (config.max_autos == 0 && config.tiempo_limite_simulacion == 0.0) {
+        fprintf(stderr, "ERROR: Sin tope de autos hace falta un tiempo límite para cerrar las llegadas\n");
         errores++;
     }
     
@@ -1054,12 +1954,10 @@ int validar_configuracion() {
     }
     
     // Validar tiempo límite (opcional)
-    if (config.tiempo_limite_simulacion < 0.0 || config.tiempo_limite_simulacion > 7200.0) {
-        if (config.tiempo_limite_simulacion != 0.0) { // 0 = sin límite, es válido
-            fprintf(stderr, "ERROR: tiempo_limite_simulacion debe ser 0 (sin límite) o entre 1 y 7200s (actual: %.1f)\n", 
-                    config.tiempo_limite_simulacion);
-            errores++;
-        }
+    if (config.tiempo_limite_simulacion < 0.0 || config.tiempo_limite_simulacion > TIEMPO_LIMITE_MAXIMO) {
+        fprintf(stderr, "ERROR: tiempo_limite_simulacion debe ser 0 (sin límite) o hasta %.0fs (actual: %.1f)\n", 
+                TIEMPO_LIMITE_MAXIMO, config.tiempo_limite_simulacion);
+        errores++;
     }
     
     // Validaciones de coherencia
@@ -1081,16 +1979,19 @@ int validar_configuracion() {
         printf("ADVERTENCIA: Paso de simulación grande comparado con intervalo de entrada. Puede afectar precisión.\n");
     }
     
-    // Estimación de memoria requerida
-    size_t memoria_estimada = config.max_autos * sizeof(Vehiculo) + 
-                             config.max_autos * sizeof(Vehiculo*) + 
+    // Estimación de memoria requerida: los vehículos que caben a la vez en la
+    // calle, no el total de la corrida (el pool recicla los que salen)
+    size_t max_simultaneos = (size_t)(config.longitud_total /
+                                      (params.longitud_vehiculo + params.distancia_seguridad_min)) + 2;
+    size_t memoria_estimada = max_simultaneos * sizeof(Vehiculo) + 
+                             max_simultaneos * sizeof(Vehiculo*) + 
                              sizeof(SistemaCalle);
     double memoria_mb = memoria_estimada / (1024.0 * 1024.0);
     
     if (memoria_mb > 100.0) {
         printf("ADVERTENCIA: Memoria estimada: %.1f MB. Simulación puede ser lenta.\n", memoria_mb);
     } else {
-        printf("Memoria estimada: %.2f MB\n", memoria_mb);
+        printf("Memoria estimada: %.2f MB (hasta %zu vehiculos a la vez)\n", memoria_mb, max_simultaneos);
     }
     
     // Estimación de tiempo de ejecucion
@@ -1105,10 +2006,11 @@ int validar_configuracion() {
                    tiempo_estimado_total / 60.0);
         }
     } else {
-        printf("Límite de tiempo configurado: %.1f segundos\n", config.tiempo_limite_simulacion);
+        printf("Llegadas hasta: %.1f segundos (%lld vehiculos previstos)\n",
+               config.tiempo_limite_simulacion, vehiculos_previstos());
     }
     
-    double eventos_estimados = config.max_autos * (config.longitud_total / params.velocidad_maxima) / config.paso_simulacion;
+    double eventos_estimados = vehiculos_previstos() * (config.longitud_total / params.velocidad_maxima) / config.paso_simulacion;
     if (eventos_estimados > 2000000) {
         printf("ADVERTENCIA: Eventos estimados: %.0f. Simulación puede tardar mucho tiempo.\n", eventos_estimados);
     }
@@ -1225,8 +2127,8 @@ void configurar_simulacion_personalizada() {
     if (respuesta == 's' || respuesta == 'S') {
         printf("\n--- CONFIGURACION DE VEHICULOS ---\n");
         config.max_autos = leer_entero_validado(
-            "Número máximo de autos", 
-            config.max_autos, 1, 5000
+            "Número máximo de autos (0 = sin tope, hasta el tiempo límite)", 
+            config.max_autos, 0, MAX_AUTOS_CONFIGURABLE
         );
         
         config.intervalo_entrada_vehiculos = leer_double_validado(
@@ -1286,15 +2188,25 @@ void configurar_simulacion_personalizada() {
             );
             
             // Opción para límite de tiempo (opcional)
-            char usar_limite = leer_si_no("¿Usar límite de tiempo? (recomendado: NO para completar todos los vehiculos)");
+            char usar_limite = leer_si_no("¿Usar límite de tiempo? (cierra las llegadas; los que entraron completan el recorrido)");
             if (usar_limite == 's' || usar_limite == 'S') {
                 config.tiempo_limite_simulacion = leer_double_validado(
-                    "Tiempo límite de simulación (segundos, 0 = sin límite)",
-                    config.tiempo_limite_simulacion, 0.0, 7200.0
+                    "Tiempo límite de llegadas (segundos, 0 = sin límite)",
+                    config.tiempo_limite_simulacion, 0.0, TIEMPO_LIMITE_MAXIMO
                 );
             } else {
                 config.tiempo_limite_simulacion = 0.0; // Sin límite
-                printf("✓ Simulación sin límite de tiempo - todos los vehiculos completarán el recorrido\n");
+            }
+            if (config.tiempo_limite_simulacion == 0.0) {
+                // Sin límite de tiempo ni tope las llegadas no terminarían
+                if (config.max_autos == 0) {
+                    printf("Sin límite de tiempo hace falta un tope de vehiculos.\n");
+                    config.max_autos = leer_entero_validado(
+                        "Número máximo de autos",
+                        MAX_AUTOS_POR_DEFECTO, 1, MAX_AUTOS_CONFIGURABLE
+                    );
+                }
+                printf("✓ Llegadas sin límite de tiempo - entran los %d vehiculos configurados\n", config.max_autos);
             }
             
             params.aceleracion_maxima = leer_double_validado(
@@ -1312,6 +2224,21 @@ void configurar_simulacion_personalizada() {
                 "Distancia mínima de seguridad (metros)",
                 params.distancia_seguridad_min, 1.0, 20.0
             );
+            
+            config.tipo_cola_eventos = leer_entero_validado(
+                "Cola de eventos (0 = lista enlazada, 1 = calendario)",
+                config.tipo_cola_eventos, COLA_LISTA, COLA_CALENDARIO
+            );
+            
+            config.formato_trazas = leer_entero_validado(
+                "Formato de trazas de estados (0 = CSV, 1 = binario .trz)",
+                config.formato_trazas, FORMATO_TRAZA_CSV, FORMATO_TRAZA_BINARIO
+            );
+            
+            config.modo_avance = leer_entero_validado(
+                "Avance en flujo libre y colas detenidas (0 = paso fijo, 1 = analítico)",
+                config.modo_avance, AVANCE_PASO_FIJO, AVANCE_ANALITICO
+            );
         } else {
             // Si no configura avanzado, mantener sin límite de tiempo
             config.tiempo_limite_simulacion = 0.0;
@@ -1349,7 +2276,11 @@ void configurar_simulacion_personalizada() {
     
     // Mostrar configuración final
     printf("\n=== CONFIGURACIoN FINAL ===\n");
-    printf("Máximo autos: %d\n", config.max_autos);
+    if (config.max_autos > 0) {
+        printf("Máximo autos: %d\n", config.max_autos);
+    } else {
+        printf("Máximo autos: sin tope\n");
+    }
     printf("Longitud calle: %.1f m\n", config.longitud_total);
     printf("Posición Semaforo: %.1f m\n", config.posicion_semaforo);
     printf("Intervalo entrada: %.1f s\n", config.intervalo_entrada_vehiculos);
@@ -1358,9 +2289,15 @@ void configurar_simulacion_personalizada() {
     printf("Semaforo - Verde: %.1fs, Rojo: %.1fs\n", 
            semaforo.duracion_verde, semaforo.duracion_rojo);
     printf("Paso de simulación: %.3f s\n", config.paso_simulacion);
+    printf("Cola de eventos: %s\n", tipo_cola_str(config.tipo_cola_eventos));
+    printf("Trazas de estados: %s\n",
+           (config.formato_trazas == FORMATO_TRAZA_BINARIO) ? "binario .trz (exportar con trazaACsv)" : "CSV");
+    printf("Avance en flujo libre y colas detenidas: %s\n",
+           (config.modo_avance == AVANCE_ANALITICO) ? "analítico (la traza omite los pasos triviales)" : "paso fijo");
     
     if (config.tiempo_limite_simulacion > 0.0) {
-        printf("Límite de tiempo: %.1f s\n", config.tiempo_limite_simulacion);
+        printf("Límite de tiempo: llegadas hasta %.1f s (los que entraron completan el recorrido)\n",
+               config.tiempo_limite_simulacion);
     } else {
         printf("Límite de tiempo: NINGUNO (completar todos los vehiculos)\n");
     }
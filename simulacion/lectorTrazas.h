@@ -0,0 +1,720 @@
+#ifndef LECTOR_TRAZAS_H
+#define LECTOR_TRAZAS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "trazas.h"
+
+// ============================================================================
+// LECTOR DE TRAZAS MAPEADO EN MEMORIA CON ÍNDICE
+// ============================================================================
+//
+// Mapea una traza de estados (.csv o .trz) y la consulta por ventana de tiempo
+// o por vehículo sin recorrer todo el archivo. El índice se guarda al lado de
+// la traza ("<traza>.idx") y se reconstruye si la traza cambió de tamaño o de
+// fecha de modificación:
+//   - Bloques de LECTOR_REGISTROS_POR_BLOQUE registros con el byte donde
+//     empiezan y su rango de tiempo. Los registros llegan casi ordenados por
+//     tiempo (solo se intercalan los bloques de cada thread), así que los
+//     rangos son estrechos y una ventana de tiempo toca pocos bloques.
+//   - Por cada ID, la lista de sus números de registro en orden de archivo
+//     (inicio_vehiculo[id] .. inicio_vehiculo[id + 1] en registros_vehiculo).
+// Los tiempos se comparan en centésimas enteras, como se guardan en el .trz y
+// se imprimen en el CSV.
+//
+// Uso compartido por trazaACsv y consultaTrazas; enlazar con -pthread -lm.
+
+#define LECTOR_REGISTROS_POR_BLOQUE 64
+#define LECTOR_MAX_COLUMNAS 16
+#define LECTOR_MAX_NOMBRES 32
+
+#define INDICE_MAGIA "TRZIDX01"
+#define INDICE_VERSION 1
+
+// ============================================================================
+// MAPEO DE ARCHIVOS (POSIX / WINDOWS)
+// ============================================================================
+
+// Tamaño y fecha de un archivo abierto. En Windows (ucrt64) 'struct stat' y
+// 'fstat' tienen st_size de 32 bits, así que se usan las variantes de 64
+#ifdef _WIN32
+typedef struct _stat64 EstadoArchivo;
+#define lector_fstat _fstat64
+#define LECTOR_O_BINARIO O_BINARY
+#else
+typedef struct stat EstadoArchivo;
+#define lector_fstat fstat
+#define LECTOR_O_BINARIO 0
+#endif
+
+// Mapea 'tam' bytes de un archivo abierto, solo lectura. NULL si falla.
+// El mapeo sigue válido aunque después se cierre el descriptor.
+static inline void* lector_mapear(int fd, size_t tam) {
+#ifdef _WIN32
+    HANDLE archivo = (HANDLE)_get_osfhandle(fd);
+    if (archivo == INVALID_HANDLE_VALUE) return NULL;
+    HANDLE mapeo = CreateFileMapping(archivo, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapeo) return NULL;
+    void* memoria = MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, tam);
+    CloseHandle(mapeo);  // La vista mantiene vivo el mapeo
+    return memoria;
+#else
+    void* memoria = mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+    return memoria == MAP_FAILED ? NULL : memoria;
+#endif
+}
+
+static inline void lector_desmapear(const void* memoria, size_t tam) {
+#ifdef _WIN32
+    (void)tam;
+    UnmapViewOfFile(memoria);
+#else
+    munmap((void*)memoria, tam);
+#endif
+}
+
+// Pista de acceso secuencial (lectura anticipada) o normal. En Windows no hay
+// equivalente por rango para una vista ya mapeada y se ignora.
+static inline void lector_aconsejar(const void* memoria, size_t tam, int secuencial) {
+#ifdef _WIN32
+    (void)memoria;
+    (void)tam;
+    (void)secuencial;
+#else
+    madvise((void*)memoria, tam, secuencial ? MADV_SEQUENTIAL : MADV_NORMAL);
+#endif
+}
+
+// Modos de apertura
+#define LECTOR_SIN_INDICE 0       // Solo recorridos completos
+#define LECTOR_CON_INDICE 1       // Carga el .idx o lo construye
+#define LECTOR_REINDEXAR 2        // Construye el .idx aunque exista
+
+typedef struct {
+    uint64_t desplazamiento;   // Byte del primer registro del bloque
+    int32_t tiempo_min;        // Centésimas de segundo (INT32_MAX si vacío)
+    int32_t tiempo_max;
+} BloqueIndice;
+
+typedef struct {
+    char magia[8];
+    uint32_t version;
+    uint32_t formato;          // FORMATO_TRAZA_CSV o FORMATO_TRAZA_BINARIO
+    uint64_t tam_traza;        // Tamaño y fecha de la traza indexada
+    int64_t mtime_traza;
+    uint64_t num_registros;
+    uint64_t num_bloques;
+    int32_t id_min;
+    int32_t id_max;            // id_max < id_min si no hay registros válidos
+} EncabezadoIndice;
+// Siguen: BloqueIndice[num_bloques], uint64_t inicio_vehiculo[num_ids + 1],
+// uint32_t registros_vehiculo[inicio_vehiculo[num_ids]]
+
+typedef enum {
+    COL_TIEMPO,
+    COL_ID,
+    COL_DIRECCION,
+    COL_POSICION,
+    COL_VELOCIDAD,
+    COL_ACELERACION,
+    COL_ESTADO,
+    COL_SEMAFORO,
+    COL_HILO,
+    COL_DESCONOCIDA
+} TipoColumna;
+
+typedef struct {
+    char texto[512];
+    char* nombres[LECTOR_MAX_NOMBRES];
+    int num;
+} ListaNombres;
+
+typedef struct {
+    int formato;
+    int descriptor;
+    const char* datos;            // Traza completa mapeada
+    size_t tam;
+    size_t inicio_registros;      // Byte del primer registro (tras el encabezado)
+
+    // Descripción: texto del encabezado .trz o primera línea del CSV
+    char texto[TRAZA_MAX_TEXTO];
+    char columnas_csv[512];
+    ListaNombres estados;
+    ListaNombres semaforos;
+    ListaNombres direcciones;
+    TipoColumna tipos[LECTOR_MAX_COLUMNAS];
+    int num_columnas;
+
+    // Índice
+    int tiene_indice;
+    int indice_cargado;           // 1 si se leyó del .idx, 0 si se construyó
+    double segundos_indice;
+    EncabezadoIndice indice;
+    const BloqueIndice* bloques;
+    const uint64_t* inicio_vehiculo;
+    const uint32_t* registros_vehiculo;
+    void* memoria_indice;         // mmap del .idx o buffer propio
+    size_t tam_memoria_indice;
+    int indice_mapeado;
+} LectorTrazas;
+
+// Registro visto por las consultas: tiempo e ID decodificados y los bytes
+// originales (RegistroTraza o línea CSV sin '\n')
+typedef struct {
+    int32_t tiempo;
+    int32_t id;                   // -1 si la línea no se pudo interpretar
+    const char* inicio;
+    size_t largo;
+} EntradaTraza;
+
+typedef void (*VisitarEntradaTraza)(const LectorTrazas* l, const EntradaTraza* e, void* contexto);
+
+// ============================================================================
+// DESCRIPCIÓN Y DECODIFICACIÓN
+// ============================================================================
+
+// Separa "A,B,C" en la lista (copia el texto)
+static inline void lector_separar_lista(const char* texto, ListaNombres* lista) {
+    snprintf(lista->texto, sizeof(lista->texto), "%s", texto);
+    lista->num = 0;
+    char* resto = lista->texto;
+    while (resto && *resto && lista->num < LECTOR_MAX_NOMBRES) {
+        lista->nombres[lista->num++] = resto;
+        resto = strchr(resto, ',');
+        if (resto) *resto++ = '\0';
+    }
+}
+
+static inline const char* lector_nombre(const ListaNombres* lista, int i) {
+    return (i >= 0 && i < lista->num) ? lista->nombres[i] : "DESCONOCIDO";
+}
+
+static inline TipoColumna lector_tipo_columna(const char* nombre) {
+    if (strcmp(nombre, "Tiempo") == 0) return COL_TIEMPO;
+    if (strcmp(nombre, "ID") == 0) return COL_ID;
+    if (strcmp(nombre, "Direccion") == 0) return COL_DIRECCION;
+    if (strcmp(nombre, "Posicion") == 0) return COL_POSICION;
+    if (strcmp(nombre, "Velocidad") == 0) return COL_VELOCIDAD;
+    if (strcmp(nombre, "Aceleracion") == 0) return COL_ACELERACION;
+    if (strcmp(nombre, "Estado") == 0 || strcmp(nombre, "EstadoVehiculo") == 0) return COL_ESTADO;
+    if (strcmp(nombre, "Semaforo") == 0) return COL_SEMAFORO;
+    if (strcmp(nombre, "Thread") == 0) return COL_HILO;
+    return COL_DESCONOCIDA;
+}
+
+// Lee "123.45" / "-0.5" / "7" en centésimas; avanza *p. 0 si no hay número.
+static inline int lector_leer_centesimas(const char** p, const char* fin, int32_t* valor) {
+    const char* q = *p;
+    int negativo = 0;
+    if (q < fin && *q == '-') {
+        negativo = 1;
+        q++;
+    }
+    if (q >= fin || *q < '0' || *q > '9') return 0;
+
+    int64_t v = 0;
+    while (q < fin && *q >= '0' && *q <= '9') v = v * 10 + (*q++ - '0');
+    v *= 100;
+    if (q < fin && *q == '.') {
+        q++;
+        if (q < fin && *q >= '0' && *q <= '9') v += 10 * (*q++ - '0');
+        if (q < fin && *q >= '0' && *q <= '9') v += *q++ - '0';
+        while (q < fin && *q >= '0' && *q <= '9') q++;
+    }
+
+    *valor = (int32_t)(negativo ? -v : v);
+    *p = q;
+    return 1;
+}
+
+// Lee un entero no negativo; avanza *p. 0 si no hay número o no cabe en int32.
+static inline int lector_leer_entero(const char** p, const char* fin, int32_t* valor) {
+    const char* q = *p;
+    int64_t v = 0;
+    while (q < fin && *q >= '0' && *q <= '9' && v <= INT32_MAX) v = v * 10 + (*q++ - '0');
+    if (q == *p || v > INT32_MAX) return 0;
+    *valor = (int32_t)v;
+    *p = q;
+    return 1;
+}
+
+// Decodifica el registro que empieza en p y devuelve el inicio del siguiente
+static inline const char* lector_decodificar(const LectorTrazas* l, const char* p, EntradaTraza* e) {
+    const char* fin_archivo = l->datos + l->tam;
+
+    if (l->formato == FORMATO_TRAZA_BINARIO) {
+        const RegistroTraza* r = (const RegistroTraza*)p;
+        e->tiempo = r->tiempo;
+        e->id = r->id;
+        e->inicio = p;
+        e->largo = sizeof(RegistroTraza);
+        return p + sizeof(RegistroTraza);
+    }
+
+    const char* fin = (const char*)memchr(p, '\n', fin_archivo - p);
+    if (!fin) fin = fin_archivo;
+    e->inicio = p;
+    e->largo = fin - p;
+
+    // Ambos simuladores empiezan la línea con Tiempo,ID
+    const char* q = p;
+    if (!lector_leer_centesimas(&q, fin, &e->tiempo) || q >= fin || *q++ != ',' ||
+        !lector_leer_entero(&q, fin, &e->id) || (q < fin && *q != ',')) {
+        e->id = -1;
+    }
+
+    return (fin < fin_archivo) ? fin + 1 : fin;
+}
+
+static inline int lector_cargar_descripcion(LectorTrazas* l) {
+    char columnas[512] = "";
+    char estados[512] = "", semaforos[512] = "", direcciones[512] = "";
+
+    if (l->tam >= sizeof(EncabezadoTraza) && memcmp(l->datos, TRAZA_MAGIA, 8) == 0) {
+        const EncabezadoTraza* e = (const EncabezadoTraza*)l->datos;
+        if (e->tam_encabezado > l->tam ||
+            !traza_validar_encabezado(e, l->datos + sizeof(*e), l->texto, sizeof(l->texto)) ||
+            !traza_valor(l->texto, "csv_columnas", columnas, sizeof(columnas))) {
+            return 0;
+        }
+        traza_valor(l->texto, "estados", estados, sizeof(estados));
+        traza_valor(l->texto, "semaforo", semaforos, sizeof(semaforos));
+        traza_valor(l->texto, "direcciones", direcciones, sizeof(direcciones));
+        l->formato = FORMATO_TRAZA_BINARIO;
+        l->inicio_registros = e->tam_encabezado;
+    } else {
+        // CSV: la primera línea son las columnas
+        const char* fin = (const char*)memchr(l->datos, '\n', l->tam);
+        size_t largo = fin ? (size_t)(fin - l->datos) : l->tam;
+        if (largo >= sizeof(columnas)) return 0;
+        memcpy(columnas, l->datos, largo);
+        columnas[largo] = '\0';
+        l->texto[0] = '\0';
+        l->formato = FORMATO_TRAZA_CSV;
+        l->inicio_registros = fin ? largo + 1 : largo;
+    }
+
+    snprintf(l->columnas_csv, sizeof(l->columnas_csv), "%s", columnas);
+    lector_separar_lista(estados, &l->estados);
+    lector_separar_lista(semaforos, &l->semaforos);
+    lector_separar_lista(direcciones, &l->direcciones);
+
+    ListaNombres lista;
+    lector_separar_lista(columnas, &lista);
+    l->num_columnas = (lista.num < LECTOR_MAX_COLUMNAS) ? lista.num : LECTOR_MAX_COLUMNAS;
+    for (int c = 0; c < l->num_columnas; c++) {
+        l->tipos[c] = lector_tipo_columna(lista.nombres[c]);
+    }
+    return 1;
+}
+
+// Número de registros completos (en CSV solo se conoce con el índice)
+static inline uint64_t lector_trazas_num_registros(const LectorTrazas* l) {
+    if (l->tiene_indice) return l->indice.num_registros;
+    if (l->formato == FORMATO_TRAZA_BINARIO) {
+        return (l->tam - l->inicio_registros) / sizeof(RegistroTraza);
+    }
+    return 0;
+}
+
+// ============================================================================
+// ÍNDICE
+// ============================================================================
+
+static inline size_t lector_tam_indice(uint64_t num_bloques, uint64_t num_ids, uint64_t num_entradas) {
+    return sizeof(EncabezadoIndice) + num_bloques * sizeof(BloqueIndice) +
+           (num_ids + 1) * sizeof(uint64_t) + num_entradas * sizeof(uint32_t);
+}
+
+// Apunta bloques/inicio_vehiculo/registros_vehiculo dentro de memoria_indice
+static inline void lector_ubicar_indice(LectorTrazas* l) {
+    const char* base = (const char*)l->memoria_indice;
+    memcpy(&l->indice, base, sizeof(EncabezadoIndice));
+    base += sizeof(EncabezadoIndice);
+    l->bloques = (const BloqueIndice*)base;
+    base += l->indice.num_bloques * sizeof(BloqueIndice);
+    l->inicio_vehiculo = (const uint64_t*)base;
+    uint64_t num_ids = (l->indice.id_max >= l->indice.id_min)
+                           ? (uint64_t)l->indice.id_max - l->indice.id_min + 1 : 0;
+    base += (num_ids + 1) * sizeof(uint64_t);
+    l->registros_vehiculo = (const uint32_t*)base;
+}
+
+static inline int lector_cargar_indice(LectorTrazas* l, const char* ruta_indice, const EstadoArchivo* st) {
+    int fd = open(ruta_indice, O_RDONLY | LECTOR_O_BINARIO);
+    if (fd < 0) return 0;
+
+    EstadoArchivo st_indice;
+    if (lector_fstat(fd, &st_indice) != 0 || (size_t)st_indice.st_size < sizeof(EncabezadoIndice)) {
+        close(fd);
+        return 0;
+    }
+
+    size_t tam = (size_t)st_indice.st_size;
+    void* memoria = lector_mapear(fd, tam);
+    close(fd);
+    if (!memoria) return 0;
+
+    EncabezadoIndice e;
+    memcpy(&e, memoria, sizeof(e));
+    uint64_t num_ids = (e.id_max >= e.id_min) ? (uint64_t)e.id_max - e.id_min + 1 : 0;
+    int valido = memcmp(e.magia, INDICE_MAGIA, 8) == 0 && e.version == INDICE_VERSION &&
+                 e.formato == (uint32_t)l->formato && e.tam_traza == (uint64_t)st->st_size &&
+                 e.mtime_traza == (int64_t)st->st_mtime &&
+                 tam >= lector_tam_indice(e.num_bloques, num_ids, 0);
+    if (valido) {
+        const uint64_t* inicio = (const uint64_t*)((const char*)memoria + sizeof(e) +
+                                                   e.num_bloques * sizeof(BloqueIndice));
+        valido = tam == lector_tam_indice(e.num_bloques, num_ids, inicio[num_ids]);
+    }
+    if (!valido) {
+        lector_desmapear(memoria, tam);
+        return 0;
+    }
+
+    l->memoria_indice = memoria;
+    l->tam_memoria_indice = tam;
+    l->indice_mapeado = 1;
+    lector_ubicar_indice(l);
+    return 1;
+}
+
+// Construye el índice con dos pasadas sobre la traza y lo guarda en ruta_indice
+static inline int lector_construir_indice(LectorTrazas* l, const char* ruta_indice, const EstadoArchivo* st) {
+    const char* inicio = l->datos + l->inicio_registros;
+    const char* fin = l->datos + l->tam;
+    if (l->formato == FORMATO_TRAZA_BINARIO) {
+        fin = inicio + (l->tam - l->inicio_registros) / sizeof(RegistroTraza) * sizeof(RegistroTraza);
+    }
+
+    // Pasada 1: bloques con su rango de tiempo y registros por ID
+    size_t cap_bloques = 1024, cap_ids = 1024;
+    BloqueIndice* bloques = (BloqueIndice*)malloc(cap_bloques * sizeof(BloqueIndice));
+    uint64_t* conteo = (uint64_t*)calloc(cap_ids, sizeof(uint64_t));
+    if (!bloques || !conteo) {
+        free(bloques);
+        free(conteo);
+        return 0;
+    }
+
+    uint64_t num_registros = 0, num_bloques = 0, num_entradas = 0;
+    int32_t id_min = INT32_MAX, id_max = -1;
+    EntradaTraza e;
+
+    for (const char* p = inicio; p < fin; num_registros++) {
+        if (num_registros % LECTOR_REGISTROS_POR_BLOQUE == 0) {
+            if (num_bloques == cap_bloques) {
+                cap_bloques *= 2;
+                BloqueIndice* nuevos = (BloqueIndice*)realloc(bloques, cap_bloques * sizeof(BloqueIndice));
+                if (!nuevos) {
+                    free(bloques);
+                    free(conteo);
+                    return 0;
+                }
+                bloques = nuevos;
+            }
+            bloques[num_bloques].desplazamiento = (uint64_t)(p - l->datos);
+            bloques[num_bloques].tiempo_min = INT32_MAX;
+            bloques[num_bloques].tiempo_max = INT32_MIN;
+            num_bloques++;
+        }
+
+        p = lector_decodificar(l, p, &e);
+        if (e.id < 0) continue;
+
+        BloqueIndice* b = &bloques[num_bloques - 1];
+        if (e.tiempo < b->tiempo_min) b->tiempo_min = e.tiempo;
+        if (e.tiempo > b->tiempo_max) b->tiempo_max = e.tiempo;
+
+        if ((size_t)e.id >= cap_ids) {
+            size_t nueva = cap_ids;
+            while ((size_t)e.id >= nueva) nueva *= 2;
+            uint64_t* nuevos = (uint64_t*)realloc(conteo, nueva * sizeof(uint64_t));
+            if (!nuevos) {
+                free(bloques);
+                free(conteo);
+                return 0;
+            }
+            memset(nuevos + cap_ids, 0, (nueva - cap_ids) * sizeof(uint64_t));
+            conteo = nuevos;
+            cap_ids = nueva;
+        }
+        conteo[e.id]++;
+        num_entradas++;
+        if (e.id < id_min) id_min = e.id;
+        if (e.id > id_max) id_max = e.id;
+    }
+
+    if (num_registros > UINT32_MAX) {
+        fprintf(stderr, "ERROR: la traza tiene más registros de los que indexa el formato\n");
+        free(bloques);
+        free(conteo);
+        return 0;
+    }
+    if (id_max < 0) id_min = 0;
+    uint64_t num_ids = (id_max >= id_min) ? (uint64_t)(id_max - id_min + 1) : 0;
+
+    // Reservar el índice con la misma forma que el archivo .idx
+    size_t tam = lector_tam_indice(num_bloques, num_ids, num_entradas);
+    char* memoria = (char*)malloc(tam);
+    if (!memoria) {
+        free(bloques);
+        free(conteo);
+        return 0;
+    }
+
+    EncabezadoIndice* encabezado = (EncabezadoIndice*)memoria;
+    memset(encabezado, 0, sizeof(*encabezado));
+    memcpy(encabezado->magia, INDICE_MAGIA, 8);
+    encabezado->version = INDICE_VERSION;
+    encabezado->formato = (uint32_t)l->formato;
+    encabezado->tam_traza = (uint64_t)st->st_size;
+    encabezado->mtime_traza = (int64_t)st->st_mtime;
+    encabezado->num_registros = num_registros;
+    encabezado->num_bloques = num_bloques;
+    encabezado->id_min = id_min;
+    encabezado->id_max = id_max;
+
+    l->memoria_indice = memoria;
+    l->tam_memoria_indice = tam;
+    l->indice_mapeado = 0;
+    lector_ubicar_indice(l);
+    memcpy((void*)l->bloques, bloques, num_bloques * sizeof(BloqueIndice));
+    free(bloques);
+
+    // Inicio de cada ID (suma prefija); 'conteo' pasa a ser el cursor de llenado
+    uint64_t* inicio_vehiculo = (uint64_t*)l->inicio_vehiculo;
+    uint64_t acumulado = 0;
+    for (uint64_t i = 0; i < num_ids; i++) {
+        inicio_vehiculo[i] = acumulado;
+        acumulado += conteo[id_min + i];
+        conteo[id_min + i] = inicio_vehiculo[i];
+    }
+    inicio_vehiculo[num_ids] = acumulado;
+
+    // Pasada 2: números de registro de cada ID, en orden de archivo
+    uint32_t* registros_vehiculo = (uint32_t*)l->registros_vehiculo;
+    uint32_t n = 0;
+    for (const char* p = inicio; p < fin; n++) {
+        p = lector_decodificar(l, p, &e);
+        if (e.id >= 0) registros_vehiculo[conteo[e.id]++] = n;
+    }
+    free(conteo);
+
+    // Guardar el .idx (si no se puede, el índice sigue sirviendo en memoria)
+    FILE* archivo = fopen(ruta_indice, "wb");
+    if (!archivo || fwrite(memoria, 1, tam, archivo) != tam) {
+        fprintf(stderr, "⚠️  No se pudo guardar el índice %s\n", ruta_indice);
+    }
+    if (archivo) fclose(archivo);
+    return 1;
+}
+
+// ============================================================================
+// APERTURA Y CONSULTAS
+// ============================================================================
+
+static inline void lector_trazas_cerrar(LectorTrazas* l) {
+    if (l->memoria_indice) {
+        if (l->indice_mapeado) lector_desmapear(l->memoria_indice, l->tam_memoria_indice);
+        else free(l->memoria_indice);
+    }
+    if (l->datos) lector_desmapear(l->datos, l->tam);
+    if (l->descriptor >= 0) close(l->descriptor);
+    memset(l, 0, sizeof(*l));
+    l->descriptor = -1;
+}
+
+// Mapea la traza y, según 'modo', carga o construye el índice. 0 si falla.
+static inline int lector_trazas_abrir(LectorTrazas* l, const char* ruta, int modo) {
+    memset(l, 0, sizeof(*l));
+    l->descriptor = -1;
+
+    int fd = open(ruta, O_RDONLY | LECTOR_O_BINARIO);
+    if (fd < 0) return 0;
+
+    EstadoArchivo st;
+    if (lector_fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void* datos = lector_mapear(fd, (size_t)st.st_size);
+    if (!datos) {
+        close(fd);
+        return 0;
+    }
+    l->descriptor = fd;
+    l->datos = (const char*)datos;
+    l->tam = (size_t)st.st_size;
+
+    // Desde aquí los fallos cierran por lector_trazas_cerrar, que deja el
+    // lector listo para otro cierre
+    if (!lector_cargar_descripcion(l)) {
+        lector_trazas_cerrar(l);
+        return 0;
+    }
+
+    if (modo == LECTOR_SIN_INDICE) return 1;
+
+    char ruta_indice[1024];
+    snprintf(ruta_indice, sizeof(ruta_indice), "%s.idx", ruta);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (modo != LECTOR_REINDEXAR && lector_cargar_indice(l, ruta_indice, &st)) {
+        l->indice_cargado = 1;
+    } else {
+        lector_aconsejar(datos, l->tam, 1);
+        if (!lector_construir_indice(l, ruta_indice, &st)) {
+            lector_trazas_cerrar(l);
+            return 0;
+        }
+        lector_aconsejar(datos, l->tam, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    l->segundos_indice = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    l->tiene_indice = 1;
+    return 1;
+}
+
+// Recorre toda la traza en orden de archivo (no necesita índice)
+static inline long long lector_trazas_recorrer(const LectorTrazas* l, VisitarEntradaTraza visitar, void* contexto) {
+    const char* p = l->datos + l->inicio_registros;
+    const char* fin = l->datos + l->tam;
+    if (l->formato == FORMATO_TRAZA_BINARIO) {
+        fin = p + (l->tam - l->inicio_registros) / sizeof(RegistroTraza) * sizeof(RegistroTraza);
+    }
+
+    lector_aconsejar(l->datos, l->tam, 1);
+    long long visitados = 0;
+    EntradaTraza e;
+    while (p < fin) {
+        p = lector_decodificar(l, p, &e);
+        if (e.id < 0) continue;
+        visitar(l, &e, contexto);
+        visitados++;
+    }
+    return visitados;
+}
+
+// Visita los registros con tiempo en [desde, hasta] (centésimas) en orden de
+// archivo. Requiere índice; devuelve cuántos visitó.
+static inline long long lector_trazas_por_tiempo(const LectorTrazas* l, int32_t desde, int32_t hasta,
+                                                 VisitarEntradaTraza visitar, void* contexto) {
+    long long visitados = 0;
+    EntradaTraza e;
+
+    for (uint64_t b = 0; b < l->indice.num_bloques; b++) {
+        const BloqueIndice* bloque = &l->bloques[b];
+        if (bloque->tiempo_max < desde || bloque->tiempo_min > hasta) continue;
+
+        uint64_t restantes = l->indice.num_registros - b * LECTOR_REGISTROS_POR_BLOQUE;
+        int en_bloque = (restantes < LECTOR_REGISTROS_POR_BLOQUE) ? (int)restantes : LECTOR_REGISTROS_POR_BLOQUE;
+        const char* p = l->datos + bloque->desplazamiento;
+        for (int k = 0; k < en_bloque; k++) {
+            p = lector_decodificar(l, p, &e);
+            if (e.id >= 0 && e.tiempo >= desde && e.tiempo <= hasta) {
+                visitar(l, &e, contexto);
+                visitados++;
+            }
+        }
+    }
+    return visitados;
+}
+
+// Visita los registros del vehículo 'id' con tiempo en [desde, hasta]
+static inline long long lector_trazas_por_vehiculo(const LectorTrazas* l, int32_t id, int32_t desde, int32_t hasta,
+                                                   VisitarEntradaTraza visitar, void* contexto) {
+    if (id < l->indice.id_min || id > l->indice.id_max) return 0;
+
+    uint64_t primero = l->inicio_vehiculo[id - l->indice.id_min];
+    uint64_t ultimo = l->inicio_vehiculo[id - l->indice.id_min + 1];
+    long long visitados = 0;
+
+    // En CSV se llega al registro n desde el inicio de su bloque; como los
+    // números vienen en orden, se sigue desde el anterior si es el mismo bloque
+    uint64_t bloque_actual = UINT64_MAX, registro_actual = 0;
+    const char* p = NULL;
+    EntradaTraza e;
+
+    for (uint64_t j = primero; j < ultimo; j++) {
+        uint64_t n = l->registros_vehiculo[j];
+        uint64_t b = n / LECTOR_REGISTROS_POR_BLOQUE;
+        const BloqueIndice* bloque = &l->bloques[b];
+        if (bloque->tiempo_max < desde || bloque->tiempo_min > hasta) continue;
+
+        if (l->formato == FORMATO_TRAZA_BINARIO) {
+            lector_decodificar(l, l->datos + l->inicio_registros + n * sizeof(RegistroTraza), &e);
+        } else {
+            if (b != bloque_actual) {
+                bloque_actual = b;
+                registro_actual = b * LECTOR_REGISTROS_POR_BLOQUE;
+                p = l->datos + bloque->desplazamiento;
+            }
+            while (registro_actual < n) {
+                p = (const char*)memchr(p, '\n', l->datos + l->tam - p) + 1;
+                registro_actual++;
+            }
+            p = lector_decodificar(l, p, &e);
+            registro_actual++;
+        }
+
+        if (e.tiempo >= desde && e.tiempo <= hasta) {
+            visitar(l, &e, contexto);
+            visitados++;
+        }
+    }
+    return visitados;
+}
+
+// Escribe la entrada como línea del CSV de estados
+static inline void lector_trazas_escribir_csv(const LectorTrazas* l, const EntradaTraza* e, FILE* salida) {
+    if (l->formato == FORMATO_TRAZA_CSV) {
+        fwrite(e->inicio, 1, e->largo, salida);
+        fputc('\n', salida);
+        return;
+    }
+
+    const RegistroTraza* r = (const RegistroTraza*)e->inicio;
+    char linea[256];
+    int n = 0;
+    for (int c = 0; c < l->num_columnas; c++) {
+        if (c > 0) linea[n++] = ',';
+        const char* nombre = NULL;
+        switch (l->tipos[c]) {
+            case COL_TIEMPO: n += traza_formatear_centesimas(linea + n, r->tiempo); break;
+            case COL_ID: n += snprintf(linea + n, sizeof(linea) - n, "%d", r->id); break;
+            case COL_DIRECCION: nombre = lector_nombre(&l->direcciones, r->direccion); break;
+            case COL_POSICION: n += traza_formatear_centesimas(linea + n, r->posicion); break;
+            case COL_VELOCIDAD: n += traza_formatear_centesimas(linea + n, r->velocidad); break;
+            case COL_ACELERACION: n += traza_formatear_centesimas(linea + n, r->aceleracion); break;
+            case COL_ESTADO: nombre = lector_nombre(&l->estados, r->estado); break;
+            case COL_SEMAFORO: nombre = lector_nombre(&l->semaforos, r->semaforo); break;
+            case COL_HILO: n += snprintf(linea + n, sizeof(linea) - n, "%d", r->hilo); break;
+            default: break;
+        }
+        if (nombre) {
+            size_t largo = strlen(nombre);
+            if (largo > sizeof(linea) - n - 2) largo = sizeof(linea) - n - 2;
+            memcpy(linea + n, nombre, largo);
+            n += (int)largo;
+        }
+    }
+    linea[n++] = '\n';
+    fwrite(linea, 1, n, salida);
+}
+
+#endif
@@ -1,9 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <limits.h>
+#include <sched.h>
 #include <omp.h>
+#include "trazas.h"
+#include "estadisticas.h"
 
 // ============================================================================
 // DEFINICIÓN DE CONSTANTES PARA INTERSECCIÓN
@@ -14,6 +19,30 @@
 #define ACTUALIZACION_VEHICULO 2
 #define SALIDA_SUR 3
 #define SALIDA_OESTE 4
+#define TICK 5
+#define SEMAFORO_CAMBIO 6
+
+// Modos de avance de la simulación
+#define MODO_EVENTOS 0   // Un evento ACTUALIZACION_VEHICULO por vehículo
+#define MODO_TICK 1      // Un evento TICK actualiza todos los vehículos en paralelo
+#define MODO_CONSERVADOR 2  // Calles y caja como procesos lógicos con sus propias colas
+#define MODO_OPTIMISTA 3    // Calles como procesos lógicos Time Warp que vuelven atrás
+
+// Avance de los vehículos en flujo libre (en los modos por evento)
+#define AVANCE_PASO_FIJO 0   // Una actualización por paso_simulacion
+#define AVANCE_ANALITICO 1   // Un evento por interacción (líder, intersección, salida)
+
+// Motivo por el que un vehículo detenido no genera eventos
+#define ESPERA_NINGUNA 0
+#define ESPERA_PASO 1        // Sin permiso para cruzar (semáforo u ocupación)
+#define ESPERA_LIDER 2       // Hasta que su líder avance
+
+// Control de la intersección
+#define CONTROL_SEMAFORO 0   // Semáforo de ciclo fijo y ocupación por dirección
+#define CONTROL_RESERVAS 1   // Cada vehículo reserva una ventana de cruce al aproximarse
+
+#define RANGO_BUSQUEDA_LIDER 50.0
+#define PERIODO_REPORTE 20.0   // Segundos simulados entre reportes de estado
 
 // Direcciones de movimiento
 typedef enum {
@@ -28,6 +57,20 @@ typedef enum {
     TRANSICION
 } EstadoInterseccion;
 
+// Límites de la demanda configurable
+#define MAX_AUTOS_CONFIGURABLE 1000000000
+#define TIEMPO_LIMITE_MAXIMO 604800.0   // Una semana simulada
+#define MAX_HILOS 1024
+
+// Identificadores de vehículo. Con un tope de hasta IDS_POR_CALLE autos por
+// calle, NS desde 1 y EO desde 1001 como siempre; sin tope (o con uno mayor),
+// impares en NS y pares en EO, así no se repiten entre calles (las trazas se
+// indexan por id)
+#define IDS_POR_CALLE 1000
+#define IDS_INTERCALADOS (config.max_autos_por_calle == 0 || config.max_autos_por_calle > IDS_POR_CALLE)
+#define PASO_ID_AUTO (IDS_INTERCALADOS ? 2 : 1)
+#define PRIMER_ID_AUTO(d) (IDS_INTERCALADOS ? 1 + (d) : 1 + (d) * IDS_POR_CALLE)
+
 // Parámetros configurables de simulación
 typedef struct {
     int num_secciones;
@@ -36,10 +79,15 @@ typedef struct {
     double longitud_calle_eo;     // Este-Oeste
     double posicion_interseccion; // Posición de la intersección en ambas calles
     double paso_simulacion;
-    int max_autos_por_calle;
+    int max_autos_por_calle;      // 0 = sin tope (llegadas hasta tiempo_limite_simulacion)
     double intervalo_entrada_vehiculos;
-    double tiempo_limite_simulacion;
+    double tiempo_limite_simulacion;  // Cierre de las llegadas; 0 = sin límite
     double ancho_interseccion;    // Tamaño de la zona de conflicto
+    int modo_simulacion;          // MODO_EVENTOS, MODO_TICK, MODO_CONSERVADOR o MODO_OPTIMISTA
+    int formato_trazas;           // FORMATO_TRAZA_CSV o FORMATO_TRAZA_BINARIO
+    int modo_avance;              // AVANCE_PASO_FIJO o AVANCE_ANALITICO
+    int control_interseccion;     // CONTROL_SEMAFORO o CONTROL_RESERVAS
+    int num_hilos;                // Threads del equipo; 0 = los que da OpenMP
 } ConfiguracionSimulacion;
 
 // Configuración por defecto
@@ -53,7 +101,12 @@ ConfiguracionSimulacion config = {
     .max_autos_por_calle = 25,
     .intervalo_entrada_vehiculos = 2.0,
     .tiempo_limite_simulacion = 0.0,
-    .ancho_interseccion = 8.0
+    .ancho_interseccion = 8.0,
+    .modo_simulacion = MODO_EVENTOS,
+    .formato_trazas = FORMATO_TRAZA_CSV,
+    .modo_avance = AVANCE_PASO_FIJO,
+    .control_interseccion = CONTROL_SEMAFORO,
+    .num_hilos = 0
 };
 
 // ============================================================================
@@ -72,15 +125,15 @@ typedef enum {
     SALIENDO
 } EstadoVehiculo;
 
-typedef struct {
+// Métricas "frías" del vehículo. La cinemática (posición, velocidad,
+// aceleración y estado) vive en el AlmacenCalle de su dirección, en el índice
+// 'indice', para que el bucle de física recorra arrays contiguos.
+typedef struct Vehiculo {
     int id;
     DireccionCalle direccion;
-    double posicion;
+    int indice;      // Posición en el AlmacenCalle (cambia al retirar vehículos)
+    int completado;  // 1 cuando salió de la calle
     int seccion;
-    double velocidad;
-    double aceleracion;
-    EstadoVehiculo estado;
-    EstadoVehiculo estado_anterior;
     
     // Métricas detalladas
     double tiempo_entrada;
@@ -100,8 +153,61 @@ typedef struct {
     int actualizaciones_count;
     double ultimo_cambio_estado;
     int thread_id;  // ID del thread que procesa este vehículo
+    
+    // Avance analítico: pasos a velocidad constante aún sin aplicar,
+    // contados desde inicio_libre
+    long long pasos_libres;
+    double inicio_libre;
+    double paso_programado;  // Origen de su próxima ACTUALIZACION_VEHICULO
+    
+    // Espera detenida: pasos acreditados desde inicio_libre al despertar
+    int espera;                        // ESPERA_*
+    int despertar_programado;          // Ya tiene su evento de despertar
+    int en_lista_espera;               // Está en vista->en_espera
+    struct Vehiculo* siguiente_espera; // Lista de espera del semáforo
+    
+    // Reserva de cruce (CONTROL_RESERVAS)
+    int con_reserva;
+    double reserva_arranque;   // Desde cuándo puede avanzar; sin reserva, cuándo reintentar
+    double reserva_fin;
+    long long ranura_inicio;   // Ranuras reservadas en la tabla, inclusive
+    long long ranura_fin;
 } Vehiculo;
 
+// Almacén SoA de una calle. Las columnas calientes son arrays contiguos
+// alineados para el kernel de integración y comparten índice con 'vehiculos'. Las
+// columnas pub_* son el buffer que leen los demás vehículos: se publican una
+// vez por paso, así las actualizaciones en paralelo leen el paso anterior
+// sin locks.
+//
+// Como no hay rebases, el orden de entrada es también el orden por posición:
+// los activos ocupan [primero, primero + num) y el líder del índice i es i-1.
+// Las salidas ocurren por la cabeza (primero++) y las entradas por la cola,
+// ambas en O(1). El almacén crece por duplicación con los vehículos activos.
+#define ALINEACION_SIMD 32
+#define CAPACIDAD_INICIAL_CALLE 64
+
+typedef struct {
+    double* posicion;
+    double* velocidad;
+    double* aceleracion;
+    int* estado;              // EstadoVehiculo
+    
+    double* pub_posicion;
+    double* pub_velocidad;
+    double* pub_aceleracion;
+    int* pub_estado;
+    
+    // Salida del kernel de integración
+    double* nueva_posicion;
+    double* nueva_velocidad;
+    
+    Vehiculo** vehiculos;     // Métricas frías, mismo índice
+    int primero;              // Índice del vehículo más adelantado
+    int num;                  // Vehículos activos
+    int capacidad;
+} AlmacenCalle;
+
 typedef struct {
     double tiempo;
     int tipo;
@@ -109,31 +215,79 @@ typedef struct {
     DireccionCalle direccion;
     Vehiculo* vehiculo;
     int prioridad;
+    double origen;            // Instante del paso que programó el evento
 } Evento;
 
-typedef struct Nodo {
+// Orden de los eventos simultáneos: primero el programado desde un instante
+// anterior y, entre los programados a la vez, el del vehículo más nuevo. No
+// depende del orden de inserción, así que un evento diferido (flujo libre,
+// espera detenida) ocupa el mismo lugar que en el paso fijo.
+static inline int comparar_eventos(const Evento* a, const Evento* b) {
+    if (a->tiempo != b->tiempo) return (a->tiempo < b->tiempo) ? -1 : 1;
+    if (a->origen != b->origen) return (a->origen < b->origen) ? -1 : 1;
+    if (a->id_auto != b->id_auto) return (a->id_auto > b->id_auto) ? -1 : 1;
+    if (a->direccion != b->direccion) return (a->direccion < b->direccion) ? -1 : 1;
+    return 0;
+}
+
+// Entrada del heap: el número de secuencia rompe los empates que deja
+// comparar_eventos (FIFO)
+typedef struct {
     Evento evento;
-    struct Nodo* siguiente;
-    struct Nodo* anterior;
-} Nodo;
+    unsigned long long secuencia;
+} EntradaHeap;
+
+// Cola de prioridad como heap 4-ario sobre un array contiguo
+#define ARIDAD_HEAP 4
+#define CAPACIDAD_INICIAL_COLA 256
 
 typedef struct {
-    Nodo* inicio;
-    Nodo* fin;
+    EntradaHeap* datos;
+    int capacidad;
     int size;
     int max_size_alcanzado;
+    unsigned long long siguiente_secuencia;
+    int asignaciones_cola; // Llamadas a malloc/realloc hechas por la cola (solo su montículo)
     omp_lock_t lock; // Lock para acceso concurrente
 } ColaEventos;
 
+// Ocupación de la intersección empaquetada en una sola palabra, que se
+// actualiza con CAS sin lock:
+//   bits  0-23  vehículos NS cruzando
+//   bits 24-47  vehículos EO cruzando
+//   bit  48     dirección que ocupa el cruce (se conserva al vaciarse)
+typedef unsigned long long PalabraOcupacion;
+
+#define OCUPACION_BITS_CONTADOR 24
+#define OCUPACION_MASCARA_CONTADOR ((1ULL << OCUPACION_BITS_CONTADOR) - 1)
+#define OCUPACION_BIT_DIRECCION (1ULL << (2 * OCUPACION_BITS_CONTADOR))
+
+static inline int ocupacion_en(PalabraOcupacion w, DireccionCalle d) {
+    return (int)((w >> (d * OCUPACION_BITS_CONTADOR)) & OCUPACION_MASCARA_CONTADOR);
+}
+
+static inline int ocupacion_total(PalabraOcupacion w) {
+    return ocupacion_en(w, NORTE_A_SUR) + ocupacion_en(w, ESTE_A_OESTE);
+}
+
+static inline DireccionCalle ocupacion_direccion(PalabraOcupacion w) {
+    return (w & OCUPACION_BIT_DIRECCION) ? ESTE_A_OESTE : NORTE_A_SUR;
+}
+
+// La dirección pasa a la única calle con vehículos dentro; si hay de las
+// dos o de ninguna se mantiene la anterior
+static inline PalabraOcupacion ocupacion_derivar(PalabraOcupacion w) {
+    int en_ns = ocupacion_en(w, NORTE_A_SUR);
+    int en_eo = ocupacion_en(w, ESTE_A_OESTE);
+    
+    if (en_ns > 0 && en_eo == 0) return w & ~OCUPACION_BIT_DIRECCION;
+    if (en_eo > 0 && en_ns == 0) return w | OCUPACION_BIT_DIRECCION;
+    return w;
+}
+
 // Sistema escalable con arrays dinámicos para ambas calles
 typedef struct {
-    Vehiculo** vehiculos_norte_sur;
-    Vehiculo** vehiculos_este_oeste;
-    int num_vehiculos_ns;
-    int num_vehiculos_eo;
-    int capacidad_vehiculos_ns;
-    int capacidad_vehiculos_eo;
-    double tiempo_actual;
+    AlmacenCalle calles[2];  // Indexado por DireccionCalle
     
     // Estadísticas del sistema por calle
     int total_vehiculos_creados_ns;
@@ -143,15 +297,16 @@ typedef struct {
     double tiempo_promedio_recorrido_ns;
     double tiempo_promedio_recorrido_eo;
     
-    // Control de intersección
-    int vehiculos_en_interseccion;
-    DireccionCalle direccion_actual_cruzando;
+    // Control de intersección (la ocupación vigente está en la vista)
     double ultimo_cambio_interseccion;
     
+    // Ocupación que leen los vehículos al pedir paso en MODO_TICK; se
+    // publica una vez al final de cada paso
+    PalabraOcupacion ocupacion_publicada;
+    
     // Control de memoria y paralelismo
     size_t memoria_utilizada;
     omp_lock_t lock_sistema;
-    omp_lock_t lock_interseccion;
 } SistemaInterseccion;
 
 typedef struct {
@@ -168,14 +323,36 @@ typedef struct {
 
 typedef struct {
     double ultimo_cambio;
-    EstadoInterseccion estado;
     double duracion_ns_verde;
     double duracion_eo_verde;
     double duracion_transicion;
     int ciclos_completados;
-    omp_lock_t lock; // Lock para el semáforo
+    double proximo_cambio; // Instante del siguiente SEMAFORO_CAMBIO
+    EstadoInterseccion verde_anterior; // Decide qué verde sigue a la transición
 } ControlInterseccion;
 
+// Lo que ve del resto de la simulación quien procesa un evento: el instante
+// y la clave del evento en curso, la fase del semáforo, la ocupación de la
+// caja y la lista de espera de la zona de paso, junto con sus contadores. En
+// MODO_EVENTOS y MODO_TICK todos los threads comparten vista_global; en
+// MODO_CONSERVADOR y MODO_OPTIMISTA cada proceso lógico tiene la suya (ver
+// PROCESOS LÓGICOS y TIME WARP).
+struct CanalMensajes;
+struct EstadoOptimista;
+
+typedef struct {
+    double tiempo_actual;
+    Evento evento_en_curso;       // Los pasos diferidos que lo preceden ya ocurrieron
+    EstadoInterseccion fase;
+    PalabraOcupacion ocupacion;   // Vigente, la modifican entrar/salir con CAS
+    Vehiculo* en_espera;          // Vehículos detenidos en la zona de paso
+    struct CanalMensajes* salida; // Cambios de ocupación propios hacia la caja (o la otra calle)
+    struct EstadoOptimista* especulativo; // MODO_OPTIMISTA: salidas retenidas hasta el GVT
+    long long actualizaciones;    // Pasos de física aplicados a vehículos
+    long long pasos_analiticos;   // Pasos aplicados sin evento
+    long long pasos_detenidos;    // Pasos detenidos acreditados sin evento
+} VistaSimulacion;
+
 // ============================================================================
 // VARIABLES GLOBALES MEJORADAS CON LOCKS
 // ============================================================================
@@ -195,197 +372,984 @@ ParametrosSimulacion params = {
 
 ControlInterseccion semaforo = {
     .ultimo_cambio = 0.0,
-    .estado = NORTE_SUR_VERDE,
     .duracion_ns_verde = 30.0,
     .duracion_eo_verde = 25.0,
     .duracion_transicion = 3.0,
     .ciclos_completados = 0
 };
 
+VistaSimulacion vista_global = {0};
+VistaSimulacion* vista = &vista_global;
+#pragma omp threadprivate(vista)
+
+// Los cambios de fase son eventos SEMAFORO_CAMBIO programados de antemano.
+// Solo el thread del bucle de eventos escribe la fase, al procesarlos, y
+// nunca mientras el equipo procesa un lote de vehículos: la fase publicada
+// es un valor fijo durante cada evento y se lee sin lock.
+
+static inline EstadoInterseccion fase_semaforo() {
+    EstadoInterseccion fase;
+    #pragma omp atomic read
+    fase = vista->fase;
+    return fase;
+}
+
 // Variables globales para estadísticas thread-safe
-int eventos_procesados = 0;
+long long eventos_procesados = 0;
 omp_lock_t lock_eventos;
 
+// ============================================================================
+// GESTOR DE RESERVAS DE LA INTERSECCIÓN
+// ============================================================================
+//
+// Con CONTROL_RESERVAS no hay semáforo: al entrar en la zona de aproximación
+// cada vehículo pide una vez paso y recibe el instante desde el que puede
+// avanzar. La tabla es un anillo de ranuras de tiempo con, por ranura,
+// cuántos vehículos de cada dirección reservaron la zona de conflicto. Las
+// dos calles tienen un carril y se cruzan una sola vez, así que la caja es la
+// única zona y dos direcciones chocan si son distintas.
+//
+// Lo reservado es el intervalo en que el vehículo puede estar en la caja:
+// hasta su arranque frena con la desaceleración máxima y después acelera
+// entre la aceleración de dentro de la caja y la máxima. Un seguidor no
+// arranca antes que su líder ni deja la caja antes que él. Una solicitud
+// recorre su intervalo hacia atrás y, ante un choque, retrasa el arranque lo
+// justo para pasarlo: el coste es del orden del intervalo, no del número de
+// vehículos. Al salir de la caja se liberan las ranuras que no llegó a usar.
+//
+// Las solicitudes solo las hace el thread del bucle de eventos (en MODO_TICK,
+// antes del paso paralelo y en orden de calle e índice); las liberaciones
+// pueden ir en paralelo y restan con atomics.
+
+#define ANCHO_RANURA_RESERVA 0.1   // Segundos por ranura
+#define NUM_RANURAS_RESERVA 4096   // Horizonte de la tabla (potencia de 2)
+#define DISTANCIA_APROXIMACION 10.0  // Zona de aproximación con semáforo
+
+static const int conflicto_direcciones[2][2] = {
+    {0, 1},  // NS choca con EO
+    {1, 0}   // EO choca con NS
+};
+
+typedef struct {
+    long long ranura;   // Ranura absoluta que representa la entrada
+    int reservas[2];    // Vehículos por dirección con la caja reservada
+} RanuraReserva;
+
+typedef struct {
+    RanuraReserva* tabla;
+    double distancia_aproximacion;  // Cabe la frenada desde velocidad máxima
+    double intervalo_seguimiento;   // Lo que un seguidor alarga la ventana de su líder
+    long long concedidas;
+    long long sin_espera;
+    long long sin_hueco;            // Solicitudes sin ventana dentro del horizonte
+    double espera_total;
+} GestorReservas;
+
+GestorReservas gestor = {0};
+
+// Distancia antes de la caja desde la que el vehículo atiende al control.
+// Con reservas debe poder frenar antes de la caja si aún no tiene permiso.
+static inline double distancia_aproximacion() {
+    if (config.control_interseccion == CONTROL_RESERVAS) return gestor.distancia_aproximacion;
+    return DISTANCIA_APROXIMACION;
+}
+
+int inicializar_gestor_reservas() {
+    gestor.tabla = (RanuraReserva*)malloc(NUM_RANURAS_RESERVA * sizeof(RanuraReserva));
+    if (!gestor.tabla) return 0;
+    for (int k = 0; k < NUM_RANURAS_RESERVA; k++) {
+        gestor.tabla[k].ranura = -1;
+        gestor.tabla[k].reservas[0] = gestor.tabla[k].reservas[1] = 0;
+    }
+    
+    double v = params.velocidad_maxima;
+    double frenada = v * v / (2.0 * fabs(params.desaceleracion_maxima));
+    gestor.distancia_aproximacion = fmax(DISTANCIA_APROXIMACION, frenada + 2.0 * v * config.paso_simulacion);
+    
+    double hueco = params.longitud_vehiculo + params.distancia_seguridad_min;
+    gestor.intervalo_seguimiento = sqrt(2.0 * hueco / (params.aceleracion_maxima * 0.6));
+    return 1;
+}
+
+void liberar_gestor_reservas() {
+    free(gestor.tabla);
+    gestor.tabla = NULL;
+}
+
+// Tiempo para recorrer 'distancia' desde 'v0' con aceleración 'a' hasta la
+// velocidad máxima
+double tiempo_de_recorrido(double v0, double distancia, double a) {
+    double vmax = params.velocidad_maxima;
+    if (distancia <= 0.0) return 0.0;
+    if (v0 >= vmax) return distancia / vmax;
+    
+    double t_acelerando = (vmax - v0) / a;
+    double d_acelerando = (v0 + vmax) / 2.0 * t_acelerando;
+    if (distancia <= d_acelerando) return (sqrt(v0 * v0 + 2.0 * a * distancia) - v0) / a;
+    return t_acelerando + (distancia - d_acelerando) / vmax;
+}
+
+// Entrada de la ranura absoluta k; las de vueltas anteriores del anillo se
+// reinician. Solo desde el bucle de eventos.
+static inline RanuraReserva* ranura_reserva(long long k) {
+    RanuraReserva* r = &gestor.tabla[k & (NUM_RANURAS_RESERVA - 1)];
+    if (r->ranura != k) {
+        r->ranura = k;
+        r->reservas[0] = r->reservas[1] = 0;
+    }
+    return r;
+}
+
+static inline int ranura_en_conflicto(long long k, DireccionCalle direccion) {
+    RanuraReserva* r = ranura_reserva(k);
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        if (conflicto_direcciones[direccion][d] && r->reservas[d] > 0) return 1;
+    }
+    return 0;
+}
+
+// Reserva para el vehículo i el primer arranque desde 'reloj' cuyo paso por
+// la caja no choca con otra dirección. Si no cabe en el horizonte deja
+// anotado cuándo reintentar.
+void solicitar_reserva(AlmacenCalle* c, int i, double reloj) {
+    Vehiculo* v = c->vehiculos[i];
+    double w = ANCHO_RANURA_RESERVA;
+    double margen = 2.0 * config.paso_simulacion;  // Holgura por la integración discreta
+    double a_min = params.aceleracion_maxima * 0.6;
+    double a_max = params.aceleracion_maxima;
+    double frenado = fabs(params.desaceleracion_maxima);
+    
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    double hasta_caja = inicio_interseccion - c->posicion[i];
+    double hasta_dejarla = hasta_caja + config.ancho_interseccion + params.longitud_vehiculo;
+    double v0 = c->velocidad[i];
+    
+    double arranque = reloj;
+    double fin_min = 0.0;
+    if (i > c->primero && c->vehiculos[i - 1]->con_reserva) {
+        Vehiculo* lider = c->vehiculos[i - 1];
+        arranque = fmax(arranque, lider->reserva_arranque);
+        fin_min = lider->reserva_fin + gestor.intervalo_seguimiento;
+    }
+    
+    long long actual = (long long)floor(reloj / w);
+    
+    for (;;) {
+        // Frenada hasta el arranque y cotas de entrada y salida desde ahí
+        double espera = arranque - reloj;
+        double v1 = v0 - frenado * espera;
+        double s1 = (v1 > 0.0) ? (v0 + v1) / 2.0 * espera : v0 * v0 / (2.0 * frenado);
+        if (v1 < 0.0) v1 = 0.0;
+        
+        double entrada = arranque + tiempo_de_recorrido(v1, hasta_caja - s1, a_max) - margen;
+        double fin = arranque + tiempo_de_recorrido(v1, hasta_dejarla - s1, a_min) + margen;
+        if (fin < fin_min) fin = fin_min;
+        
+        long long k0 = (long long)floor(fmax(entrada, reloj) / w);
+        long long k1 = (long long)floor(fin / w);
+        if (k1 - actual >= NUM_RANURAS_RESERVA) {
+            gestor.sin_hueco++;
+            v->reserva_arranque = reloj + tiempo_de_recorrido(0.0, hasta_dejarla, a_min);
+            return;
+        }
+        
+        long long k = k1;
+        while (k >= k0 && !ranura_en_conflicto(k, v->direccion)) k--;
+        
+        if (k < k0) {
+            for (k = k0; k <= k1; k++) ranura_reserva(k)->reservas[v->direccion]++;
+            v->con_reserva = 1;
+            v->reserva_arranque = arranque;
+            v->reserva_fin = fin;
+            v->ranura_inicio = k0;
+            v->ranura_fin = k1;
+            
+            gestor.concedidas++;
+            if (arranque <= reloj) gestor.sin_espera++;
+            gestor.espera_total += arranque - reloj;
+            return;
+        }
+        
+        // Retrasar el arranque hasta que la entrada quede detrás del choque;
+        // la entrada crece menos que el arranque mientras aún frena, así que
+        // se avanza al menos una ranura
+        arranque += fmax(w, (k + 1) * w - entrada);
+    }
+}
+
+// Libera las ranuras de la reserva posteriores a 'reloj'. Puede llamarse
+// desde el paso paralelo.
+void liberar_reserva(Vehiculo* v, double reloj) {
+    if (!v->con_reserva) return;
+    
+    long long desde = (long long)floor(reloj / ANCHO_RANURA_RESERVA) + 1;
+    if (desde < v->ranura_inicio) desde = v->ranura_inicio;
+    for (long long k = desde; k <= v->ranura_fin; k++) {
+        RanuraReserva* r = &gestor.tabla[k & (NUM_RANURAS_RESERVA - 1)];
+        if (r->ranura == k) {
+            #pragma omp atomic
+            r->reservas[v->direccion]--;
+        }
+    }
+    v->con_reserva = 0;
+}
+
+// El vehículo tiene su ventana y ya puede avanzar hacia la caja
+static inline int permiso_reserva(const Vehiculo* v, double reloj) {
+    return v->con_reserva && reloj >= v->reserva_arranque;
+}
+
+// ============================================================================
+// POOL DE VEHÍCULOS Y RESUMEN DE COMPLETADOS
+// ============================================================================
+//
+// Los vehículos se reservan por bloques y vuelven a una lista libre al salir
+// de su calle: la memoria sigue al máximo de vehículos activos y no al total
+// de la corrida. Al salir, cada vehículo deja su fila de DATOS_VEHICULOS en
+// el archivo temporal de su dirección y agrega sus tiempos a las estadísticas
+// en flujo de esa dirección. Obtener, emitir y devolver se hace desde el
+// thread del bucle de eventos o, en MODO_CONSERVADOR, desde el de cada calle:
+// el pool lleva su lock y cada calle emite solo en su dirección. En
+// MODO_OPTIMISTA emitir y devolver esperan al GVT (ver TIME WARP).
+
+#define VEHICULOS_POR_BLOQUE 256
+
+typedef struct BloqueVehiculos {
+    struct BloqueVehiculos* siguiente;
+    Vehiculo vehiculos[VEHICULOS_POR_BLOQUE];
+} BloqueVehiculos;
+
+typedef struct {
+    BloqueVehiculos* bloques;
+    Vehiculo* libres;  // Enlazados por siguiente_espera
+    int en_uso;
+    int max_en_uso;
+    int num_bloques;
+    omp_lock_t lock;
+} PoolVehiculos;
+
+// Vehículos completados de una dirección
+typedef struct {
+    FILE* filas;  // Filas CSV en orden de salida
+    char ruta_filas[1100];  // Vacía si 'filas' viene de tmpfile()
+    int completados;
+    EstadisticaFlujo recorrido;
+    EstadisticaFlujo detenido;
+    EstadisticaFlujo espera;     // Sin permiso de paso ante la intersección
+    EstadisticaFlujo cruce;
+    EstadisticaFlujo velocidad;  // Longitud de la calle / tiempo de recorrido
+} SumideroResumenes;
+
+PoolVehiculos pool = {0};
+SumideroResumenes resumenes[2] = {{0}};
+
+// Devuelve un vehículo en cero, reutilizando uno liberado si lo hay
+Vehiculo* obtener_vehiculo() {
+    omp_set_lock(&pool.lock);
+    if (!pool.libres) {
+        BloqueVehiculos* bloque = (BloqueVehiculos*)malloc(sizeof(BloqueVehiculos));
+        if (!bloque) {
+            omp_unset_lock(&pool.lock);
+            return NULL;
+        }
+        bloque->siguiente = pool.bloques;
+        pool.bloques = bloque;
+        pool.num_bloques++;
+        for (int i = VEHICULOS_POR_BLOQUE - 1; i >= 0; i--) {
+            bloque->vehiculos[i].siguiente_espera = pool.libres;
+            pool.libres = &bloque->vehiculos[i];
+        }
+        #pragma omp atomic
+        interseccion.memoria_utilizada += sizeof(BloqueVehiculos);
+    }
+    Vehiculo* v = pool.libres;
+    pool.libres = v->siguiente_espera;
+    if (++pool.en_uso > pool.max_en_uso) pool.max_en_uso = pool.en_uso;
+    omp_unset_lock(&pool.lock);
+    
+    memset(v, 0, sizeof(Vehiculo));
+    return v;
+}
+
+// Un despertar por su líder deja al vehículo en la lista del semáforo hasta
+// el siguiente cambio de fase: al salir se desengancha
+void desenganchar_espera(Vehiculo* v) {
+    if (v->en_lista_espera) {
+        Vehiculo** pos = &vista->en_espera;
+        while (*pos && *pos != v) pos = &(*pos)->siguiente_espera;
+        if (*pos) *pos = v->siguiente_espera;
+        v->en_lista_espera = 0;
+    }
+}
+
+// Devuelve al pool un vehículo que ya salió y no tiene eventos pendientes
+void devolver_vehiculo(Vehiculo* v) {
+    desenganchar_espera(v);
+    omp_set_lock(&pool.lock);
+    v->siguiente_espera = pool.libres;
+    pool.libres = v;
+    pool.en_uso--;
+    omp_unset_lock(&pool.lock);
+}
+
+void liberar_pool_vehiculos() {
+    while (pool.bloques) {
+        BloqueVehiculos* siguiente = pool.bloques->siguiente;
+        free(pool.bloques);
+        pool.bloques = siguiente;
+    }
+    pool.libres = NULL;
+    pool.en_uso = 0;
+}
+
+// Sin tmpfile() (en Windows suele fallar por permisos en la raíz del disco) las
+// filas van a un archivo propio junto a los resultados, que se borra al cerrar.
+// Si tampoco se puede crear, no se corre: el CSV quedaría sin filas por vehículo
+void abrir_filas_propias(SumideroResumenes* s, int direccion) {
+    char dir_path[1024];
+    strncpy(dir_path, __FILE__, sizeof(dir_path) - 1);
+    dir_path[sizeof(dir_path) - 1] = '\0';
+    char *last_sep = strrchr(dir_path, '\\');
+    if (!last_sep) last_sep = strrchr(dir_path, '/');
+    if (last_sep) {
+        *last_sep = '\0';
+    } else {
+        strcpy(dir_path, ".");
+    }
+    
+    char timestamp[64];
+    time_t ahora = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", localtime(&ahora));
+    snprintf(s->ruta_filas, sizeof(s->ruta_filas), "%s/filas_%s_%s.tmp", dir_path,
+             (direccion == NORTE_A_SUR) ? "ns" : "eo", timestamp);
+    s->filas = fopen(s->ruta_filas, "w+b");
+    if (!s->filas) {
+        fprintf(stderr, "ERROR: Sin archivo temporal ni %s para las filas por vehículo\n", s->ruta_filas);
+        exit(1);
+    }
+}
+
+void inicializar_resumenes() {
+    for (int d = 0; d < 2; d++) {
+        memset(&resumenes[d], 0, sizeof(SumideroResumenes));
+        estadistica_iniciar(&resumenes[d].recorrido);
+        estadistica_iniciar(&resumenes[d].detenido);
+        estadistica_iniciar(&resumenes[d].espera);
+        estadistica_iniciar(&resumenes[d].cruce);
+        estadistica_iniciar(&resumenes[d].velocidad);
+        resumenes[d].filas = tmpfile();
+        if (!resumenes[d].filas) abrir_filas_propias(&resumenes[d], d);
+    }
+}
+
+// Registra un vehículo que acaba de salir de su calle
+void emitir_resumen(Vehiculo* v) {
+    SumideroResumenes* s = &resumenes[v->direccion];
+    double longitud_calle = (v->direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
+    double tiempo_recorrido = v->tiempo_salida - v->tiempo_entrada;
+    
+    estadistica_agregar(&s->recorrido, tiempo_recorrido);
+    estadistica_agregar(&s->detenido, v->tiempo_total_detenido);
+    estadistica_agregar(&s->espera, v->tiempo_esperando_interseccion);
+    estadistica_agregar(&s->cruce, v->tiempo_cruzando);
+    estadistica_agregar(&s->velocidad, (tiempo_recorrido > 0) ? longitud_calle / tiempo_recorrido : 0.0);
+    s->completados++;
+    
+    if (s->filas) {
+        fprintf(s->filas, "%d,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                v->id, (v->direccion == NORTE_A_SUR) ? "NS" : "EO",
+                v->tiempo_entrada, v->tiempo_llegada_interseccion,
+                v->tiempo_salida, v->tiempo_esperando_interseccion,
+                v->tiempo_cruzando, v->velocidad_promedio);
+    }
+}
+
+// Copia las filas acumuladas de una dirección al CSV de resultados
+void volcar_resumenes(SumideroResumenes* s, FILE* csv) {
+    if (!s->filas) return;
+    char buffer[4096];
+    size_t leidos;
+    rewind(s->filas);
+    while ((leidos = fread(buffer, 1, sizeof(buffer), s->filas)) > 0) {
+        fwrite(buffer, 1, leidos, csv);
+    }
+}
+
+void cerrar_resumenes() {
+    for (int d = 0; d < 2; d++) {
+        if (resumenes[d].filas) fclose(resumenes[d].filas);
+        if (resumenes[d].ruta_filas[0]) remove(resumenes[d].ruta_filas);
+        resumenes[d].filas = NULL;
+        resumenes[d].ruta_filas[0] = '\0';
+    }
+}
+
 // ============================================================================
 // FUNCIONES DE GESTIÓN DE MEMORIA Y PARALELISMO
 // ============================================================================
 
 void inicializar_locks() {
     omp_init_lock(&interseccion.lock_sistema);
-    omp_init_lock(&interseccion.lock_interseccion);
-    omp_init_lock(&semaforo.lock);
     omp_init_lock(&lock_eventos);
+    omp_init_lock(&pool.lock);
 }
 
 void destruir_locks() {
     omp_destroy_lock(&interseccion.lock_sistema);
-    omp_destroy_lock(&interseccion.lock_interseccion);
-    omp_destroy_lock(&semaforo.lock);
     omp_destroy_lock(&lock_eventos);
+    omp_destroy_lock(&pool.lock);
+}
+
+void* asignar_alineado(size_t bytes) {
+    // Redondear a múltiplo de la alineación (requisito de aligned_alloc)
+    bytes = (bytes + ALINEACION_SIMD - 1) / ALINEACION_SIMD * ALINEACION_SIMD;
+#ifdef _WIN32
+    return _aligned_malloc(bytes, ALINEACION_SIMD);
+#else
+    return aligned_alloc(ALINEACION_SIMD, bytes);
+#endif
+}
+
+void liberar_alineado(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+int inicializar_almacen_calle(AlmacenCalle* c, int capacidad) {
+    size_t bytes_double = capacidad * sizeof(double);
+    size_t bytes_int = capacidad * sizeof(int);
+    
+    c->posicion = (double*)asignar_alineado(bytes_double);
+    c->velocidad = (double*)asignar_alineado(bytes_double);
+    c->aceleracion = (double*)asignar_alineado(bytes_double);
+    c->estado = (int*)asignar_alineado(bytes_int);
+    c->pub_posicion = (double*)asignar_alineado(bytes_double);
+    c->pub_velocidad = (double*)asignar_alineado(bytes_double);
+    c->pub_aceleracion = (double*)asignar_alineado(bytes_double);
+    c->pub_estado = (int*)asignar_alineado(bytes_int);
+    c->nueva_posicion = (double*)asignar_alineado(bytes_double);
+    c->nueva_velocidad = (double*)asignar_alineado(bytes_double);
+    c->vehiculos = (Vehiculo**)calloc(capacidad, sizeof(Vehiculo*));
+    c->primero = 0;
+    c->num = 0;
+    c->capacidad = capacidad;
+    
+    return c->posicion && c->velocidad && c->aceleracion && c->estado &&
+           c->pub_posicion && c->pub_velocidad && c->pub_aceleracion && c->pub_estado &&
+           c->nueva_posicion && c->nueva_velocidad && c->vehiculos;
+}
+
+void liberar_almacen_calle(AlmacenCalle* c) {
+    liberar_alineado(c->posicion);
+    liberar_alineado(c->velocidad);
+    liberar_alineado(c->aceleracion);
+    liberar_alineado(c->estado);
+    liberar_alineado(c->pub_posicion);
+    liberar_alineado(c->pub_velocidad);
+    liberar_alineado(c->pub_aceleracion);
+    liberar_alineado(c->pub_estado);
+    liberar_alineado(c->nueva_posicion);
+    liberar_alineado(c->nueva_velocidad);
+    free(c->vehiculos);
+    memset(c, 0, sizeof(*c));
+}
+
+size_t memoria_almacen_calle(const AlmacenCalle* c) {
+    return c->capacidad * (8 * sizeof(double) + 2 * sizeof(int) + sizeof(Vehiculo*));
 }
 
 void inicializar_sistema() {
-    interseccion.capacidad_vehiculos_ns = config.max_autos_por_calle + 10;
-    interseccion.capacidad_vehiculos_eo = config.max_autos_por_calle + 10;
+    int capacidad = CAPACIDAD_INICIAL_CALLE;
     
-    interseccion.vehiculos_norte_sur = (Vehiculo**)calloc(interseccion.capacidad_vehiculos_ns, sizeof(Vehiculo*));
-    interseccion.vehiculos_este_oeste = (Vehiculo**)calloc(interseccion.capacidad_vehiculos_eo, sizeof(Vehiculo*));
-    
-    if (!interseccion.vehiculos_norte_sur || !interseccion.vehiculos_este_oeste) {
+    if (!inicializar_almacen_calle(&interseccion.calles[NORTE_A_SUR], capacidad) ||
+        !inicializar_almacen_calle(&interseccion.calles[ESTE_A_OESTE], capacidad)) {
         fprintf(stderr, "ERROR: No se pudo asignar memoria para vehículos\n");
         exit(1);
     }
     
     interseccion.memoria_utilizada = sizeof(SistemaInterseccion) + 
-                                    (interseccion.capacidad_vehiculos_ns + interseccion.capacidad_vehiculos_eo) * sizeof(Vehiculo*);
+                                    memoria_almacen_calle(&interseccion.calles[NORTE_A_SUR]) +
+                                    memoria_almacen_calle(&interseccion.calles[ESTE_A_OESTE]);
     
     inicializar_locks();
     
+    if (config.control_interseccion == CONTROL_RESERVAS && !inicializar_gestor_reservas()) {
+        fprintf(stderr, "ERROR: No se pudo asignar memoria para la tabla de reservas\n");
+        exit(1);
+    }
+    
     printf("Sistema de intersección inicializado:\n");
-    printf("- Capacidad Norte-Sur: %d vehículos\n", interseccion.capacidad_vehiculos_ns);
-    printf("- Capacidad Este-Oeste: %d vehículos\n", interseccion.capacidad_vehiculos_eo);
+    printf("- Capacidad Norte-Sur: %d vehículos\n", interseccion.calles[NORTE_A_SUR].capacidad);
+    printf("- Capacidad Este-Oeste: %d vehículos\n", interseccion.calles[ESTE_A_OESTE].capacidad);
     printf("- Memoria: %zu bytes\n", interseccion.memoria_utilizada);
     printf("- Threads disponibles: %d\n", omp_get_max_threads());
 }
 
 void limpiar_sistema() {
     destruir_locks();
+    liberar_gestor_reservas();
     
-    if (interseccion.vehiculos_norte_sur) {
-        free(interseccion.vehiculos_norte_sur);
-        interseccion.vehiculos_norte_sur = NULL;
-    }
-    if (interseccion.vehiculos_este_oeste) {
-        free(interseccion.vehiculos_este_oeste);
-        interseccion.vehiculos_este_oeste = NULL;
-    }
+    liberar_almacen_calle(&interseccion.calles[NORTE_A_SUR]);
+    liberar_almacen_calle(&interseccion.calles[ESTE_A_OESTE]);
     printf("Sistema de intersección limpiado.\n");
 }
 
-// ============================================================================
-// FUNCIONES DE CONTROL DE TRÁFICO PARA INTERSECCIÓN
-// ============================================================================
+// Mueve los vehículos activos al inicio de las columnas cuando la cola llega
+// al final del almacén (coste amortizado O(1) por entrada)
+void compactar_almacen_calle(AlmacenCalle* c) {
+    if (c->primero == 0) return;
+    
+    int p = c->primero, n = c->num;
+    memmove(c->posicion, &c->posicion[p], n * sizeof(double));
+    memmove(c->velocidad, &c->velocidad[p], n * sizeof(double));
+    memmove(c->aceleracion, &c->aceleracion[p], n * sizeof(double));
+    memmove(c->estado, &c->estado[p], n * sizeof(int));
+    memmove(c->pub_posicion, &c->pub_posicion[p], n * sizeof(double));
+    memmove(c->pub_velocidad, &c->pub_velocidad[p], n * sizeof(double));
+    memmove(c->pub_aceleracion, &c->pub_aceleracion[p], n * sizeof(double));
+    memmove(c->pub_estado, &c->pub_estado[p], n * sizeof(int));
+    memmove(c->vehiculos, &c->vehiculos[p], n * sizeof(Vehiculo*));
+    
+    for (int k = 0; k < n; k++) {
+        c->vehiculos[k]->indice = k;
+    }
+    for (int k = n; k < p + n; k++) {
+        c->vehiculos[k] = NULL;
+    }
+    c->primero = 0;
+}
 
-Vehiculo* encontrar_vehiculo_adelante_interseccion(double posicion, DireccionCalle direccion, Vehiculo* vehiculo_actual) {
-    Vehiculo* mas_cercano = NULL;
-    double distancia_minima = (direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
-    double rango_busqueda = 50.0;
+// Copia los vehículos activos al inicio de un almacén nuevo del doble de
+// capacidad. Las columnas alineadas no tienen realloc: se asignan de nuevo.
+int crecer_almacen_calle(AlmacenCalle* c) {
+    AlmacenCalle nuevo;
+    if (!inicializar_almacen_calle(&nuevo, c->capacidad * 2)) {
+        liberar_almacen_calle(&nuevo);
+        return 0;
+    }
     
-    Vehiculo** vehiculos_calle;
-    int num_vehiculos;
+    int p = c->primero, n = c->num;
+    memcpy(nuevo.posicion, &c->posicion[p], n * sizeof(double));
+    memcpy(nuevo.velocidad, &c->velocidad[p], n * sizeof(double));
+    memcpy(nuevo.aceleracion, &c->aceleracion[p], n * sizeof(double));
+    memcpy(nuevo.estado, &c->estado[p], n * sizeof(int));
+    memcpy(nuevo.pub_posicion, &c->pub_posicion[p], n * sizeof(double));
+    memcpy(nuevo.pub_velocidad, &c->pub_velocidad[p], n * sizeof(double));
+    memcpy(nuevo.pub_aceleracion, &c->pub_aceleracion[p], n * sizeof(double));
+    memcpy(nuevo.pub_estado, &c->pub_estado[p], n * sizeof(int));
+    memcpy(nuevo.vehiculos, &c->vehiculos[p], n * sizeof(Vehiculo*));
+    nuevo.num = n;
+    for (int k = 0; k < n; k++) {
+        nuevo.vehiculos[k]->indice = k;
+    }
     
-    if (direccion == NORTE_A_SUR) {
-        vehiculos_calle = interseccion.vehiculos_norte_sur;
-        num_vehiculos = interseccion.num_vehiculos_ns;
+    #pragma omp atomic
+    interseccion.memoria_utilizada += memoria_almacen_calle(&nuevo) - memoria_almacen_calle(c);
+    liberar_almacen_calle(c);
+    *c = nuevo;
+    return 1;
+}
+
+// Deja sitio al final de la calle para una entrada. Si los activos ocupan
+// más de la mitad del almacén se duplica; si no, basta compactar. Así las
+// calles solo dependen de cuántos vehículos hay a la vez, no del total.
+int redimensionar_sistema_si_necesario(AlmacenCalle* c) {
+    if (c->primero + c->num < c->capacidad) return 1;
+    
+    if (c->num > c->capacidad / 2) {
+        if (!crecer_almacen_calle(c)) {
+            fprintf(stderr, "ERROR: No se pudo redimensionar la calle a %d vehículos\n", c->capacidad * 2);
+            return 0;
+        }
+        printf("Calle %s redimensionada a capacidad: %d vehículos\n",
+               (c == &interseccion.calles[NORTE_A_SUR]) ? "NS" : "EO", c->capacidad);
     } else {
-        vehiculos_calle = interseccion.vehiculos_este_oeste;
-        num_vehiculos = interseccion.num_vehiculos_eo;
+        compactar_almacen_calle(c);
+    }
+    return 1;
+}
+
+// Añade un vehículo recién creado al final de su calle y publica su estado.
+// Requiere redimensionar_sistema_si_necesario antes.
+void agregar_vehiculo_calle(AlmacenCalle* c, Vehiculo* v) {
+    int i = c->primero + c->num++;
+    
+    c->vehiculos[i] = v;
+    c->posicion[i] = 0.0;
+    c->velocidad[i] = 0.0;
+    c->aceleracion[i] = params.aceleracion_maxima;
+    c->estado[i] = ENTRANDO;
+    
+    c->pub_posicion[i] = c->posicion[i];
+    c->pub_velocidad[i] = c->velocidad[i];
+    c->pub_aceleracion[i] = c->aceleracion[i];
+    c->pub_estado[i] = c->estado[i];
+    
+    v->indice = i;
+}
+
+// Quita el vehículo del índice i. El caso normal es la cabeza (O(1)); si
+// saliera otro, se desplazan los siguientes para conservar el orden.
+void quitar_vehiculo_calle(AlmacenCalle* c, int i) {
+    if (i == c->primero) {
+        c->vehiculos[i] = NULL;
+        c->primero++;
+        c->num--;
+        if (c->num == 0) c->primero = 0;
+        return;
     }
     
-    for (int i = 0; i < num_vehiculos; i++) {
-        Vehiculo* v = vehiculos_calle[i];
-        
-        if (v == vehiculo_actual || !v || v->direccion != direccion) continue;
+    int fin = c->primero + c->num;
+    int mover = fin - i - 1;
+    
+    if (mover > 0) {
+        memmove(&c->posicion[i], &c->posicion[i + 1], mover * sizeof(double));
+        memmove(&c->velocidad[i], &c->velocidad[i + 1], mover * sizeof(double));
+        memmove(&c->aceleracion[i], &c->aceleracion[i + 1], mover * sizeof(double));
+        memmove(&c->estado[i], &c->estado[i + 1], mover * sizeof(int));
+        memmove(&c->pub_posicion[i], &c->pub_posicion[i + 1], mover * sizeof(double));
+        memmove(&c->pub_velocidad[i], &c->pub_velocidad[i + 1], mover * sizeof(double));
+        memmove(&c->pub_aceleracion[i], &c->pub_aceleracion[i + 1], mover * sizeof(double));
+        memmove(&c->pub_estado[i], &c->pub_estado[i + 1], mover * sizeof(int));
+        memmove(&c->vehiculos[i], &c->vehiculos[i + 1], mover * sizeof(Vehiculo*));
         
-        double diferencia_pos = v->posicion - posicion;
-        if (diferencia_pos > 0 && diferencia_pos <= rango_busqueda) {
-            if (diferencia_pos < distancia_minima) {
-                distancia_minima = diferencia_pos;
-                mas_cercano = v;
-            }
+        for (int k = i; k < fin - 1; k++) {
+            c->vehiculos[k]->indice = k;
+        }
+    }
+    
+    c->num--;
+    c->vehiculos[fin - 1] = NULL;
+}
+
+// ============================================================================
+// AVANCE ANALÍTICO EN FLUJO LIBRE
+// ============================================================================
+//
+// En MODO_EVENTOS con AVANCE_ANALITICO, un vehículo a velocidad máxima antes
+// de la zona de aproximación o después de la intersección, lejos de su
+// líder, no genera eventos mientras sus pasos sean triviales: se guarda
+// cuántos quedan y se aplican cuando otro vehículo necesita su posición o
+// cuando despierta. Posiciones e instantes se acumulan con la misma suma
+// repetida que el paso fijo; esos pasos no se escriben en la traza.
+
+#define MARGEN_AVANCE 1e-6  // Holgura para despertar un paso antes ante redondeos
+
+// Primer paso j (1 = el siguiente) que empieza en una posición >= x
+long long primer_paso_desde(double p0, double d, double x) {
+    if (x <= p0) return 1;
+    return 1 + (long long)ceil((x - p0) / d);
+}
+
+// El paso diferido del vehículo que sigue a 'anterior' ya habría ocurrido
+// antes del evento en curso
+int paso_ya_ocurrido(Vehiculo* v, double anterior) {
+    Evento paso = {anterior + config.paso_simulacion, ACTUALIZACION_VEHICULO, v->id, v->direccion, v, 0, anterior};
+    return comparar_eventos(&paso, &vista->evento_en_curso) < 0;
+}
+
+// Aplica los pasos libres del vehículo i anteriores al evento en curso y
+// publica su posición. Solo lo llama el thread del bucle de eventos.
+void sincronizar_vehiculo(AlmacenCalle* c, int i) {
+    Vehiculo* v = c->vehiculos[i];
+    if (v->pasos_libres <= 0) return;
+    
+    double dt = config.paso_simulacion;
+    double d = c->velocidad[i] * dt;
+    long long aplicados = 0;
+    
+    while (v->pasos_libres > 0 && paso_ya_ocurrido(v, v->inicio_libre)) {
+        v->inicio_libre += dt;
+        v->tiempo_en_estado += dt;
+        if (c->velocidad[i] < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
+        c->posicion[i] += d;
+        v->distancia_recorrida += d;
+        v->pasos_libres--;
+        aplicados++;
+    }
+    if (aplicados == 0) return;
+    
+    c->pub_posicion[i] = c->posicion[i];
+    vista->pasos_analiticos += aplicados;
+    
+    double tiempo_transcurrido = v->inicio_libre - v->tiempo_entrada;
+    if (tiempo_transcurrido > 0) {
+        v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
+    }
+}
+
+void sincronizar_todos() {
+    if (config.modo_avance != AVANCE_ANALITICO) return;
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        AlmacenCalle* c = &interseccion.calles[d];
+        for (int i = c->primero; i < c->primero + c->num; i++) {
+            sincronizar_vehiculo(c, i);
         }
     }
+}
+
+// Cuántos de los siguientes pasos del vehículo i (recién actualizado) son
+// triviales: velocidad constante en la zona previa a la
+// aproximación o después de la intersección, sin acercarse al líder y sin salir.
+long long calcular_pasos_libres(AlmacenCalle* c, int i) {
+    if (c->estado[i] != VELOCIDAD_CONSTANTE || c->aceleracion[i] != 0.0 ||
+        c->velocidad[i] <= 0.0 || c->velocidad[i] < params.velocidad_maxima - 0.2) {
+        return 0;
+    }
+    
+    Vehiculo* v = c->vehiculos[i];
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    double fin_interseccion = config.posicion_interseccion + config.ancho_interseccion/2;
+    double longitud_calle = (v->direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
+    double p0 = c->posicion[i];
+    double d = c->velocidad[i] * config.paso_simulacion;
+    
+    // El paso que llega al final de la calle se procesa normalmente
+    long long limite = primer_paso_desde(p0, d, longitud_calle - MARGEN_AVANCE) - 1;
+    
+    if (p0 < inicio_interseccion - distancia_aproximacion()) {
+        long long j = primer_paso_desde(p0, d, inicio_interseccion - distancia_aproximacion() - MARGEN_AVANCE);
+        if (j < limite) limite = j;
+    } else if (p0 <= fin_interseccion) {
+        return 0;
+    }
+    
+    // El líder solo avanza, así que con su posición actual la cota es
+    // conservadora. El paso sigue siendo trivial mientras la distancia no
+    // baje de la que hace desacelerar antes de la aproximación ni de la del
+    // control de colisiones.
+    if (i > c->primero) {
+        sincronizar_vehiculo(c, i - 1);
+        double distancia_min = fmax(params.distancia_seguridad_min * 1.5,
+                                    params.distancia_seguridad_min * 0.8 + d);
+        double umbral = c->pub_posicion[i - 1] - params.longitud_vehiculo - distancia_min - MARGEN_AVANCE;
+        long long j = primer_paso_desde(p0, d, umbral);
+        if (j < limite) limite = j;
+    }
     
-    return mas_cercano;
+    return (limite > 1) ? limite - 1 : 0;
+}
+
+// La entrada está libre si el último en entrar (el de menor posición) ya
+// dejó espacio suficiente
+int entrada_libre_calle(AlmacenCalle* c) {
+    if (c->num == 0) return 1;
+    int ultimo = c->primero + c->num - 1;
+    sincronizar_vehiculo(c, ultimo);
+    return c->posicion[ultimo] >= params.longitud_vehiculo + params.distancia_seguridad_min;
+}
+
+// Copia el estado actual del vehículo i al buffer que leen los demás
+static inline void publicar_estado_vehiculo(AlmacenCalle* c, int i) {
+    c->pub_posicion[i] = c->posicion[i];
+    c->pub_velocidad[i] = c->velocidad[i];
+    c->pub_aceleracion[i] = c->aceleracion[i];
+    c->pub_estado[i] = c->estado[i];
+}
+
+// Intercambio de buffers de toda la calle al final de un paso
+void publicar_estado_calle(AlmacenCalle* c) {
+    int p = c->primero;
+    memcpy(&c->pub_posicion[p], &c->posicion[p], c->num * sizeof(double));
+    memcpy(&c->pub_velocidad[p], &c->velocidad[p], c->num * sizeof(double));
+    memcpy(&c->pub_aceleracion[p], &c->aceleracion[p], c->num * sizeof(double));
+    memcpy(&c->pub_estado[p], &c->estado[p], c->num * sizeof(int));
+}
+
+// ============================================================================
+// KERNEL DE INTEGRACIÓN CINEMÁTICA
+// ============================================================================
+//
+// Para i en [inicio, fin):
+//   v' = min(max(v + a*dt, 0), vmax);  v' = 0 si v' < 0.1 y a < 0
+//   x' = x + v'*dt
+// Un bucle sin llamadas sobre columnas contiguas, que el compilador puede
+// vectorizar. Una versión AVX2 escrita a mano no mejoró el tiempo medido.
+
+void integrar_cinematica(AlmacenCalle* c, int inicio, int fin, double dt) {
+    const double* pos = c->posicion;
+    const double* vel = c->velocidad;
+    const double* acel = c->aceleracion;
+    double* nueva_pos = c->nueva_posicion;
+    double* nueva_vel = c->nueva_velocidad;
+    double vmax = params.velocidad_maxima;
+    
+    for (int i = inicio; i < fin; i++) {
+        double nv = vel[i] + acel[i] * dt;
+        if (nv < 0.0) nv = 0.0;
+        if (nv > vmax) nv = vmax;
+        if (nv < 0.1 && acel[i] < 0) nv = 0.0;
+        
+        nueva_vel[i] = nv;
+        nueva_pos[i] = pos[i] + nv * dt;
+    }
 }
 
-int puede_cruzar_interseccion(Vehiculo* vehiculo) {
-    omp_set_lock(&interseccion.lock_interseccion);
+// ============================================================================
+// FUNCIONES DE CONTROL DE TRÁFICO PARA INTERSECCIÓN
+// ============================================================================
+
+// Devuelve el índice del vehículo de adelante (el que entró justo antes, por
+// el orden FIFO de la calle) si está en rango según el estado publicado, o -1
+int encontrar_vehiculo_adelante_interseccion(DireccionCalle direccion, double posicion, int indice_actual) {
+    const AlmacenCalle* c = &interseccion.calles[direccion];
+    double rango_busqueda = RANGO_BUSQUEDA_LIDER;
+    
+    if (indice_actual <= c->primero) return -1;
+    
+    int lider = indice_actual - 1;
+    double diferencia_pos = c->pub_posicion[lider] - posicion;
+    if (diferencia_pos > 0 && diferencia_pos <= rango_busqueda) {
+        return lider;
+    }
     
+    return -1;
+}
+
+// Ocupación que ve un vehículo al pedir paso: la vigente en MODO_EVENTOS y
+// la del paso anterior en MODO_TICK
+static inline PalabraOcupacion ocupacion_visible() {
+    if (config.modo_simulacion == MODO_TICK) {
+        return __atomic_load_n(&interseccion.ocupacion_publicada, __ATOMIC_ACQUIRE);
+    }
+    return __atomic_load_n(&vista->ocupacion, __ATOMIC_ACQUIRE);
+}
+
+int puede_cruzar_interseccion(DireccionCalle direccion, double posicion) {
     int puede_cruzar = 0;
     double pos_interseccion = config.posicion_interseccion;
     double inicio_interseccion = pos_interseccion - config.ancho_interseccion/2;
     double fin_interseccion = pos_interseccion + config.ancho_interseccion/2;
     
     // Verificar si el vehículo está cerca de la intersección
-    if (vehiculo->posicion >= inicio_interseccion - 5.0 && vehiculo->posicion <= inicio_interseccion) {
+    if (posicion >= inicio_interseccion - 5.0 && posicion <= inicio_interseccion) {
         // Verificar semáforo
-        omp_set_lock(&semaforo.lock);
-        EstadoInterseccion estado_semaforo = semaforo.estado;
-        omp_unset_lock(&semaforo.lock);
+        EstadoInterseccion estado_semaforo = fase_semaforo();
         
-        if ((vehiculo->direccion == NORTE_A_SUR && estado_semaforo == NORTE_SUR_VERDE) ||
-            (vehiculo->direccion == ESTE_A_OESTE && estado_semaforo == ESTE_OESTE_VERDE)) {
+        if ((direccion == NORTE_A_SUR && estado_semaforo == NORTE_SUR_VERDE) ||
+            (direccion == ESTE_A_OESTE && estado_semaforo == ESTE_OESTE_VERDE)) {
             
             // Verificar conflictos con vehículos en intersección
-            if (interseccion.vehiculos_en_interseccion == 0 || 
-                interseccion.direccion_actual_cruzando == vehiculo->direccion) {
+            PalabraOcupacion ocupacion = ocupacion_visible();
+            if (ocupacion_total(ocupacion) == 0 || 
+                ocupacion_direccion(ocupacion) == direccion) {
                 puede_cruzar = 1;
             }
         }
     }
     
-    omp_unset_lock(&interseccion.lock_interseccion);
     return puede_cruzar;
 }
 
-void entrar_interseccion(Vehiculo* vehiculo) {
-    omp_set_lock(&interseccion.lock_interseccion);
-    
-    if (interseccion.vehiculos_en_interseccion == 0) {
-        interseccion.direccion_actual_cruzando = vehiculo->direccion;
+// Permiso del vehículo i para avanzar hacia la caja según el control activo
+int tiene_paso(const AlmacenCalle* c, int i) {
+    const Vehiculo* v = c->vehiculos[i];
+    if (config.control_interseccion == CONTROL_RESERVAS) {
+        return permiso_reserva(v, vista->tiempo_actual);
     }
+    return puede_cruzar_interseccion(v->direccion, c->posicion[i]);
+}
+
+// CONTROL_RESERVAS: el vehículo i pide su ventana la primera vez que se le
+// actualiza dentro de la zona de aproximación (o al vencer su reintento)
+void actualizar_reserva(AlmacenCalle* c, int i, double reloj) {
+    Vehiculo* v = c->vehiculos[i];
+    if (config.control_interseccion != CONTROL_RESERVAS || v->con_reserva) return;
+    if (c->estado[i] == CRUZANDO_INTERSECCION || reloj < v->reserva_arranque) return;
+    
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    double posicion = c->posicion[i];
+    if (posicion >= inicio_interseccion - distancia_aproximacion() && posicion < inicio_interseccion) {
+        solicitar_reserva(c, i, reloj);
+    }
+}
+
+// Suma 'delta' vehículos de 'direccion' a la ocupación vigente con un bucle
+// CAS y devuelve la palabra resultante. En los modos por evento la dirección
+// se deriva en la misma actualización; en MODO_TICK la deriva la publicación.
+PalabraOcupacion modificar_ocupacion(DireccionCalle direccion, int delta) {
+    PalabraOcupacion actual = __atomic_load_n(&vista->ocupacion, __ATOMIC_RELAXED);
+    PalabraOcupacion nueva;
+    do {
+        nueva = actual + (PalabraOcupacion)(long long)delta * (1ULL << (direccion * OCUPACION_BITS_CONTADOR));
+        if (config.modo_simulacion != MODO_TICK) nueva = ocupacion_derivar(nueva);
+    } while (!__atomic_compare_exchange_n(&vista->ocupacion, &actual, nueva, 0,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    return nueva;
+}
+
+// Fin de un paso TICK: publica los contadores vigentes con la dirección
+// derivada desde la última publicación. Solo depende de los contadores
+// finales, no del orden en que entraron los vehículos dentro del paso.
+void publicar_ocupacion_interseccion() {
+    PalabraOcupacion vigente = __atomic_load_n(&vista->ocupacion, __ATOMIC_ACQUIRE);
+    PalabraOcupacion anterior = interseccion.ocupacion_publicada;
+    PalabraOcupacion w = (vigente & ~OCUPACION_BIT_DIRECCION) | (anterior & OCUPACION_BIT_DIRECCION);
+    __atomic_store_n(&interseccion.ocupacion_publicada, ocupacion_derivar(w), __ATOMIC_RELEASE);
+}
+
+void entrar_interseccion(AlmacenCalle* c, int i) {
+    Vehiculo* vehiculo = c->vehiculos[i];
     
-    interseccion.vehiculos_en_interseccion++;
-    vehiculo->estado = CRUZANDO_INTERSECCION;
-    vehiculo->tiempo_llegada_interseccion = interseccion.tiempo_actual;
-    
-    omp_unset_lock(&interseccion.lock_interseccion);
+    modificar_ocupacion(vehiculo->direccion, +1);
+    c->estado[i] = CRUZANDO_INTERSECCION;
+    vehiculo->tiempo_llegada_interseccion = vista->tiempo_actual;
 }
 
 void salir_interseccion(Vehiculo* vehiculo) {
-    omp_set_lock(&interseccion.lock_interseccion);
+    PalabraOcupacion ocupacion = modificar_ocupacion(vehiculo->direccion, -1);
+    vehiculo->tiempo_cruzando += vista->tiempo_actual - vehiculo->tiempo_llegada_interseccion;
+    liberar_reserva(vehiculo, vista->tiempo_actual);
     
-    interseccion.vehiculos_en_interseccion--;
-    vehiculo->tiempo_cruzando += interseccion.tiempo_actual - vehiculo->tiempo_llegada_interseccion;
-    
-    if (interseccion.vehiculos_en_interseccion == 0) {
-        interseccion.ultimo_cambio_interseccion = interseccion.tiempo_actual;
+    if (ocupacion_total(ocupacion) == 0) {
+        #pragma omp atomic write
+        interseccion.ultimo_cambio_interseccion = vista->tiempo_actual;
     }
-    
-    omp_unset_lock(&interseccion.lock_interseccion);
 }
 
 // ============================================================================
 // CONTROL DEL SEMÁFORO INTELIGENTE
 // ============================================================================
 
-void actualizar_semaforo_interseccion(double tiempo_actual) {
-    omp_set_lock(&semaforo.lock);
-    
-    double ciclo_total = semaforo.duracion_ns_verde + semaforo.duracion_eo_verde + 2 * semaforo.duracion_transicion;
-    double t_ciclo = fmod(tiempo_actual, ciclo_total);
-    
-    EstadoInterseccion estado_anterior = semaforo.estado;
-    
-    if (t_ciclo < semaforo.duracion_ns_verde) {
-        semaforo.estado = NORTE_SUR_VERDE;
-    } else if (t_ciclo < semaforo.duracion_ns_verde + semaforo.duracion_transicion) {
-        semaforo.estado = TRANSICION;
-    } else if (t_ciclo < semaforo.duracion_ns_verde + semaforo.duracion_transicion + semaforo.duracion_eo_verde) {
-        semaforo.estado = ESTE_OESTE_VERDE;
-    } else {
-        semaforo.estado = TRANSICION;
+// Fase que sigue a 'fase'; la transición posterior al verde EO cierra el ciclo
+EstadoInterseccion fase_siguiente(EstadoInterseccion fase, EstadoInterseccion verde_anterior) {
+    if (fase == TRANSICION) {
+        return (verde_anterior == NORTE_SUR_VERDE) ? ESTE_OESTE_VERDE : NORTE_SUR_VERDE;
     }
-    
-    if (estado_anterior != semaforo.estado) {
-        semaforo.ultimo_cambio = tiempo_actual;
-        if (semaforo.estado == NORTE_SUR_VERDE && estado_anterior != NORTE_SUR_VERDE) {
-            semaforo.ciclos_completados++;
-        }
-    }
-    
-    omp_unset_lock(&semaforo.lock);
+    return TRANSICION;
+}
+
+double duracion_fase(EstadoInterseccion fase) {
+    if (fase == NORTE_SUR_VERDE) return semaforo.duracion_ns_verde;
+    if (fase == ESTE_OESTE_VERDE) return semaforo.duracion_eo_verde;
+    return semaforo.duracion_transicion;
+}
+
+// Empieza el ciclo con verde NS; devuelve el instante del primer cambio
+double iniciar_semaforo() {
+    vista->fase = NORTE_SUR_VERDE;
+    semaforo.verde_anterior = NORTE_SUR_VERDE;
+    semaforo.ultimo_cambio = 0.0;
+    semaforo.proximo_cambio = semaforo.duracion_ns_verde;
+    return semaforo.proximo_cambio;
+}
+
+// Procesa un SEMAFORO_CAMBIO: publica la fase siguiente y devuelve el
+// instante del próximo cambio
+double cambiar_fase_semaforo(double reloj) {
+    EstadoInterseccion nueva = fase_siguiente(vista->fase, semaforo.verde_anterior);
+    if (nueva != TRANSICION) semaforo.verde_anterior = nueva;
+    if (nueva == NORTE_SUR_VERDE) semaforo.ciclos_completados++;
+    
+    #pragma omp atomic write
+    vista->fase = nueva;
+    
+    semaforo.ultimo_cambio = reloj;
+    semaforo.proximo_cambio = reloj + duracion_fase(nueva);
+    return semaforo.proximo_cambio;
 }
 
 // ============================================================================
@@ -394,48 +1358,59 @@ void actualizar_semaforo_interseccion(double tiempo_actual) {
 
 void inicializar_cola_eventos(ColaEventos* cola) {
     omp_init_lock(&cola->lock);
-    cola->inicio = NULL;
-    cola->fin = NULL;
+    cola->datos = (EntradaHeap*)malloc(CAPACIDAD_INICIAL_COLA * sizeof(EntradaHeap));
+    cola->capacidad = cola->datos ? CAPACIDAD_INICIAL_COLA : 0;
     cola->size = 0;
     cola->max_size_alcanzado = 0;
+    cola->siguiente_secuencia = 0;
+    cola->asignaciones_cola = 1;
 }
 
 void destruir_cola_eventos(ColaEventos* cola) {
     omp_destroy_lock(&cola->lock);
+    free(cola->datos);
+    cola->datos = NULL;
+    cola->capacidad = 0;
+    cola->size = 0;
 }
 
-void insertar_evento_thread_safe(ColaEventos* cola, Evento evento) {
-    Nodo* nuevo = (Nodo*)malloc(sizeof(Nodo));
-    if (!nuevo) return;
-    
-    nuevo->evento = evento;
-    nuevo->siguiente = nuevo->anterior = NULL;
-    
+// Orden total: comparar_eventos y, en empate, orden de inserción
+static inline int entrada_precede(const EntradaHeap* a, const EntradaHeap* b) {
+    int orden = comparar_eventos(&a->evento, &b->evento);
+    if (orden != 0) return orden < 0;
+    return a->secuencia < b->secuencia;
+}
+
+// Inserta un evento programado desde el paso 'origen' (no necesariamente el
+// instante actual si el evento es diferido)
+void insertar_evento_desde(ColaEventos* cola, Evento evento, double origen) {
+    evento.origen = origen;
     omp_set_lock(&cola->lock);
     
-    if (!cola->inicio) {
-        cola->inicio = cola->fin = nuevo;
-    } else if (evento.tiempo >= cola->fin->evento.tiempo) {
-        nuevo->anterior = cola->fin;
-        if (cola->fin) cola->fin->siguiente = nuevo;
-        cola->fin = nuevo;
-        if (!cola->inicio) cola->inicio = nuevo;
-    } else if (evento.tiempo < cola->inicio->evento.tiempo) {
-        nuevo->siguiente = cola->inicio;
-        cola->inicio->anterior = nuevo;
-        cola->inicio = nuevo;
-    } else {
-        Nodo* actual = cola->fin;
-        while (actual && actual->evento.tiempo > evento.tiempo) {
-            actual = actual->anterior;
+    if (cola->size == cola->capacidad) {
+        int nueva_capacidad = cola->capacidad > 0 ? cola->capacidad * 2 : CAPACIDAD_INICIAL_COLA;
+        EntradaHeap* nuevos = (EntradaHeap*)realloc(cola->datos, nueva_capacidad * sizeof(EntradaHeap));
+        if (!nuevos) {
+            fprintf(stderr, "ERROR: No se pudo redimensionar la cola de eventos\n");
+            omp_unset_lock(&cola->lock);
+            return;
         }
-        
-        nuevo->siguiente = actual->siguiente;
-        nuevo->anterior = actual;
-        if (actual->siguiente) actual->siguiente->anterior = nuevo;
-        else cola->fin = nuevo;
-        actual->siguiente = nuevo;
+        cola->datos = nuevos;
+        cola->capacidad = nueva_capacidad;
+        cola->asignaciones_cola++;
+    }
+    
+    EntradaHeap nueva = {evento, cola->siguiente_secuencia++};
+    
+    // Subir (sift-up) moviendo huecos en lugar de intercambiar
+    int i = cola->size;
+    while (i > 0) {
+        int padre = (i - 1) / ARIDAD_HEAP;
+        if (!entrada_precede(&nueva, &cola->datos[padre])) break;
+        cola->datos[i] = cola->datos[padre];
+        i = padre;
     }
+    cola->datos[i] = nueva;
     
     cola->size++;
     if (cola->size > cola->max_size_alcanzado) {
@@ -445,35 +1420,206 @@ void insertar_evento_thread_safe(ColaEventos* cola, Evento evento) {
     omp_unset_lock(&cola->lock);
 }
 
-Evento* obtener_siguiente_evento_thread_safe(ColaEventos* cola) {
+void insertar_evento_thread_safe(ColaEventos* cola, Evento evento) {
+    insertar_evento_desde(cola, evento, vista->tiempo_actual);
+}
+
+// Copia el siguiente evento en el espacio del llamador; devuelve 0 si la cola está vacía
+int obtener_siguiente_evento_thread_safe(ColaEventos* cola, Evento* salida) {
     omp_set_lock(&cola->lock);
     
-    if (!cola->inicio) {
+    if (cola->size == 0) {
         omp_unset_lock(&cola->lock);
-        return NULL;
+        return 0;
     }
     
-    Nodo* nodo = cola->inicio;
-    Evento* evento = (Evento*)malloc(sizeof(Evento));
-    if (!evento) {
-        omp_unset_lock(&cola->lock);
-        return NULL;
+    *salida = cola->datos[0].evento;
+    
+    // Bajar (sift-down) el último elemento desde la raíz
+    cola->size--;
+    if (cola->size > 0) {
+        EntradaHeap ultima = cola->datos[cola->size];
+        int i = 0;
+        while (1) {
+            int primer_hijo = i * ARIDAD_HEAP + 1;
+            if (primer_hijo >= cola->size) break;
+            
+            int menor = primer_hijo;
+            int fin_hijos = primer_hijo + ARIDAD_HEAP;
+            if (fin_hijos > cola->size) fin_hijos = cola->size;
+            for (int h = primer_hijo + 1; h < fin_hijos; h++) {
+                if (entrada_precede(&cola->datos[h], &cola->datos[menor])) menor = h;
+            }
+            
+            if (!entrada_precede(&cola->datos[menor], &ultima)) break;
+            cola->datos[i] = cola->datos[menor];
+            i = menor;
+        }
+        cola->datos[i] = ultima;
     }
     
-    *evento = nodo->evento;
+    omp_unset_lock(&cola->lock);
+    return 1;
+}
+
+// Copia el siguiente evento sin sacarlo; devuelve 0 si la cola está vacía
+int ver_siguiente_evento(ColaEventos* cola, Evento* salida) {
+    omp_set_lock(&cola->lock);
+    int hay = cola->size > 0;
+    if (hay) *salida = cola->datos[0].evento;
+    omp_unset_lock(&cola->lock);
+    return hay;
+}
+
+// ============================================================================
+// COLAS DETENIDAS
+// ============================================================================
+//
+// En MODO_EVENTOS con AVANCE_ANALITICO, un vehículo parado cuyo último paso
+// no cambió nada (velocidad 0, misma posición y estado) repite ese paso
+// mientras no cambie lo que lee: la posición de su líder y, en la zona donde
+// se pide paso, el semáforo y la ocupación publicada. Entonces se duerme: lo
+// despierta su líder al avanzar y, si está en la zona de paso, el evento
+// SEMAFORO_CAMBIO o un cambio de ocupación que le cambie el permiso. Los
+// pasos dormidos se acreditan con las mismas sumas que el paso fijo; antes de
+// que el líder se mueva se acredita lo anterior, porque el choque por
+// proximidad depende de su posición.
+
+// Zona en la que puede_cruzar_interseccion mira el semáforo y la ocupación
+int en_zona_de_paso(double posicion) {
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    return posicion >= inicio_interseccion - 5.0 && posicion <= inicio_interseccion;
+}
+
+// El control de colisiones detendría al vehículo parado en i
+int colision_detenido(const AlmacenCalle* c, int i) {
+    int adelante = encontrar_vehiculo_adelante_interseccion(c->vehiculos[i]->direccion, c->posicion[i], i);
+    return adelante >= 0 &&
+           c->pub_posicion[adelante] - c->posicion[i] - params.longitud_vehiculo < params.distancia_seguridad_min * 0.8;
+}
+
+// Acredita los pasos dormidos del vehículo i anteriores al evento en curso
+void acreditar_espera(AlmacenCalle* c, int i) {
+    Vehiculo* v = c->vehiculos[i];
+    double dt = config.paso_simulacion;
+    int colision = colision_detenido(c, i);
+    long long acreditados = 0;
+    
+    while (paso_ya_ocurrido(v, v->inicio_libre)) {
+        v->inicio_libre += dt;
+        if (v->espera == ESPERA_PASO) {
+            v->tiempo_esperando_interseccion += dt;
+            v->tiempo_total_detenido += dt;  // Parado sin permiso de paso
+            if (colision) v->tiempo_total_detenido += dt;
+        } else if (c->estado[i] == DETENIDO) {
+            v->tiempo_total_detenido += dt;  // Frenado por proximidad
+        }
+        v->tiempo_en_estado += dt;
+        if (c->estado[i] == DETENIDO) v->tiempo_total_detenido += dt;
+        if (c->velocidad[i] < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
+        acreditados++;
+    }
+    if (acreditados == 0) return;
+    vista->pasos_detenidos += acreditados;
     
-    cola->inicio = nodo->siguiente;
-    if (cola->inicio) {
-        cola->inicio->anterior = NULL;
-    } else {
-        cola->fin = NULL;
+    double tiempo_transcurrido = v->inicio_libre - v->tiempo_entrada;
+    if (tiempo_transcurrido > 0) {
+        v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
+    }
+}
+
+// Si el vehículo i (recién actualizado) puede dormirse y por qué. Su último
+// paso debe haberse repetido sin cambios y su líder no debe estar en flujo
+// libre, porque entonces se movería sin procesar eventos.
+int calcular_espera(AlmacenCalle* c, int i, double posicion_previa, double velocidad_previa, int estado_previo) {
+    if (c->velocidad[i] != 0.0 || velocidad_previa != 0.0 ||
+        c->posicion[i] != posicion_previa || c->estado[i] != estado_previo) {
+        return ESPERA_NINGUNA;
     }
     
-    free(nodo);
-    cola->size--;
+    Vehiculo* v = c->vehiculos[i];
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    double posicion = c->posicion[i];
+    if (posicion >= inicio_interseccion) return ESPERA_NINGUNA;
     
-    omp_unset_lock(&cola->lock);
-    return evento;
+    int adelante = encontrar_vehiculo_adelante_interseccion(v->direccion, posicion, i);
+    if (adelante >= 0 && c->vehiculos[adelante]->pasos_libres > 0) return ESPERA_NINGUNA;
+    
+    if (posicion >= inicio_interseccion - distancia_aproximacion() && !tiene_paso(c, i)) {
+        return ESPERA_PASO;
+    }
+    return (adelante >= 0) ? ESPERA_LIDER : ESPERA_NINGUNA;
+}
+
+// Programa la actualización del vehículo en el paso que sigue a 'anterior'
+void programar_paso(ColaEventos* cola, Vehiculo* v, double anterior) {
+    v->paso_programado = anterior;
+    Evento paso = {
+        .tiempo = anterior + config.paso_simulacion, .tipo = ACTUALIZACION_VEHICULO, .id_auto = v->id,
+        .direccion = v->direccion, .vehiculo = v
+    };
+    insertar_evento_desde(cola, paso, anterior);
+}
+
+// Programa el paso de la cadena del vehículo que sigue a 'anterior'
+void despertar_vehiculo(ColaEventos* cola, Vehiculo* v, double anterior) {
+    v->despertar_programado = 1;
+    programar_paso(cola, v, anterior);
+}
+
+// Deja al vehículo i sin eventos. En la zona de paso entra en la lista que
+// despierta cada SEMAFORO_CAMBIO; con reservas el permiso solo cambia en
+// reserva_arranque y quien lo duerme programa ahí el despertar.
+void dormir_vehiculo(AlmacenCalle* c, int i, int espera, double reloj) {
+    Vehiculo* v = c->vehiculos[i];
+    v->espera = espera;
+    v->inicio_libre = reloj;
+    
+    if (config.control_interseccion == CONTROL_RESERVAS) return;
+    if (!en_zona_de_paso(c->posicion[i]) || v->en_lista_espera) return;
+    
+    v->siguiente_espera = vista->en_espera;
+    vista->en_espera = v;
+    v->en_lista_espera = 1;
+}
+
+// Paso de la cadena del vehículo anterior al primero que ve el cambio de
+// fase procesado en 'cambio' (los pasos en ese mismo instante van después)
+double paso_previo_al_cambio(Vehiculo* v, double cambio) {
+    double dt = config.paso_simulacion;
+    double t = v->inicio_libre;
+    while (t + dt < cambio) t += dt;
+    return t;
+}
+
+// SEMAFORO_CAMBIO: vacía la lista despertando a cada vehículo dormido en el
+// primer paso con la fase nueva
+void despertar_lista_semaforo(ColaEventos* cola, double cambio) {
+    Vehiculo* v = vista->en_espera;
+    vista->en_espera = NULL;
+    while (v) {
+        Vehiculo* siguiente = v->siguiente_espera;
+        v->siguiente_espera = NULL;
+        v->en_lista_espera = 0;
+        if (v->espera != ESPERA_NINGUNA && !v->despertar_programado) {
+            despertar_vehiculo(cola, v, paso_previo_al_cambio(v, cambio));
+        }
+        v = siguiente;
+    }
+}
+
+// Tras un cambio de ocupación despierta a quien le cambió el permiso de paso
+void revisar_lista_ocupacion(ColaEventos* cola) {
+    for (Vehiculo* v = vista->en_espera; v; v = v->siguiente_espera) {
+        if (v->espera == ESPERA_NINGUNA || v->despertar_programado) continue;
+        
+        AlmacenCalle* c = &interseccion.calles[v->direccion];
+        int tenia_paso = (v->espera == ESPERA_LIDER);
+        if (puede_cruzar_interseccion(v->direccion, c->posicion[v->indice]) != tenia_paso) {
+            acreditar_espera(c, v->indice);
+            despertar_vehiculo(cola, v, v->inicio_libre);
+        }
+    }
 }
 
 // ============================================================================
@@ -505,34 +1651,23 @@ const char* estado_interseccion_str(EstadoInterseccion estado) {
 }
 
 void imprimir_estado_interseccion() {
-    omp_set_lock(&semaforo.lock);
-    EstadoInterseccion estado_sem = semaforo.estado;
-    omp_unset_lock(&semaforo.lock);
+    EstadoInterseccion estado_sem = fase_semaforo();
     
     omp_set_lock(&interseccion.lock_sistema);
     printf("\n=== INTERSECCIÓN t=%.2f | %s | NS:%d EO:%d | En cruce:%d ===\n", 
-           interseccion.tiempo_actual, estado_interseccion_str(estado_sem),
-           interseccion.num_vehiculos_ns, interseccion.num_vehiculos_eo,
-           interseccion.vehiculos_en_interseccion);
+           vista->tiempo_actual, estado_interseccion_str(estado_sem),
+           interseccion.calles[NORTE_A_SUR].num, interseccion.calles[ESTE_A_OESTE].num,
+           ocupacion_total(vista->ocupacion));
     
     // Mostrar algunos vehículos de cada calle
-    printf("NORTE-SUR:\n");
-    int mostrar_ns = fmin(interseccion.num_vehiculos_ns, 4);
-    for (int i = 0; i < mostrar_ns; i++) {
-        Vehiculo* v = interseccion.vehiculos_norte_sur[i];
-        if (v) {
-            printf("  ID:%2d Pos=%6.1fm Vel=%5.2fm/s %s T%d\n", 
-                   v->id, v->posicion, v->velocidad, estado_str(v->estado), v->thread_id);
-        }
-    }
-    
-    printf("ESTE-OESTE:\n");
-    int mostrar_eo = fmin(interseccion.num_vehiculos_eo, 4);
-    for (int i = 0; i < mostrar_eo; i++) {
-        Vehiculo* v = interseccion.vehiculos_este_oeste[i];
-        if (v) {
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        AlmacenCalle* c = &interseccion.calles[d];
+        printf("%s:\n", (d == NORTE_A_SUR) ? "NORTE-SUR" : "ESTE-OESTE");
+        int mostrar = fmin(c->num, 4);
+        for (int i = c->primero; i < c->primero + mostrar; i++) {
             printf("  ID:%2d Pos=%6.1fm Vel=%5.2fm/s %s T%d\n", 
-                   v->id, v->posicion, v->velocidad, estado_str(v->estado), v->thread_id);
+                   c->vehiculos[i]->id, c->posicion[i], c->velocidad[i],
+                   estado_str(c->estado[i]), c->vehiculos[i]->thread_id);
         }
     }
     omp_unset_lock(&interseccion.lock_sistema);
@@ -543,10 +1678,27 @@ void imprimir_estado_interseccion() {
 // ARCHIVOS CSV THREAD-SAFE
 // ============================================================================
 
-FILE *csv_estados = NULL;
+// El archivo de estados usa el escritor asíncrono de trazas.h con un bloque
+// por thread de OpenMP; el de la intersección (un registro cada 20 s) sigue
+// siendo un FILE* directo.
+EscritorTrazas trazas_estados;
+int trazas_abiertas = 0;
 FILE *csv_interseccion = NULL;
 omp_lock_t lock_csv;
 
+// Una fila de la traza de estados antes de darle formato
+typedef struct {
+    double tiempo;
+    int id;
+    DireccionCalle direccion;
+    double posicion;
+    double velocidad;
+    double aceleracion;
+    int estado;                   // EstadoVehiculo
+    EstadoInterseccion semaforo;
+    int hilo;
+} FilaEstado;
+
 void inicializar_csv_estados() {
     omp_init_lock(&lock_csv);
     
@@ -577,19 +1729,46 @@ void inicializar_csv_estados() {
     
     // Construir rutas completas
     snprintf(nombre_estados, sizeof(nombre_estados), 
-             "%s/estados_interseccion_%s.csv", dir_path, timestamp);
+             "%s/estados_interseccion_%s.%s", dir_path, timestamp,
+             (config.formato_trazas == FORMATO_TRAZA_BINARIO) ? "trz" : "csv");
     snprintf(nombre_interseccion, sizeof(nombre_interseccion), 
              "%s/interseccion_%s.csv", dir_path, timestamp);
     
     printf("Directorio de código fuente: %s\n", dir_path);
     
-    csv_estados = fopen(nombre_estados, "w");
+    trazas_abiertas = escritor_trazas_abrir(&trazas_estados, nombre_estados, omp_get_max_threads());
     csv_interseccion = fopen(nombre_interseccion, "w");
     
-    if (csv_estados) {
-        fprintf(csv_estados, "Tiempo,ID,Direccion,Posicion,Velocidad,Estado,Semaforo,Thread\n");
-        fflush(csv_estados);
-        printf("✓ CSV estados creado: %s\n", nombre_estados);
+    if (trazas_abiertas) {
+        // El encabezado va directo al archivo para quedar antes de los bloques
+        // de cualquier thread
+        const char* columnas = "Tiempo,ID,Direccion,Posicion,Velocidad,Estado,Semaforo,Thread";
+        if (config.formato_trazas == FORMATO_TRAZA_BINARIO) {
+            char texto[TRAZA_MAX_TEXTO];
+            int n = snprintf(texto, sizeof(texto),
+                             "simulador=interseccion\ncsv_columnas=%s\nestados=", columnas);
+            for (int e = ENTRANDO; e <= SALIENDO; e++) {
+                n += snprintf(texto + n, sizeof(texto) - n, "%s%s", estado_str(e), (e < SALIENDO) ? "," : "\n");
+            }
+            n += snprintf(texto + n, sizeof(texto) - n, "semaforo=");
+            for (int e = NORTE_SUR_VERDE; e <= TRANSICION; e++) {
+                n += snprintf(texto + n, sizeof(texto) - n, "%s%s", estado_interseccion_str(e), (e < TRANSICION) ? "," : "\n");
+            }
+            snprintf(texto + n, sizeof(texto) - n,
+                     "direcciones=NS,EO\npaso_simulacion=%g\nlongitud_calle_ns=%g\nlongitud_calle_eo=%g\n"
+                     "posicion_interseccion=%g\nancho_interseccion=%g\nmax_autos_por_calle=%d\n"
+                     "intervalo_entrada_vehiculos=%g\nvelocidad_maxima=%g\nmodo_simulacion=%d\nmodo_avance=%d\n",
+                     config.paso_simulacion, config.longitud_calle_ns, config.longitud_calle_eo,
+                     config.posicion_interseccion, config.ancho_interseccion, config.max_autos_por_calle,
+                     config.intervalo_entrada_vehiculos, params.velocidad_maxima, config.modo_simulacion,
+                     config.modo_avance);
+            escritor_trazas_encabezado_binario(&trazas_estados, texto);
+        } else {
+            char encabezado[128];
+            int n = snprintf(encabezado, sizeof(encabezado), "%s\n", columnas);
+            escritor_trazas_encabezado(&trazas_estados, encabezado, n);
+        }
+        printf("✓ Trazas de estados creadas: %s\n", nombre_estados);
     } else {
         fprintf(stderr, "ERROR: No se pudo crear %s\n", nombre_estados);
         perror("Razón");
@@ -605,477 +1784,2314 @@ void inicializar_csv_estados() {
     }
 }
 
-void registrar_estado_vehiculo_thread_safe(Vehiculo* v) {
-    if (!csv_estados || !v) return;
+// Fila de la traza de estados de un vehículo en el instante de la vista
+static inline FilaEstado fila_estado_vehiculo(const AlmacenCalle* c, int i) {
+    Vehiculo* v = c->vehiculos[i];
+    FilaEstado f = {
+        .tiempo = vista->tiempo_actual,
+        .id = v->id,
+        .direccion = v->direccion,
+        .posicion = c->posicion[i],
+        .velocidad = c->velocidad[i],
+        .aceleracion = c->aceleracion[i],
+        .estado = c->estado[i],
+        .semaforo = fase_semaforo(),
+        .hilo = v->thread_id
+    };
+    return f;
+}
+
+void escribir_fila_estado(const FilaEstado* f) {
+    // Cada thread escribe en su propio bloque: no hace falta lock_csv
+    if (config.formato_trazas == FORMATO_TRAZA_BINARIO) {
+        RegistroTraza r = {
+            .tiempo = traza_centesimas(f->tiempo),
+            .id = f->id,
+            .posicion = traza_centesimas(f->posicion),
+            .velocidad = traza_centesimas(f->velocidad),
+            .aceleracion = traza_centesimas(f->aceleracion),
+            .estado = (uint8_t)f->estado,
+            .semaforo = (uint8_t)f->semaforo,
+            .direccion = (uint8_t)f->direccion,
+            .hilo = (uint16_t)f->hilo
+        };
+        escritor_trazas_registro(&trazas_estados, omp_get_thread_num(), &r);
+        return;
+    }
+    
+    char linea[160];
+    int n = snprintf(linea, sizeof(linea), "%.2f,%d,%s,%.2f,%.2f,%s,%s,%d\n",
+                     f->tiempo, f->id,
+                     (f->direccion == NORTE_A_SUR) ? "NS" : "EO",
+                     f->posicion, f->velocidad, estado_str(f->estado),
+                     estado_interseccion_str(f->semaforo), f->hilo);
+    if (n > 0 && n < (int)sizeof(linea)) {
+        escritor_trazas_escribir(&trazas_estados, omp_get_thread_num(), linea, n);
+    }
+}
+
+void registrar_estado_vehiculo_thread_safe(const AlmacenCalle* c, int i) {
+    if (!trazas_abiertas) return;
+    FilaEstado f = fila_estado_vehiculo(c, i);
+    escribir_fila_estado(&f);
+}
+
+void registrar_estado_interseccion() {
+    if (!csv_interseccion) return;
     
     omp_set_lock(&lock_csv);
-    omp_set_lock(&semaforo.lock);
-    EstadoInterseccion estado_sem = semaforo.estado;
-    omp_unset_lock(&semaforo.lock);
+    EstadoInterseccion estado_sem = fase_semaforo();
     
-    fprintf(csv_estados, "%.2f,%d,%s,%.2f,%.2f,%s,%s,%d\n",
-            interseccion.tiempo_actual, v->id,
-            (v->direccion == NORTE_A_SUR) ? "NS" : "EO",
-            v->posicion, v->velocidad, estado_str(v->estado),
-            estado_interseccion_str(estado_sem), v->thread_id);
-    fflush(csv_estados);
+    PalabraOcupacion ocupacion = __atomic_load_n(&vista->ocupacion, __ATOMIC_ACQUIRE);
+    DireccionCalle cruzando = ocupacion_direccion(
+        (config.modo_simulacion == MODO_TICK) ? interseccion.ocupacion_publicada : ocupacion);
+    fprintf(csv_interseccion, "%.2f,%s,%d,%d,%d,%s\n",
+            vista->tiempo_actual,
+            estado_interseccion_str(estado_sem),
+            interseccion.calles[NORTE_A_SUR].num,
+            interseccion.calles[ESTE_A_OESTE].num,
+            ocupacion_total(ocupacion),
+            (ocupacion_total(ocupacion) > 0) ? 
+                ((cruzando == NORTE_A_SUR) ? "NS" : "EO") : "NINGUNA");
+    fflush(csv_interseccion);
     
     omp_unset_lock(&lock_csv);
 }
 
-void registrar_estado_interseccion() {
-    if (!csv_interseccion) return;
-    
-    omp_set_lock(&lock_csv);
-    omp_set_lock(&semaforo.lock);
-    EstadoInterseccion estado_sem = semaforo.estado;
-    omp_unset_lock(&semaforo.lock);
-    
-    omp_set_lock(&interseccion.lock_interseccion);
-    fprintf(csv_interseccion, "%.2f,%s,%d,%d,%d,%s\n",
-            interseccion.tiempo_actual,
-            estado_interseccion_str(estado_sem),
-            interseccion.num_vehiculos_ns,
-            interseccion.num_vehiculos_eo,
-            interseccion.vehiculos_en_interseccion,
-            (interseccion.vehiculos_en_interseccion > 0) ? 
-                ((interseccion.direccion_actual_cruzando == NORTE_A_SUR) ? "NS" : "EO") : "NINGUNA");
-    fflush(csv_interseccion);
-    omp_unset_lock(&interseccion.lock_interseccion);
-    
-    omp_unset_lock(&lock_csv);
+void cerrar_csv_estados() {
+    omp_destroy_lock(&lock_csv);
+    if (trazas_abiertas) {
+        escritor_trazas_cerrar(&trazas_estados);
+        trazas_abiertas = 0;
+        printf("Trazas de estados: %.1f MB en %d escrituras, %d esperas de los threads\n",
+               trazas_estados.bytes_escritos / (1024.0 * 1024.0),
+               trazas_estados.escrituras, trazas_estados.esperas);
+    }
+    if (csv_interseccion) {
+        fclose(csv_interseccion);
+        csv_interseccion = NULL;
+    }
+    printf("Archivos CSV cerrados.\n");
+}
+
+// ============================================================================
+// DECLARACIONES DE FUNCIONES
+// ============================================================================
+
+void generar_estadisticas_interseccion();
+void procesar_eventos_interseccion_paralelo(void);
+void enviar_cambio_ocupacion(const Evento* e, int delta);
+void retener_estado(const AlmacenCalle* c, int i);
+void retener_estado_ronda(const AlmacenCalle* c, int i);
+void retener_resumen(const Vehiculo* v);
+void retener_vehiculo(Vehiculo* v);
+void configurar_interseccion(void);
+
+// ============================================================================
+// ACTUALIZACIÓN DE VEHÍCULOS CON PARALELISMO
+// ============================================================================
+
+// La actualización se divide en tres fases para que la física quede en un
+// bucle sin ramas sobre columnas contiguas: decidir la maniobra (fija la
+// aceleración), integrar con el kernel y confirmar el movimiento
+// (seguridad, estado y estadísticas).
+
+void decidir_maniobra_interseccion(AlmacenCalle* c, int i, double dt) {
+    Vehiculo* v = c->vehiculos[i];
+    if (c->estado[i] == SALIENDO) return;
+    
+    v->actualizaciones_count++;
+    v->thread_id = omp_get_thread_num();
+    
+    double pos_interseccion = config.posicion_interseccion;
+    double inicio_interseccion = pos_interseccion - config.ancho_interseccion/2;
+    double fin_interseccion = pos_interseccion + config.ancho_interseccion/2;
+    double posicion = c->posicion[i];
+    
+    // Lógica específica para intersección
+    if (posicion < inicio_interseccion - distancia_aproximacion()) {
+        // Comportamiento normal antes de la intersección
+        if (c->velocidad[i] < params.velocidad_maxima - 0.2) {
+            c->estado[i] = ACELERANDO;
+            c->aceleracion[i] = params.aceleracion_maxima;
+        } else {
+            c->estado[i] = VELOCIDAD_CONSTANTE;
+            c->aceleracion[i] = 0.0;
+        }
+        
+        // Verificar vehículo adelante
+        int adelante = encontrar_vehiculo_adelante_interseccion(v->direccion, posicion, i);
+        if (adelante >= 0) {
+            double distancia = c->pub_posicion[adelante] - posicion - params.longitud_vehiculo;
+            if (distancia < params.distancia_seguridad_min * 1.5) {
+                c->estado[i] = DESACELERANDO;
+                c->aceleracion[i] = params.desaceleracion_suave;
+            }
+        }
+        
+    } else if (posicion >= inicio_interseccion - distancia_aproximacion() && posicion < inicio_interseccion) {
+        // Aproximándose a la intersección
+        if (tiene_paso(c, i)) {
+            c->estado[i] = ACELERANDO;
+            c->aceleracion[i] = params.aceleracion_maxima * 0.8;
+        } else {
+            c->estado[i] = ESPERANDO_PASO;
+            c->aceleracion[i] = params.desaceleracion_maxima;
+            v->tiempo_esperando_interseccion += dt;
+            
+            if (c->velocidad[i] <= 0.1) {
+                c->velocidad[i] = 0.0;
+                c->estado[i] = DETENIDO;
+                c->aceleracion[i] = 0.0;
+                v->tiempo_total_detenido += dt;
+            }
+        }
+        
+    } else if (posicion >= inicio_interseccion && posicion <= fin_interseccion) {
+        // En la intersección
+        if (c->estado[i] != CRUZANDO_INTERSECCION) {
+            entrar_interseccion(c, i);
+        }
+        c->aceleracion[i] = params.aceleracion_maxima * 0.6; // Velocidad controlada en intersección
+        
+    } else if (posicion > fin_interseccion) {
+        // Después de la intersección
+        if (c->estado[i] == CRUZANDO_INTERSECCION) {
+            salir_interseccion(v);
+        }
+        
+        if (c->velocidad[i] < params.velocidad_maxima - 0.2) {
+            c->estado[i] = ACELERANDO;
+            c->aceleracion[i] = params.aceleracion_maxima;
+        } else {
+            c->estado[i] = VELOCIDAD_CONSTANTE;
+            c->aceleracion[i] = 0.0;
+        }
+    }
+}
+
+// Aplica el resultado del kernel (nueva_posicion/nueva_velocidad). El estado y
+// la velocidad del paso anterior se leen del buffer publicado.
+void confirmar_movimiento_interseccion(AlmacenCalle* c, int i, double dt) {
+    Vehiculo* v = c->vehiculos[i];
+    if (c->estado[i] == SALIENDO) return;
+    
+    double velocidad_anterior = c->pub_velocidad[i];
+    int estado_anterior = c->pub_estado[i];   // EstadoVehiculo, como la columna
+    double nueva_velocidad = c->nueva_velocidad[i];
+    double nueva_posicion = c->nueva_posicion[i];
+    
+    // Verificar colisiones
+    int adelante = encontrar_vehiculo_adelante_interseccion(v->direccion, c->posicion[i], i);
+    int puede_avanzar = 1;
+    
+    if (adelante >= 0) {
+        double distancia_resultante = c->pub_posicion[adelante] - nueva_posicion - params.longitud_vehiculo;
+        if (distancia_resultante < params.distancia_seguridad_min * 0.8) {
+            puede_avanzar = 0;
+        }
+    }
+    
+    // Actualizar posición y velocidad
+    if (puede_avanzar) {
+        c->velocidad[i] = nueva_velocidad;
+        c->posicion[i] = nueva_posicion;
+        v->distancia_recorrida += nueva_velocidad * dt;
+    } else {
+        c->velocidad[i] = 0.0;
+        c->estado[i] = DETENIDO;
+        c->aceleracion[i] = 0.0;
+        v->tiempo_total_detenido += dt;
+    }
+    
+    // Registrar cambios de estado
+    if (estado_anterior != c->estado[i]) {
+        v->tiempo_en_estado = 0.0;
+        v->ultimo_cambio_estado = vista->tiempo_actual;
+    } else {
+        v->tiempo_en_estado += dt;
+    }
+    
+    // Estadísticas
+    if (c->estado[i] == DETENIDO) v->tiempo_total_detenido += dt;
+    if (c->velocidad[i] < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
+    if (c->velocidad[i] > 0 && velocidad_anterior == 0) {
+        v->eventos_reanudacion++;
+    }
+    
+    // Calcular velocidad promedio
+    if (v->actualizaciones_count > 0) {
+        double tiempo_transcurrido = vista->tiempo_actual - v->tiempo_entrada;
+        if (tiempo_transcurrido > 0) {
+            v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
+        }
+    }
+}
+
+void actualizar_vehiculo_interseccion(AlmacenCalle* c, int i, double dt) {
+    decidir_maniobra_interseccion(c, i, dt);
+    integrar_cinematica(c, i, i + 1, dt);
+    confirmar_movimiento_interseccion(c, i, dt);
+}
+
+// Marca como SALIENDO un vehículo que llegó al final de su calle
+int verificar_salida_vehiculo(AlmacenCalle* c, int i) {
+    Vehiculo* v = c->vehiculos[i];
+    double longitud_calle = (v->direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
+    
+    if (c->posicion[i] < longitud_calle) return 0;
+    
+    v->tiempo_salida = vista->tiempo_actual;
+    v->completado = 1;
+    c->estado[i] = SALIENDO;
+    
+    double tiempo_total = v->tiempo_salida - v->tiempo_entrada;
+    printf("[%.2f] Vehículo %d (%s) completa recorrido en %.2fs\n",
+           vista->tiempo_actual, v->id,
+           (v->direccion == NORTE_A_SUR) ? "NS" : "EO", tiempo_total);
+    return 1;
+}
+
+// Retira de una calle los vehículos que salieron. Por el orden FIFO solo
+// pueden haber llegado al final los de la cabeza.
+int retirar_vehiculos_salientes(AlmacenCalle* c) {
+    int retirados = 0;
+    while (c->num > 0 && verificar_salida_vehiculo(c, c->primero)) {
+        Vehiculo* v = c->vehiculos[c->primero];
+        quitar_vehiculo_calle(c, c->primero);
+        emitir_resumen(v);
+        devolver_vehiculo(v);
+        retirados++;
+    }
+    return retirados;
+}
+
+// ============================================================================
+// EQUIPO PERSISTENTE DE THREADS
+// ============================================================================
+//
+// La simulación corre dentro de una sola región paralela. El thread 0 es el
+// dueño de la cola: procesa en serie las entradas, los cambios de fase y los
+// eventos por vehículo. Cuando el evento en curso es un TICK publica un lote
+// con los bloques de vehículos de ese instante y el equipo entero lo reparte
+// con un 'omp for'; entre lotes los demás threads esperan en la barrera de
+// sincronizar_equipo, sin crear ni destruir threads en cada paso.
+//
+// En MODO_EVENTOS el equipo es de un solo thread: cada vehículo avanza en su
+// propia rejilla de instantes (desde su entrada), así que casi nunca hay dos
+// eventos en el mismo instante que repartir.
+
+#define LOTE_NINGUNO 0
+#define LOTE_TICK 1    // Bloques de vehículos de un paso TICK
+#define LOTE_FIN 2     // El maestro terminó: el equipo sale de la región
+
+typedef struct {
+    int tipo;
+    double dt;
+    int bloques_ns;
+    int total_bloques;
+} LoteEquipo;
+
+// Lo escribe el maestro antes de la barrera; los demás lo leen después
+LoteEquipo lote = {LOTE_NINGUNO, 0.0, 0, 0};
+
+// Avanza todos los vehículos activos un paso repartiendo las dos calles entre
+// el equipo; las entradas, salidas y el semáforo siguen siendo eventos
+// discretos. Cada vehículo escribe solo su propio estado y lee el de los demás
+// desde el buffer publicado, que se intercambia (copia) una vez al final del
+// paso: el resultado es el mismo con cualquier número de threads. El trabajo
+// se reparte por bloques para que el kernel integre varios vehículos
+// seguidos.
+#define TAMANO_BLOQUE_TICK 64
+
+void procesar_bloque_tick(int b) {
+    AlmacenCalle* c = &interseccion.calles[(b < lote.bloques_ns) ? NORTE_A_SUR : ESTE_A_OESTE];
+    int inicio = c->primero + ((b < lote.bloques_ns) ? b : b - lote.bloques_ns) * TAMANO_BLOQUE_TICK;
+    int fin = inicio + TAMANO_BLOQUE_TICK;
+    if (fin > c->primero + c->num) fin = c->primero + c->num;
+    
+    for (int i = inicio; i < fin; i++) {
+        decidir_maniobra_interseccion(c, i, lote.dt);
+    }
+    integrar_cinematica(c, inicio, fin, lote.dt);
+    for (int i = inicio; i < fin; i++) {
+        confirmar_movimiento_interseccion(c, i, lote.dt);
+        registrar_estado_vehiculo_thread_safe(c, i);
+    }
+}
+
+// Lo ejecutan todos los threads del equipo; barrera implícita al final
+void repartir_lote_tick() {
+    #pragma omp for schedule(dynamic, 1)
+    for (int b = 0; b < lote.total_bloques; b++) {
+        procesar_bloque_tick(b);
+    }
+}
+
+// Única barrera entre el maestro y el resto del equipo
+void sincronizar_equipo() {
+    #pragma omp barrier
+}
+
+// Bucle de los threads distintos del maestro
+void servir_lotes() {
+    while (1) {
+        sincronizar_equipo();
+        if (lote.tipo == LOTE_FIN) return;
+        repartir_lote_tick();
+    }
+}
+
+// El maestro libera al equipo de la región paralela
+void terminar_lotes() {
+    if (omp_get_num_threads() == 1) return;
+    lote.tipo = LOTE_FIN;
+    sincronizar_equipo();
+}
+
+void procesar_tick_interseccion(double dt) {
+    AlmacenCalle* ns = &interseccion.calles[NORTE_A_SUR];
+    AlmacenCalle* eo = &interseccion.calles[ESTE_A_OESTE];
+    
+    // Las solicitudes de reserva van en serie para que el reparto de ranuras
+    // no dependa del número de threads
+    if (config.control_interseccion == CONTROL_RESERVAS) {
+        for (int i = ns->primero; i < ns->primero + ns->num; i++) actualizar_reserva(ns, i, vista->tiempo_actual);
+        for (int i = eo->primero; i < eo->primero + eo->num; i++) actualizar_reserva(eo, i, vista->tiempo_actual);
+    }
+    
+    lote.tipo = LOTE_TICK;
+    lote.dt = dt;
+    lote.bloques_ns = (ns->num + TAMANO_BLOQUE_TICK - 1) / TAMANO_BLOQUE_TICK;
+    lote.total_bloques = lote.bloques_ns + (eo->num + TAMANO_BLOQUE_TICK - 1) / TAMANO_BLOQUE_TICK;
+    
+    // Un solo bloque no compensa despertar al equipo
+    if (lote.total_bloques > 1 && omp_get_num_threads() > 1) {
+        sincronizar_equipo();
+        repartir_lote_tick();
+    } else {
+        for (int b = 0; b < lote.total_bloques; b++) procesar_bloque_tick(b);
+    }
+    
+    vista->actualizaciones += ns->num + eo->num;
+    
+    // Intercambio de buffers: publicar el nuevo estado para el siguiente paso
+    publicar_estado_calle(ns);
+    publicar_estado_calle(eo);
+    
+    publicar_ocupacion_interseccion();
+    
+    omp_set_lock(&interseccion.lock_sistema);
+    interseccion.total_vehiculos_completados_ns += retirar_vehiculos_salientes(ns);
+    interseccion.total_vehiculos_completados_eo += retirar_vehiculos_salientes(eo);
+    omp_unset_lock(&interseccion.lock_sistema);
+}
+
+// ============================================================================
+// FUNCIÓN PRINCIPAL DE SIMULACIÓN PARALELA
+// ============================================================================
+
+// Una calle admite llegadas mientras no haya creado max_autos_por_calle
+// (0 = sin tope) y, con tiempo_limite_simulacion, antes de ese instante. Los
+// vehículos que ya entraron completan su recorrido.
+int llegadas_abiertas(int creados, double tiempo) {
+    if (config.max_autos_por_calle > 0 && creados >= config.max_autos_por_calle) return 0;
+    if (config.tiempo_limite_simulacion > 0.0 && tiempo >= config.tiempo_limite_simulacion) return 0;
+    return 1;
+}
+
+// Vehículos por calle que se espera crear, para el progreso y las estimaciones
+long long vehiculos_previstos_por_calle() {
+    long long por_tiempo = 0;
+    if (config.tiempo_limite_simulacion > 0.0) {
+        por_tiempo = (long long)(config.tiempo_limite_simulacion / config.intervalo_entrada_vehiculos) + 1;
+    }
+    if (config.max_autos_por_calle > 0 && (por_tiempo == 0 || config.max_autos_por_calle < por_tiempo)) {
+        return config.max_autos_por_calle;
+    }
+    return por_tiempo;
+}
+
+// Ninguna calle espera más llegadas y ya no quedan vehículos en ellas
+int simulacion_terminada(const int* llegadas_pendientes) {
+    return !llegadas_pendientes[NORTE_A_SUR] && !llegadas_pendientes[ESTE_A_OESTE] &&
+           interseccion.calles[NORTE_A_SUR].num == 0 && interseccion.calles[ESTE_A_OESTE].num == 0;
+}
+
+// ENTRADA de una calle: crea el vehículo si hay sitio y programa su primer
+// paso y la siguiente llegada; si no, reintenta en un segundo. Devuelve 0 si
+// no se pudo hacer sitio en la calle.
+int procesar_entrada(ColaEventos* cola, const Evento* e, int* id_auto, int* llegadas_pendientes) {
+    DireccionCalle d = e->direccion;
+    int* creados = (d == NORTE_A_SUR) ? &interseccion.total_vehiculos_creados_ns
+                                      : &interseccion.total_vehiculos_creados_eo;
+    if (!llegadas_abiertas(*creados, e->tiempo)) return 1;
+    
+    // Verificar espacio
+    AlmacenCalle* c = &interseccion.calles[d];
+    omp_set_lock(&interseccion.lock_sistema);
+    int puede_entrar = entrada_libre_calle(c);
+    omp_unset_lock(&interseccion.lock_sistema);
+    
+    if (!puede_entrar) {
+        // Reintentar entrada
+        if (llegadas_abiertas(*creados, e->tiempo + 1.0)) {
+            Evento reintento = {
+                .tiempo = e->tiempo + 1.0, .tipo = e->tipo, .id_auto = *id_auto, .direccion = d,
+                .prioridad = 1
+            };
+            insertar_evento_thread_safe(cola, reintento);
+        } else {
+            *llegadas_pendientes = 0;
+        }
+        return 1;
+    }
+    
+    if (!redimensionar_sistema_si_necesario(c)) {
+        printf("ERROR: No se pudo redimensionar el sistema\n");
+        return 0;
+    }
+    
+    Vehiculo* v = obtener_vehiculo();
+    if (!v) return 1;
+    v->id = *id_auto;
+    v->direccion = d;
+    v->tiempo_entrada = e->tiempo;
+    v->ultimo_cambio_estado = e->tiempo;
+    v->thread_id = omp_get_thread_num();
+    
+    omp_set_lock(&interseccion.lock_sistema);
+    agregar_vehiculo_calle(c, v);
+    (*creados)++;
+    omp_unset_lock(&interseccion.lock_sistema);
+    
+    // Programar actualización (en modo TICK la hace el tick global)
+    if (config.modo_simulacion != MODO_TICK) programar_paso(cola, v, e->tiempo);
+    
+    *id_auto += PASO_ID_AUTO;
+    
+    // Programar siguiente entrada
+    if (llegadas_abiertas(*creados, e->tiempo + config.intervalo_entrada_vehiculos)) {
+        Evento sig = {
+            .tiempo = e->tiempo + config.intervalo_entrada_vehiculos, .tipo = e->tipo, .id_auto = *id_auto,
+            .direccion = d, .prioridad = 1
+        };
+        insertar_evento_thread_safe(cola, sig);
+    } else {
+        *llegadas_pendientes = 0;
+    }
+    return 1;
+}
+
+// ACTUALIZACION_VEHICULO: un paso del vehículo y lo que cambia a su alrededor
+// (seguidor dormido, lista de espera, salida de la calle)
+void procesar_actualizacion(ColaEventos* cola, const Evento* e) {
+    Vehiculo* v = e->vehiculo;
+    if (!v || v->completado) return;
+    
+    AlmacenCalle* c = &interseccion.calles[v->direccion];
+    double dt = config.paso_simulacion;
+    
+    // Fin de un tramo de flujo libre; el líder se lee al día
+    sincronizar_vehiculo(c, v->indice);
+    if (v->indice > c->primero) sincronizar_vehiculo(c, v->indice - 1);
+    
+    // Fin de una espera detenida: acreditar los pasos dormidos
+    if (v->espera != ESPERA_NINGUNA) {
+        acreditar_espera(c, v->indice);
+        v->espera = ESPERA_NINGUNA;
+        v->despertar_programado = 0;
+    }
+    
+    // El seguidor dormido ve la posición actual hasta este instante
+    Vehiculo* seguidor = (v->indice + 1 < c->primero + c->num) ? c->vehiculos[v->indice + 1] : NULL;
+    int seguidor_lo_veia = 0;
+    if (seguidor && seguidor->espera != ESPERA_NINGUNA) {
+        acreditar_espera(c, seguidor->indice);
+        seguidor_lo_veia = encontrar_vehiculo_adelante_interseccion(
+            seguidor->direccion, c->posicion[seguidor->indice], seguidor->indice) >= 0;
+    }
+    
+    double posicion_previa = c->posicion[v->indice];
+    double velocidad_previa = c->velocidad[v->indice];
+    int estado_previo = c->estado[v->indice];
+    PalabraOcupacion ocupacion_previa = ocupacion_visible();
+    
+    actualizar_reserva(c, v->indice, e->tiempo);
+    
+    actualizar_vehiculo_interseccion(c, v->indice, dt);
+    publicar_estado_vehiculo(c, v->indice);
+    // En MODO_OPTIMISTA las salidas esperan al GVT y en MODO_CONSERVADOR las
+    // trazas, al cierre de la ronda
+    if (vista->especulativo) {
+        retener_estado(c, v->indice);
+    } else if (config.modo_simulacion == MODO_CONSERVADOR) {
+        retener_estado_ronda(c, v->indice);
+    } else {
+        registrar_estado_vehiculo_thread_safe(c, v->indice);
+    }
+    vista->actualizaciones++;
+    
+    // Verificar salida del sistema
+    if (verificar_salida_vehiculo(c, v->indice)) {
+        // Remover de vehículos activos
+        omp_set_lock(&interseccion.lock_sistema);
+        quitar_vehiculo_calle(c, v->indice);
+        if (vista->especulativo) {
+            retener_resumen(v);
+        } else {
+            emitir_resumen(v);
+        }
+        if (v->direccion == NORTE_A_SUR) {
+            interseccion.total_vehiculos_completados_ns++;
+        } else {
+            interseccion.total_vehiculos_completados_eo++;
+        }
+        omp_unset_lock(&interseccion.lock_sistema);
+    } else {
+        // Programar siguiente actualización; en flujo libre se
+        // salta directamente al primer paso que no sea trivial
+        long long libres = (config.modo_avance == AVANCE_ANALITICO)
+                           ? calcular_pasos_libres(c, v->indice) : 0;
+        int espera = (config.modo_avance == AVANCE_ANALITICO && libres == 0)
+                     ? calcular_espera(c, v->indice, posicion_previa, velocidad_previa, estado_previo)
+                     : ESPERA_NINGUNA;
+        double tiempo_previo = e->tiempo;
+        if (libres > 0) {
+            v->pasos_libres = libres;
+            v->inicio_libre = e->tiempo;
+            for (long long k = 0; k < libres; k++) tiempo_previo += config.paso_simulacion;
+        }
+        if (espera == ESPERA_NINGUNA) {
+            programar_paso(cola, v, tiempo_previo);
+        } else {
+            // Dormir: sin evento hasta que avance el líder o cambie el permiso de paso
+            dormir_vehiculo(c, v->indice, espera, e->tiempo);
+            if (espera == ESPERA_PASO && config.control_interseccion == CONTROL_RESERVAS) {
+                despertar_vehiculo(cola, v, paso_previo_al_cambio(v, v->reserva_arranque));
+            }
+        }
+    }
+    
+    // Despertar al seguidor si este vehículo se movió o salió a su vista
+    if (seguidor && seguidor->espera != ESPERA_NINGUNA && !seguidor->despertar_programado &&
+        (v->completado || c->posicion[v->indice] != posicion_previa)) {
+        int lo_ve = encontrar_vehiculo_adelante_interseccion(
+            seguidor->direccion, c->posicion[seguidor->indice], seguidor->indice) >= 0;
+        if (seguidor_lo_veia || lo_ve) {
+            despertar_vehiculo(cola, seguidor, seguidor->inicio_libre);
+        }
+    }
+    
+    // Un cambio de ocupación puede cambiar el permiso de los que esperan
+    PalabraOcupacion ocupacion_nueva = ocupacion_visible();
+    if (vista->en_espera && (ocupacion_total(ocupacion_nueva) != ocupacion_total(ocupacion_previa) ||
+                             ocupacion_direccion(ocupacion_nueva) != ocupacion_direccion(ocupacion_previa))) {
+        revisar_lista_ocupacion(cola);
+    }
+    
+    // Con procesos lógicos, la otra calle se entera por la caja
+    int delta = ocupacion_en(ocupacion_nueva, v->direccion) - ocupacion_en(ocupacion_previa, v->direccion);
+    if (vista->salida && delta != 0) enviar_cambio_ocupacion(e, delta);
+    
+    // Ya sin eventos pendientes ni lugar en su calle
+    if (v->completado) {
+        if (vista->especulativo) {
+            retener_vehiculo(v);
+        } else {
+            devolver_vehiculo(v);
+        }
+    }
+}
+
+// Bucle de eventos del thread maestro, dueño de la cola
+void bucle_eventos_maestro(ColaEventos* cola) {
+    // Eventos iniciales
+    int id_auto[2] = {PRIMER_ID_AUTO(NORTE_A_SUR), PRIMER_ID_AUTO(ESTE_A_OESTE)};
+    
+    Evento entrada_ns = {
+        .tiempo = 0.0, .tipo = ENTRADA_NORTE, .id_auto = id_auto[NORTE_A_SUR], .direccion = NORTE_A_SUR,
+        .prioridad = 1
+    };
+    Evento entrada_eo = {
+        .tiempo = 0.5, .tipo = ENTRADA_ESTE, .id_auto = id_auto[ESTE_A_OESTE], .direccion = ESTE_A_OESTE,
+        .prioridad = 1
+    };
+    
+    // Cada calle tiene una ENTRADA en la cola hasta que cierra sus llegadas
+    int llegadas_pendientes[2];
+    llegadas_pendientes[NORTE_A_SUR] = llegadas_abiertas(0, entrada_ns.tiempo);
+    llegadas_pendientes[ESTE_A_OESTE] = llegadas_abiertas(0, entrada_eo.tiempo);
+    if (llegadas_pendientes[NORTE_A_SUR]) insertar_evento_thread_safe(cola, entrada_ns);
+    if (llegadas_pendientes[ESTE_A_OESTE]) insertar_evento_thread_safe(cola, entrada_eo);
+    
+    if (config.control_interseccion == CONTROL_SEMAFORO) {
+        Evento primer_cambio = {
+            .tiempo = iniciar_semaforo(), .tipo = SEMAFORO_CAMBIO, .direccion = NORTE_A_SUR, .prioridad = 1
+        };
+        insertar_evento_thread_safe(cola, primer_cambio);
+    }
+    
+    if (config.modo_simulacion == MODO_TICK) {
+        Evento tick = {.tiempo = config.paso_simulacion, .tipo = TICK, .direccion = NORTE_A_SUR};
+        insertar_evento_thread_safe(cola, tick);
+    }
+    
+    double ultimo_reporte = 0.0;
+    long long vehiculos_previstos = vehiculos_previstos_por_calle() * 2;
+    
+    // BUCLE PRINCIPAL PARALELO
+    while ((cola->size > 0 || interseccion.calles[NORTE_A_SUR].num > 0 || interseccion.calles[ESTE_A_OESTE].num > 0) &&
+           !simulacion_terminada(llegadas_pendientes)) {
+        
+        Evento evento_actual;
+        Evento* e = &evento_actual;
+        
+        if (!obtener_siguiente_evento_thread_safe(cola, e)) {
+            // Verificar si hay vehículos activos
+            if (interseccion.calles[NORTE_A_SUR].num > 0 || interseccion.calles[ESTE_A_OESTE].num > 0) {
+                printf("ADVERTENCIA: Sin eventos pero vehículos activos en t=%.2f\n", vista->tiempo_actual);
+            }
+            break;
+        }
+        
+        // El ciclo del semáforo por sí solo no prolonga la simulación
+        if (e->tipo == SEMAFORO_CAMBIO && cola->size == 0 &&
+            interseccion.calles[NORTE_A_SUR].num == 0 && interseccion.calles[ESTE_A_OESTE].num == 0) {
+            break;
+        }
+        
+        omp_set_lock(&interseccion.lock_sistema);
+        vista->tiempo_actual = e->tiempo;
+        vista->evento_en_curso = *e;
+        omp_unset_lock(&interseccion.lock_sistema);
+        
+        omp_set_lock(&lock_eventos);
+        eventos_procesados++;
+        omp_unset_lock(&lock_eventos);
+        
+        // Protección contra bucles infinitos
+        if (eventos_procesados > vehiculos_previstos * 10000) {
+            printf("ADVERTENCIA: Demasiados eventos procesados. Verificando progreso...\n");
+            break;
+        }
+        
+        if (e->tipo == ENTRADA_NORTE || e->tipo == ENTRADA_ESTE) {
+            if (!procesar_entrada(cola, e, &id_auto[e->direccion], &llegadas_pendientes[e->direccion])) break;
+        }
+        
+        else if (e->tipo == ACTUALIZACION_VEHICULO) {
+            procesar_actualizacion(cola, e);
+        }
+        
+        // CAMBIO DE FASE: publicar la fase nueva, despertar la lista de la zona
+        // de paso y programar el siguiente cambio
+        else if (e->tipo == SEMAFORO_CAMBIO) {
+            double siguiente_cambio = cambiar_fase_semaforo(e->tiempo);
+            despertar_lista_semaforo(cola, e->tiempo);
+            
+            Evento cambio = {
+                .tiempo = siguiente_cambio, .tipo = SEMAFORO_CAMBIO, .direccion = NORTE_A_SUR, .prioridad = 1
+            };
+            insertar_evento_thread_safe(cola, cambio);
+        }
+        
+        // PROCESAR TICK GLOBAL (todos los vehículos en paralelo)
+        else if (e->tipo == TICK) {
+            procesar_tick_interseccion(config.paso_simulacion);
+            
+            Evento siguiente = {.tiempo = e->tiempo + config.paso_simulacion, .tipo = TICK, .direccion = NORTE_A_SUR};
+            insertar_evento_thread_safe(cola, siguiente);
+        }
+        
+        // REPORTES PERIÓDICOS
+        if (vista->tiempo_actual - ultimo_reporte >= PERIODO_REPORTE) {
+            sincronizar_todos();
+            imprimir_estado_interseccion();
+            registrar_estado_interseccion();
+            ultimo_reporte = vista->tiempo_actual;
+            
+            int completados_total = interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo;
+            double porcentaje = (double)completados_total / vehiculos_previstos * 100.0;
+            printf(">>> PROGRESO: %.1f%% completado (%d/%lld vehículos) - Tiempo: %.1fs <<<\n\n", 
+                   porcentaje, completados_total, vehiculos_previstos, vista->tiempo_actual);
+        }
+    }
+}
+
+// ============================================================================
+// PROCESOS LÓGICOS CONSERVADORES
+// ============================================================================
+//
+// MODO_CONSERVADOR reparte la simulación en tres procesos lógicos al estilo
+// Chandy-Misra-Bryant: cada calle, con su propia cola de eventos, sus
+// vehículos y su copia de la fase y la ocupación, y la caja, dueña del plan
+// del semáforo. No hay cola global. Las calles solo se afectan a través de la
+// ocupación de la caja: cada cambio viaja a la caja y de ahí a la otra calle
+// como un mensaje con la clave del evento que lo produjo, y la caja manda los
+// cambios de fase del mismo modo. Los canales son FIFO con claves crecientes,
+// así que un proceso puede procesar un evento propio si su clave es menor que
+// la frontera de su entrada: el primer mensaje pendiente o, sin mensajes, el
+// reloj del canal, la promesa del emisor de no mandar nada anterior. Subir
+// ese reloj hace de mensaje nulo.
+//
+// La promesa de una calle sale de la física. Un vehículo solo cambia la
+// ocupación en la actualización que empieza dentro de la caja (entra) o
+// pasada la caja y cruzando (sale), y en cada paso avanza como mucho
+// velocidad_maxima * paso. Los que ya están en posición dan la clave exacta
+// de su próxima actualización; los de la zona de aproximación y los que
+// cruzan, su próximo paso más los que les faltan; los de antes de la zona,
+// al menos el recorrido de toda la zona desde el próximo evento de la calle.
+// Un vehículo parado ante el rojo no se mueve hasta el próximo cambio de
+// fase, y un mensaje solo despierta a la lista de la zona de paso: con rojo
+// hace falta un cambio de fase. La holgura es de al menos medio paso y los
+// relojes empiezan en el instante 0, así que las promesas siempre avanzan.
+//
+// Los reportes cada PERIODO_REPORTE segundos necesitan el estado de todas las
+// calles en el primer evento que los dispara. Cada ronda procesa en paralelo
+// los eventos anteriores al umbral hasta que no queda trabajo ni mensajes en
+// vuelo; después el thread 0 procesa solo el siguiente evento en el orden
+// global, con la frontera abierta hasta él, reporta y abre la ronda
+// siguiente. Todo sigue el orden de comparar_eventos, así que los CSV de
+// resultados y de la intersección coinciden con los de MODO_EVENTOS. Las
+// trazas de estados de cada calle se retienen durante la ronda y al cerrarla
+// se escriben mezcladas en orden de clave, como en MODO_EVENTOS.
+
+#define PROCESO_CRUCE 2           // Las calles usan su DireccionCalle
+#define NUM_PROCESOS_LOGICOS 3
+#define EVENTOS_POR_PROMESA 64    // Eventos entre promesas de una calle que no se bloquea
+
+#define MENSAJE_OCUPACION 0
+#define MENSAJE_FASE 1
+
+typedef struct {
+    Evento clave;             // Evento que lo produjo: su lugar en el orden global
+    int tipo;                 // MENSAJE_*
+    int delta;                // OCUPACION: vehículos de clave.direccion que entran (+) o salen (-)
+    EstadoInterseccion fase;  // FASE: fase nueva
+} MensajeProceso;
+
+// Canal FIFO de un emisor a un receptor. 'reloj' nunca baja: es la clave del
+// último mensaje o la última promesa. Las calles publican además en su canal
+// hacia la caja el último evento que procesaron y si ya terminaron.
+typedef struct CanalMensajes {
+    MensajeProceso* datos;    // Anillo
+    int capacidad;
+    int inicio;
+    int num;
+    Evento reloj;
+    Evento ultimo;
+    int terminado;
+    long long mensajes;
+    long long promesas;       // Subidas del reloj sin mensaje (mensajes nulos)
+    omp_lock_t lock;
+} CanalMensajes;
+
+// Siguiente cambio de fase que la caja aún no mandó a una calle
+typedef struct {
+    Evento clave;
+    EstadoInterseccion fase;            // Vigente antes del cambio
+    EstadoInterseccion verde_anterior;
+} CursorFases;
+
+typedef struct {
+    int indice;                   // DireccionCalle o PROCESO_CRUCE
+    VistaSimulacion vista;
+    ColaEventos cola;             // Calles
+    CanalMensajes* entrada;       // Calles: desde la caja
+    Evento frontera;              // Frontera de entrada leída por última vez
+    int con_mensaje;              // 'mensaje' es el primero pendiente de la entrada
+    MensajeProceso mensaje;
+    Evento ultimo;                // Último evento propio procesado
+    int id_auto;
+    int llegadas_pendientes;
+    int terminado;
+    double ultimo_cambio_fase;    // Calles: instante del último MENSAJE_FASE aplicado
+    int en_reposo;                // Sin trabajo permitido en la ronda
+    long long eventos;
+    long long mensajes;           // Aplicados (calles) o reenviados (caja)
+    long long bloqueos;           // Pasadas con eventos permitidos pero sin frontera
+    CursorFases envio[2];         // Caja: por calle de destino
+} ProcesoLogico;
+
+ProcesoLogico procesos[NUM_PROCESOS_LOGICOS];
+CanalMensajes canal_hacia_cruce[2];   // Desde cada calle
+CanalMensajes canal_desde_cruce[2];   // Hacia cada calle
+
+// Procesos con trabajo en la ronda más mensajes en vuelo; la ronda termina
+// en cero y, como un proceso en reposo solo despierta al recibir un mensaje
+// (que ya cuenta), una vez en cero no vuelve a subir
+long long trabajo_ronda = 0;
+double ultimo_reporte_procesos = 0.0;
+Evento cota_serial;           // Parte serial de la ronda: clave que se procesa sola
+int con_cota_serial = 0;
+int procesos_abortados = 0;
+int rondas_procesos = 0;
+
+static inline Evento clave_en(double tiempo) {
+    // Precede a todos los eventos de ese instante
+    Evento clave = {tiempo, 0, INT_MAX, NORTE_A_SUR, NULL, 0, -INFINITY};
+    return clave;
+}
+
+// La ronda admite la clave: anterior al umbral del próximo reporte o, en la
+// parte serial, hasta el evento que se procesa solo
+static inline int clave_permitida(const Evento* k) {
+    if (con_cota_serial && comparar_eventos(k, &cota_serial) <= 0) return 1;
+    return k->tiempo - ultimo_reporte_procesos < PERIODO_REPORTE;
+}
+
+static inline int clave_segura(const Evento* k, const Evento* frontera) {
+    if (con_cota_serial && comparar_eventos(k, &cota_serial) <= 0) return 1;
+    return comparar_eventos(k, frontera) < 0;
+}
+
+static inline void sumar_trabajo(long long n) {
+    __atomic_add_fetch(&trabajo_ronda, n, __ATOMIC_ACQ_REL);
+}
+
+// Un proceso en reposo que recibe un mensaje vuelve a tener trabajo antes de
+// que el mensaje deje de contar
+static inline void mensaje_recibido(ProcesoLogico* p) {
+    if (p->en_reposo) {
+        p->en_reposo = 0;
+        sumar_trabajo(1);
+    }
+    sumar_trabajo(-1);
+    p->mensajes++;
+}
+
+static inline void entrar_en_reposo(ProcesoLogico* p) {
+    if (p->en_reposo) return;
+    p->en_reposo = 1;
+    sumar_trabajo(-1);
+}
+
+void iniciar_canal(CanalMensajes* c) {
+    memset(c, 0, sizeof(CanalMensajes));
+    c->reloj = clave_en(0.0);
+    c->ultimo = clave_en(-INFINITY);
+    omp_init_lock(&c->lock);
+}
+
+void destruir_canal(CanalMensajes* c) {
+    omp_destroy_lock(&c->lock);
+    free(c->datos);
+    c->datos = NULL;
+}
+
+void canal_enviar(CanalMensajes* c, const MensajeProceso* m) {
+    sumar_trabajo(1);
+    omp_set_lock(&c->lock);
+    if (c->num == c->capacidad) {
+        int nueva_capacidad = c->capacidad > 0 ? c->capacidad * 2 : 64;
+        MensajeProceso* nuevos = (MensajeProceso*)malloc(nueva_capacidad * sizeof(MensajeProceso));
+        if (!nuevos) {
+            fprintf(stderr, "ERROR: No se pudo ampliar un canal entre procesos lógicos\n");
+            procesos_abortados = 1;
+            omp_unset_lock(&c->lock);
+            return;
+        }
+        for (int k = 0; k < c->num; k++) nuevos[k] = c->datos[(c->inicio + k) % c->capacidad];
+        free(c->datos);
+        c->datos = nuevos;
+        c->capacidad = nueva_capacidad;
+        c->inicio = 0;
+    }
+    c->datos[(c->inicio + c->num) % c->capacidad] = *m;
+    c->num++;
+    if (comparar_eventos(&m->clave, &c->reloj) > 0) c->reloj = m->clave;
+    c->mensajes++;
+    omp_unset_lock(&c->lock);
+}
+
+// Mensaje nulo: sube el reloj del canal si 'clave' es posterior
+void canal_prometer(CanalMensajes* c, const Evento* clave) {
+    omp_set_lock(&c->lock);
+    if (comparar_eventos(clave, &c->reloj) > 0) {
+        c->reloj = *clave;
+        c->promesas++;
+    }
+    omp_unset_lock(&c->lock);
+}
+
+void enviar_especulativo(const MensajeProceso* m);
+
+// Lo llama procesar_actualizacion cuando el vehículo entra o sale de la caja
+void enviar_cambio_ocupacion(const Evento* e, int delta) {
+    MensajeProceso m = {*e, MENSAJE_OCUPACION, delta, NORTE_SUR_VERDE};
+    m.clave.vehiculo = NULL;
+    if (vista->especulativo) {
+        enviar_especulativo(&m);
+    } else {
+        canal_enviar(vista->salida, &m);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Calles
+// ----------------------------------------------------------------------------
+
+// Cota inferior de la clave del próximo cambio de ocupación de la calle
+Evento calcular_promesa(ProcesoLogico* p) {
+    if (p->terminado) return clave_en(INFINITY);
+
+    AlmacenCalle* c = &interseccion.calles[p->indice];
+    double dt = config.paso_simulacion;
+    double inicio_interseccion = config.posicion_interseccion - config.ancho_interseccion/2;
+    double fin_interseccion = config.posicion_interseccion + config.ancho_interseccion/2;
+    double avance_maximo = params.velocidad_maxima * dt * (1.0 + 1e-9);
+    double zona = fmax(0.0, inicio_interseccion - distancia_aproximacion());
+
+    // Lo que no tiene evento despierta por un evento propio o por un mensaje,
+    // y con rojo los mensajes no despiertan a nadie hasta el cambio de fase
+    int verde = (p->indice == NORTE_A_SUR) ? (p->vista.fase == NORTE_SUR_VERDE)
+                                           : (p->vista.fase == ESTE_OESTE_VERDE);
+    double proximo_cambio = p->ultimo_cambio_fase + duracion_fase(p->vista.fase);
+    double base = (verde && p->frontera.tiempo < proximo_cambio) ? p->frontera.tiempo : proximo_cambio;
+    Evento siguiente;
+    if (ver_siguiente_evento(&p->cola, &siguiente) && siguiente.tiempo < base) base = siguiente.tiempo;
+
+    // Los de antes de la zona y los que aún no entraron la recorren entera;
+    // al acabar un tramo libre el vehículo puede estar un paso dentro
+    double pasos_zona = fmax(floor((inicio_interseccion - zona) / avance_maximo) - 1.0, 1.0);
+    Evento promesa = clave_en(base + (pasos_zona - 0.5) * dt);
+
+    for (int i = c->primero; i < c->primero + c->num; i++) {
+        double x = c->posicion[i];
+        int cruzando = (c->estado[i] == CRUZANDO_INTERSECCION);
+        double pasos;
+        if (x > fin_interseccion) {
+            if (!cruzando) continue;
+            pasos = 0.0;
+        } else if (x >= inicio_interseccion) {
+            pasos = cruzando ? 1.0 : 0.0;  // Uno parado dentro vuelve a entrar
+        } else if (x >= zona) {
+            pasos = fmax(floor((inicio_interseccion - x) / avance_maximo), 1.0);
+        } else {
+            break;  // Los siguientes están detrás
+        }
+
+        // Primer paso en el que puede moverse
+        Vehiculo* v = c->vehiculos[i];
+        int sin_evento = (v->espera != ESPERA_NINGUNA && !v->despertar_programado);
+        double desde = sin_evento ? base : v->paso_programado + dt;
+        if (!verde && x < inicio_interseccion && c->velocidad[i] == 0.0 && desde < proximo_cambio) {
+            desde = proximo_cambio;
+        }
+
+        Evento cota;
+        if (pasos == 0.0 && !sin_evento) {
+            Evento paso = {v->paso_programado + dt, ACTUALIZACION_VEHICULO, v->id, v->direccion, v, 0, v->paso_programado};
+            cota = paso;
+        } else {
+            cota = clave_en(desde + (fmax(pasos, 1.0) - 0.5) * dt);
+        }
+        if (comparar_eventos(&cota, &promesa) < 0) promesa = cota;
+    }
+    return promesa;
+}
+
+// Publica en el canal hacia la caja la promesa, el último evento y el fin
+void publicar_promesa(ProcesoLogico* p) {
+    Evento promesa = calcular_promesa(p);
+    CanalMensajes* c = p->vista.salida;
+    omp_set_lock(&c->lock);
+    if (comparar_eventos(&promesa, &c->reloj) > 0) {
+        c->reloj = promesa;
+        c->promesas++;
+    }
+    c->ultimo = p->ultimo;
+    c->terminado = p->terminado;
+    omp_unset_lock(&c->lock);
+}
+
+void leer_entrada(ProcesoLogico* p) {
+    CanalMensajes* c = p->entrada;
+    omp_set_lock(&c->lock);
+    p->con_mensaje = (c->num > 0);
+    if (p->con_mensaje) {
+        p->mensaje = c->datos[c->inicio];
+        p->frontera = p->mensaje.clave;
+    } else {
+        p->frontera = c->reloj;
+    }
+    omp_unset_lock(&c->lock);
+}
+
+// Aplica en su instante un cambio de fase o de ocupación de la otra calle
+void aplicar_mensaje(ProcesoLogico* p, const MensajeProceso* m) {
+    vista->tiempo_actual = m->clave.tiempo;
+    vista->evento_en_curso = m->clave;
+
+    if (m->tipo == MENSAJE_FASE) {
+        vista->fase = m->fase;
+        p->ultimo_cambio_fase = m->clave.tiempo;
+        despertar_lista_semaforo(&p->cola, m->clave.tiempo);
+        return;
+    }
+
+    PalabraOcupacion previa = vista->ocupacion;
+    PalabraOcupacion nueva = modificar_ocupacion(m->clave.direccion, m->delta);
+    if (vista->en_espera && (ocupacion_total(nueva) != ocupacion_total(previa) ||
+                             ocupacion_direccion(nueva) != ocupacion_direccion(previa))) {
+        revisar_lista_ocupacion(&p->cola);
+    }
+}
+
+// Saca el primer mensaje de la entrada y lo aplica
+void aplicar_mensaje_calle(ProcesoLogico* p) {
+    CanalMensajes* c = p->entrada;
+    MensajeProceso m = p->mensaje;
+    omp_set_lock(&c->lock);
+    c->inicio = (c->inicio + 1) % c->capacidad;
+    c->num--;
+    omp_unset_lock(&c->lock);
+    p->con_mensaje = 0;
+    mensaje_recibido(p);
+    aplicar_mensaje(p, &m);
+}
+
+void procesar_evento_calle(ProcesoLogico* p, const Evento* e) {
+    vista->tiempo_actual = e->tiempo;
+    vista->evento_en_curso = *e;
+    p->eventos++;
+    p->ultimo = *e;
+
+    if (e->tipo == ACTUALIZACION_VEHICULO) {
+        procesar_actualizacion(&p->cola, e);
+    } else if (!procesar_entrada(&p->cola, e, &p->id_auto, &p->llegadas_pendientes)) {
+        procesos_abortados = 1;
+    }
+    p->terminado = !p->llegadas_pendientes && interseccion.calles[p->indice].num == 0;
+}
+
+// Procesa lo que permiten la frontera y la ronda; devuelve 1 si avanzó
+int avanzar_calle(ProcesoLogico* p) {
+    int progreso = 0, bloqueado = 0, desde_promesa = 0;
+    Evento e;
+
+    while (!procesos_abortados) {
+        int hay = ver_siguiente_evento(&p->cola, &e);
+        if (!p->con_mensaje && (!hay || !clave_permitida(&e) || !clave_segura(&e, &p->frontera))) {
+            leer_entrada(p);
+        }
+
+        // Los mensajes anteriores al próximo evento propio van primero
+        if (p->con_mensaje && clave_permitida(&p->mensaje.clave) &&
+            (!hay || comparar_eventos(&p->mensaje.clave, &e) < 0)) {
+            aplicar_mensaje_calle(p);
+            progreso = 1;
+            continue;
+        }
+
+        if (!hay || !clave_permitida(&e)) break;
+        if (!clave_segura(&e, &p->frontera)) {
+            bloqueado = 1;
+            break;
+        }
+
+        obtener_siguiente_evento_thread_safe(&p->cola, &e);
+        procesar_evento_calle(p, &e);
+        progreso = 1;
+        if (++desde_promesa == EVENTOS_POR_PROMESA) {
+            publicar_promesa(p);
+            desde_promesa = 0;
+        }
+    }
+
+    publicar_promesa(p);
+    if (bloqueado) {
+        p->bloqueos++;
+    } else {
+        entrar_en_reposo(p);
+    }
+    return progreso;
+}
+
+// ----------------------------------------------------------------------------
+// Caja
+// ----------------------------------------------------------------------------
+
+static inline Evento clave_cambio(double tiempo, double origen) {
+    Evento cambio = {tiempo, SEMAFORO_CAMBIO, 0, NORTE_A_SUR, NULL, 1, origen};
+    return cambio;
+}
+
+// Mensaje del cambio de fase al que apunta el cursor; lo avanza al siguiente
+MensajeProceso avanzar_cursor_fases(CursorFases* f) {
+    EstadoInterseccion nueva = fase_siguiente(f->fase, f->verde_anterior);
+    MensajeProceso m = {f->clave, MENSAJE_FASE, 0, nueva};
+    if (nueva != TRANSICION) f->verde_anterior = nueva;
+    f->fase = nueva;
+    f->clave = clave_cambio(f->clave.tiempo + duracion_fase(nueva), f->clave.tiempo);
+    return m;
+}
+
+// Manda a la calle 'd' los cambios de fase anteriores a 'limite'
+int enviar_fases(ProcesoLogico* p, DireccionCalle d, const Evento* limite) {
+    int enviados = 0;
+    CursorFases* f = &p->envio[d];
+    while (clave_permitida(&f->clave) && clave_segura(&f->clave, limite)) {
+        MensajeProceso m = avanzar_cursor_fases(f);
+        canal_enviar(&canal_desde_cruce[d], &m);
+        enviados++;
+    }
+    return enviados;
+}
+
+// Aplica al semáforo global los cambios anteriores a 'ultimo' (la simulación
+// siguió después de ellos) y, en la parte serial, hasta la cota
+int aplicar_cambios_semaforo(ProcesoLogico* p, const Evento* ultimo) {
+    int aplicados = 0;
+    Evento cambio = clave_cambio(semaforo.proximo_cambio, semaforo.ultimo_cambio);
+    while (comparar_eventos(&cambio, ultimo) < 0 ||
+           (con_cota_serial && comparar_eventos(&cambio, &cota_serial) <= 0)) {
+        vista->tiempo_actual = cambio.tiempo;
+        vista->evento_en_curso = cambio;
+        cambiar_fase_semaforo(cambio.tiempo);
+        p->eventos++;
+        p->ultimo = cambio;
+        aplicados++;
+        cambio = clave_cambio(semaforo.proximo_cambio, semaforo.ultimo_cambio);
+    }
+    return aplicados;
+}
+
+// Reenvía los cambios de ocupación de cada calle a la otra, intercalados con
+// los cambios de fase en orden de clave, y aplica al semáforo los cambios que
+// alguna calle ya dejó atrás
+int avanzar_cruce(ProcesoLogico* p) {
+    int progreso = 0;
+    Evento frontera[2];
+    Evento ultimo = clave_en(-INFINITY);
+
+    for (int s = NORTE_A_SUR; s <= ESTE_A_OESTE; s++) {
+        DireccionCalle otra = (s == NORTE_A_SUR) ? ESTE_A_OESTE : NORTE_A_SUR;
+        CanalMensajes* c = &canal_hacia_cruce[s];
+        omp_set_lock(&c->lock);
+        while (c->num > 0) {
+            MensajeProceso m = c->datos[c->inicio];
+            progreso |= enviar_fases(p, otra, &m.clave);
+            canal_enviar(&canal_desde_cruce[otra], &m);
+            c->inicio = (c->inicio + 1) % c->capacidad;
+            c->num--;
+            mensaje_recibido(p);
+            progreso = 1;
+        }
+        frontera[s] = c->reloj;
+        if (comparar_eventos(&c->ultimo, &ultimo) > 0) ultimo = c->ultimo;
+        omp_unset_lock(&c->lock);
+    }
+
+    // Promesa a cada calle: ni reenvíos antes de la frontera de la otra ni
+    // fases antes de la que falta mandarle
+    int pendiente = 0;
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        const Evento* limite = &frontera[(d == NORTE_A_SUR) ? ESTE_A_OESTE : NORTE_A_SUR];
+        progreso |= enviar_fases(p, d, limite);
+        canal_prometer(&canal_desde_cruce[d],
+                       (comparar_eventos(limite, &p->envio[d].clave) < 0) ? limite : &p->envio[d].clave);
+        if (clave_permitida(&p->envio[d].clave)) pendiente = 1;
+    }
+
+    // Un cambio de fase cuenta si la simulación siguió después de él
+    if (aplicar_cambios_semaforo(p, &ultimo) > 0) progreso = 1;
+
+    if (pendiente) {
+        p->bloqueos++;
+    } else {
+        entrar_en_reposo(p);
+    }
+    return progreso;
+}
+
+// ============================================================================
+// TIME WARP OPTIMISTA
+// ============================================================================
+//
+// MODO_OPTIMISTA usa las mismas calles, canales, rondas y reportes que
+// MODO_CONSERVADOR, pero una calle no espera a su frontera: procesa en orden
+// de clave sus eventos, los mensajes que le llegaron y su propia copia del
+// plan del semáforo, que no depende del tráfico, así que no hace falta la
+// caja. Cada calle escribe sus cambios de ocupación directamente en el canal
+// que lee la otra. Un mensaje con clave anterior al último elemento procesado
+// (rezagado) obliga a volver atrás: se restaura la última copia de estado
+// anterior a él y se reejecuta hasta su clave sin volver a enviar ni retener
+// nada, porque eso ya salió.
+//
+// Las copias de estado se toman cada EVENTOS_POR_COPIA elementos y son
+// incrementales: un vehículo que no cambió desde la copia anterior comparte
+// su registro con ella (copia en escritura comparando el contenido). La cola
+// de eventos, la vista y los contadores de la calle se copian enteros.
+//
+// Lo enviado se anula en forma perezosa: al volver atrás queda pendiente y,
+// al reejecutar, el mensaje que se vuelve a generar igual se confirma sin
+// reenviarlo; solo lo que ya no se genera sale como antimensaje
+// (MENSAJE_ANULACION). El antimensaje de algo ya procesado también obliga a
+// volver atrás.
+//
+// Las trazas, los resúmenes de los que salen y los vehículos que vuelven al
+// pool esperan al GVT. Cuando una ronda termina no hay mensajes en vuelo ni
+// trabajo permitido, así que todo lo procesado es definitivo y el GVT es el
+// umbral de la ronda: ahí se escriben las salidas retenidas de las dos
+// calles en orden de clave y se liberan las copias (fossil collection),
+// salvo una base con el estado actual. Dentro de la ronda una calle no pasa
+// de VENTANA_OPTIMISTA segundos por delante del próximo elemento de la otra,
+// para acotar lo que se deshace.
+
+#define MENSAJE_ANULACION 2       // Antimensaje: anula el mensaje de la misma clave
+#define EVENTOS_POR_COPIA 64      // Elementos entre copias de estado
+#define VENTANA_OPTIMISTA 0.5     // Segundos que una calle puede adelantarse a la otra
+
+// Elementos que procesa una calle optimista
+#define ELEMENTO_NINGUNO 0
+#define ELEMENTO_EVENTO 1
+#define ELEMENTO_MENSAJE 2
+#define ELEMENTO_FASE 3
+
+// Registro de un vehículo en una copia de estado; lo comparten las copias
+// seguidas en las que no cambió. La comparación cubre desde 'datos' al final.
+typedef struct {
+    Vehiculo* vehiculo;           // Vehículo vivo al que se restaura
+    int referencias;
+    Vehiculo datos;
+    double posicion;
+    double velocidad;
+    double aceleracion;
+    double pub_posicion;
+    double pub_velocidad;
+    double pub_aceleracion;
+    int estado;
+    int pub_estado;
+} CopiaVehiculo;
+
+typedef struct {
+    Evento clave;                 // Último elemento procesado al tomarla
+    long long elementos;
+    VistaSimulacion vista;
+    EntradaHeap* eventos;         // El heap tal cual
+    int num_eventos;
+    unsigned long long secuencia;
+    CursorFases fases;
+    Evento ultimo;
+    long long procesados;         // ProcesoLogico.eventos
+    int id_auto;
+    int llegadas_pendientes;
+    int terminado;
+    double ultimo_cambio_fase;
+    int creados;
+    int completados;
+    CopiaVehiculo** vehiculos;    // En el orden de la calle
+    int num_vehiculos;
+} CopiaEstado;
+
+typedef struct {
+    Evento clave;
+    FilaEstado fila;
+} FilaRetenida;
+
+typedef struct {
+    Evento clave;
+    Vehiculo datos;               // Lo que necesita emitir_resumen
+} ResumenRetenido;
+
+typedef struct {
+    Evento clave;
+    Vehiculo* vehiculo;
+} VehiculoRetenido;
+
+typedef struct EstadoOptimista {
+    ProcesoLogico* proceso;
+    CursorFases fases;            // Próximo cambio del plan del semáforo
+    Evento lvt;                   // Último elemento procesado
+    long long elementos;          // Elementos procesados en la historia vigente
+    int reejecutando;             // Al volver atrás: ni envíos ni salidas
+    int desde_copia;
+    double horizonte;             // Tiempo del próximo elemento; INFINITY sin trabajo
+
+    // Recibidos en orden de clave; [0, procesadas) ya están aplicados
+    MensajeProceso* entradas;
+    int num_entradas, cap_entradas, procesadas;
+    // Enviados en la historia vigente, en orden de clave
+    MensajeProceso* enviados;
+    int num_enviados, cap_enviados;
+    // Enviados antes de volver atrás que la reejecución aún no confirmó;
+    // siempre posteriores a lvt
+    MensajeProceso* pendientes;
+    int num_pendientes, cap_pendientes;
+
+    CopiaEstado* copias;          // En orden de clave; la primera es la base
+    int num_copias, cap_copias;
+
+    FilaRetenida* filas;
+    int num_filas, cap_filas;
+    ResumenRetenido* resumenes;
+    int num_resumenes, cap_resumenes;
+    VehiculoRetenido* salidos;
+    int num_salidos, cap_salidos;
+
+    long long procesados_total;   // Incluidos los deshechos y los reejecutados
+    long long rezagados;
+    long long vueltas_atras;
+    long long deshechos;
+    long long reejecutados;
+    long long antimensajes;
+    long long anulados;           // Antimensajes recibidos
+    long long confirmados;        // Reenvíos evitados por la anulación perezosa
+    long long esperas;            // Pasadas detenidas por la ventana
+    long long copias_tomadas;
+    long long registros_copiados;
+    long long registros_compartidos;
+} EstadoOptimista;
+
+EstadoOptimista optimistas[2];
+
+// Garantiza sitio para 'necesarios' elementos en un array dinámico
+static int reservar(void** datos, int necesarios, int* capacidad, size_t tam) {
+    if (necesarios <= *capacidad) return 1;
+    int nueva = (*capacidad > 0) ? *capacidad : 64;
+    while (nueva < necesarios) nueva *= 2;
+    void* nuevos = realloc(*datos, (size_t)nueva * tam);
+    if (!nuevos) {
+        fprintf(stderr, "ERROR: Sin memoria para el estado de los procesos lógicos\n");
+        procesos_abortados = 1;
+        return 0;
+    }
+    *datos = nuevos;
+    *capacidad = nueva;
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+// Copias de estado
+// ----------------------------------------------------------------------------
+
+void liberar_copia(CopiaEstado* s) {
+    for (int j = 0; j < s->num_vehiculos; j++) {
+        if (--s->vehiculos[j]->referencias == 0) free(s->vehiculos[j]);
+    }
+    free(s->vehiculos);
+    free(s->eventos);
+    memset(s, 0, sizeof(CopiaEstado));
+}
+
+void tomar_copia(EstadoOptimista* o) {
+    o->desde_copia = 0;
+    if (!reservar((void**)&o->copias, o->num_copias + 1, &o->cap_copias, sizeof(CopiaEstado))) return;
+
+    ProcesoLogico* p = o->proceso;
+    AlmacenCalle* c = &interseccion.calles[p->indice];
+    CopiaEstado* anterior = (o->num_copias > 0) ? &o->copias[o->num_copias - 1] : NULL;
+    CopiaEstado* s = &o->copias[o->num_copias];
+    memset(s, 0, sizeof(CopiaEstado));
+
+    s->eventos = (EntradaHeap*)malloc((p->cola.size + 1) * sizeof(EntradaHeap));
+    s->vehiculos = (CopiaVehiculo**)malloc((c->num + 1) * sizeof(CopiaVehiculo*));
+    if (!s->eventos || !s->vehiculos) {
+        fprintf(stderr, "ERROR: Sin memoria para una copia de estado\n");
+        free(s->eventos);
+        free(s->vehiculos);
+        procesos_abortados = 1;
+        return;
+    }
+
+    s->clave = o->lvt;
+    s->elementos = o->elementos;
+    s->vista = p->vista;
+    memcpy(s->eventos, p->cola.datos, p->cola.size * sizeof(EntradaHeap));
+    s->num_eventos = p->cola.size;
+    s->secuencia = p->cola.siguiente_secuencia;
+    s->fases = o->fases;
+    s->ultimo = p->ultimo;
+    s->procesados = p->eventos;
+    s->id_auto = p->id_auto;
+    s->llegadas_pendientes = p->llegadas_pendientes;
+    s->terminado = p->terminado;
+    s->ultimo_cambio_fase = p->ultimo_cambio_fase;
+    s->creados = (p->indice == NORTE_A_SUR) ? interseccion.total_vehiculos_creados_ns
+                                            : interseccion.total_vehiculos_creados_eo;
+    s->completados = (p->indice == NORTE_A_SUR) ? interseccion.total_vehiculos_completados_ns
+                                                : interseccion.total_vehiculos_completados_eo;
+
+    // La calle y la copia anterior están en orden de id
+    size_t comparado = sizeof(CopiaVehiculo) - offsetof(CopiaVehiculo, datos);
+    int j = 0;
+    for (int i = c->primero; i < c->primero + c->num; i++) {
+        CopiaVehiculo nueva;
+        memset(&nueva, 0, sizeof(nueva));
+        nueva.vehiculo = c->vehiculos[i];
+        memcpy(&nueva.datos, c->vehiculos[i], sizeof(Vehiculo));
+        nueva.posicion = c->posicion[i];
+        nueva.velocidad = c->velocidad[i];
+        nueva.aceleracion = c->aceleracion[i];
+        nueva.pub_posicion = c->pub_posicion[i];
+        nueva.pub_velocidad = c->pub_velocidad[i];
+        nueva.pub_aceleracion = c->pub_aceleracion[i];
+        nueva.estado = c->estado[i];
+        nueva.pub_estado = c->pub_estado[i];
+
+        while (anterior && j < anterior->num_vehiculos && anterior->vehiculos[j]->datos.id < nueva.datos.id) j++;
+        CopiaVehiculo* r;
+        if (anterior && j < anterior->num_vehiculos && anterior->vehiculos[j]->vehiculo == nueva.vehiculo &&
+            memcmp(&anterior->vehiculos[j]->datos, &nueva.datos, comparado) == 0) {
+            r = anterior->vehiculos[j];
+            r->referencias++;
+            o->registros_compartidos++;
+        } else {
+            r = (CopiaVehiculo*)malloc(sizeof(CopiaVehiculo));
+            if (!r) {
+                fprintf(stderr, "ERROR: Sin memoria para una copia de estado\n");
+                procesos_abortados = 1;
+                liberar_copia(s);
+                return;
+            }
+            memcpy(r, &nueva, sizeof(CopiaVehiculo));
+            r->referencias = 1;
+            o->registros_copiados++;
+        }
+        s->vehiculos[s->num_vehiculos++] = r;
+    }
+
+    o->num_copias++;
+    o->copias_tomadas++;
+}
+
+// Un vehículo creado en la historia deshecha
+static void liberar_especulativo(Vehiculo* v) {
+    v->en_lista_espera = 0;
+    devolver_vehiculo(v);
+}
+
+// Deja la calle como estaba al tomar la copia k y descarta las posteriores
+void restaurar_copia(EstadoOptimista* o, int k) {
+    ProcesoLogico* p = o->proceso;
+    AlmacenCalle* c = &interseccion.calles[p->indice];
+    CopiaEstado* s = &o->copias[k];
+
+    // Los creados después de la copia vuelven al pool; los que salieron
+    // después y ya existían vuelven a la calle con ella
+    for (int i = c->primero; i < c->primero + c->num; i++) {
+        if (c->vehiculos[i]->id >= s->id_auto) liberar_especulativo(c->vehiculos[i]);
+    }
+    while (o->num_salidos > 0 && comparar_eventos(&o->salidos[o->num_salidos - 1].clave, &s->clave) > 0) {
+        Vehiculo* v = o->salidos[--o->num_salidos].vehiculo;
+        if (v->id >= s->id_auto) liberar_especulativo(v);
+    }
+
+    int fin_anterior = c->primero + c->num;
+    for (int j = 0; j < s->num_vehiculos; j++) {
+        CopiaVehiculo* r = s->vehiculos[j];
+        Vehiculo* v = r->vehiculo;
+        memcpy(v, &r->datos, sizeof(Vehiculo));
+        v->indice = j;
+        c->vehiculos[j] = v;
+        c->posicion[j] = r->posicion;
+        c->velocidad[j] = r->velocidad;
+        c->aceleracion[j] = r->aceleracion;
+        c->pub_posicion[j] = r->pub_posicion;
+        c->pub_velocidad[j] = r->pub_velocidad;
+        c->pub_aceleracion[j] = r->pub_aceleracion;
+        c->estado[j] = r->estado;
+        c->pub_estado[j] = r->pub_estado;
+    }
+    for (int j = s->num_vehiculos; j < fin_anterior; j++) c->vehiculos[j] = NULL;
+    c->primero = 0;
+    c->num = s->num_vehiculos;
+
+    // La cola y el almacén nunca se achican: caben
+    memcpy(p->cola.datos, s->eventos, s->num_eventos * sizeof(EntradaHeap));
+    p->cola.size = s->num_eventos;
+    p->cola.siguiente_secuencia = s->secuencia;
+
+    p->vista = s->vista;
+    o->fases = s->fases;
+    p->ultimo = s->ultimo;
+    p->eventos = s->procesados;
+    p->id_auto = s->id_auto;
+    p->llegadas_pendientes = s->llegadas_pendientes;
+    p->terminado = s->terminado;
+    p->ultimo_cambio_fase = s->ultimo_cambio_fase;
+    if (p->indice == NORTE_A_SUR) {
+        interseccion.total_vehiculos_creados_ns = s->creados;
+        interseccion.total_vehiculos_completados_ns = s->completados;
+    } else {
+        interseccion.total_vehiculos_creados_eo = s->creados;
+        interseccion.total_vehiculos_completados_eo = s->completados;
+    }
+
+    o->lvt = s->clave;
+    o->elementos = s->elementos;
+    while (o->procesadas > 0 && comparar_eventos(&o->entradas[o->procesadas - 1].clave, &s->clave) > 0) {
+        o->procesadas--;
+    }
+
+    for (int j = k + 1; j < o->num_copias; j++) liberar_copia(&o->copias[j]);
+    o->num_copias = k + 1;
+    o->desde_copia = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Salidas retenidas y envíos
+// ----------------------------------------------------------------------------
+
+void retener_estado(const AlmacenCalle* c, int i) {
+    EstadoOptimista* o = vista->especulativo;
+    if (!trazas_abiertas || o->reejecutando) return;
+    if (!reservar((void**)&o->filas, o->num_filas + 1, &o->cap_filas, sizeof(FilaRetenida))) return;
+    FilaRetenida* r = &o->filas[o->num_filas++];
+    r->clave = vista->evento_en_curso;
+    r->fila = fila_estado_vehiculo(c, i);
+}
+
+void retener_resumen(const Vehiculo* v) {
+    EstadoOptimista* o = vista->especulativo;
+    if (o->reejecutando) return;
+    if (!reservar((void**)&o->resumenes, o->num_resumenes + 1, &o->cap_resumenes, sizeof(ResumenRetenido))) return;
+    ResumenRetenido* r = &o->resumenes[o->num_resumenes++];
+    r->clave = vista->evento_en_curso;
+    r->datos = *v;
+}
+
+// El vehículo ya salió; vuelve al pool en el GVT. No depende de reejecutar:
+// restaurar_copia descarta los retenidos después de la copia.
+void retener_vehiculo(Vehiculo* v) {
+    EstadoOptimista* o = vista->especulativo;
+    desenganchar_espera(v);
+    if (!reservar((void**)&o->salidos, o->num_salidos + 1, &o->cap_salidos, sizeof(VehiculoRetenido))) return;
+    o->salidos[o->num_salidos].clave = vista->evento_en_curso;
+    o->salidos[o->num_salidos].vehiculo = v;
+    o->num_salidos++;
+}
+
+void enviar_antimensaje(EstadoOptimista* o, const MensajeProceso* m) {
+    MensajeProceso anulacion = *m;
+    anulacion.tipo = MENSAJE_ANULACION;
+    canal_enviar(o->proceso->vista.salida, &anulacion);
+    o->antimensajes++;
+}
+
+// Anula los pendientes anteriores a 'clave' (o hasta ella, inclusive): la
+// reejecución ya pasó por ahí sin volver a generarlos
+void resolver_pendientes(EstadoOptimista* o, const Evento* clave, int inclusive) {
+    int n = 0;
+    while (n < o->num_pendientes) {
+        int orden = comparar_eventos(&o->pendientes[n].clave, clave);
+        if (orden > 0 || (orden == 0 && !inclusive)) break;
+        enviar_antimensaje(o, &o->pendientes[n]);
+        n++;
+    }
+    if (n > 0) {
+        o->num_pendientes -= n;
+        memmove(o->pendientes, &o->pendientes[n], o->num_pendientes * sizeof(MensajeProceso));
+    }
+}
+
+// Cambio de ocupación generado por el elemento en curso
+void enviar_especulativo(const MensajeProceso* m) {
+    EstadoOptimista* o = vista->especulativo;
+    if (o->reejecutando) return;
+    if (!reservar((void**)&o->enviados, o->num_enviados + 1, &o->cap_enviados, sizeof(MensajeProceso))) return;
+    o->enviados[o->num_enviados++] = *m;
+
+    // El mismo que se había enviado antes de volver atrás sigue valiendo
+    if (o->num_pendientes > 0 && comparar_eventos(&o->pendientes[0].clave, &m->clave) == 0) {
+        MensajeProceso previo = o->pendientes[0];
+        o->num_pendientes--;
+        memmove(o->pendientes, &o->pendientes[1], o->num_pendientes * sizeof(MensajeProceso));
+        if (previo.delta == m->delta) {
+            o->confirmados++;
+            return;
+        }
+        enviar_antimensaje(o, &previo);
+    }
+    canal_enviar(o->proceso->vista.salida, m);
+}
+
+// ----------------------------------------------------------------------------
+// Calles optimistas
+// ----------------------------------------------------------------------------
+
+// Siguiente elemento de la calle en orden de clave: evento propio, mensaje
+// recibido o cambio del plan del semáforo
+int siguiente_elemento(EstadoOptimista* o, Evento* clave) {
+    int tipo = ELEMENTO_FASE;
+    *clave = o->fases.clave;
+    Evento e;
+    if (ver_siguiente_evento(&o->proceso->cola, &e) && comparar_eventos(&e, clave) < 0) {
+        *clave = e;
+        tipo = ELEMENTO_EVENTO;
+    }
+    if (o->procesadas < o->num_entradas && comparar_eventos(&o->entradas[o->procesadas].clave, clave) < 0) {
+        *clave = o->entradas[o->procesadas].clave;
+        tipo = ELEMENTO_MENSAJE;
+    }
+    return tipo;
+}
+
+void procesar_elemento(EstadoOptimista* o, int tipo, const Evento* clave) {
+    ProcesoLogico* p = o->proceso;
+    resolver_pendientes(o, clave, 0);
+    if (tipo == ELEMENTO_EVENTO) {
+        Evento e;
+        obtener_siguiente_evento_thread_safe(&p->cola, &e);
+        procesar_evento_calle(p, &e);
+    } else if (tipo == ELEMENTO_MENSAJE) {
+        MensajeProceso m = o->entradas[o->procesadas++];
+        aplicar_mensaje(p, &m);
+    } else {
+        MensajeProceso m = avanzar_cursor_fases(&o->fases);
+        aplicar_mensaje(p, &m);
+    }
+    resolver_pendientes(o, clave, 1);
+
+    o->lvt = *clave;
+    o->elementos++;
+    o->procesados_total++;
+    if (++o->desde_copia >= EVENTOS_POR_COPIA) tomar_copia(o);
+}
+
+// Deshace lo procesado desde 'clave' (inclusive) y reejecuta lo anterior
+void volver_atras(EstadoOptimista* o, const Evento* clave) {
+    if (comparar_eventos(&o->lvt, clave) < 0) return;
+    o->vueltas_atras++;
+    long long elementos_previos = o->elementos;
+
+    // La base es anterior a todo lo que puede llegar
+    int k = o->num_copias - 1;
+    while (k > 0 && comparar_eventos(&o->copias[k].clave, clave) >= 0) k--;
+    restaurar_copia(o, k);
+
+    // Lo enviado desde la clave queda pendiente; es anterior a lo que ya lo estaba
+    int desde = o->num_enviados;
+    while (desde > 0 && comparar_eventos(&o->enviados[desde - 1].clave, clave) >= 0) desde--;
+    int mover = o->num_enviados - desde;
+    if (mover > 0 && reservar((void**)&o->pendientes, o->num_pendientes + mover,
+                              &o->cap_pendientes, sizeof(MensajeProceso))) {
+        memmove(&o->pendientes[mover], o->pendientes, o->num_pendientes * sizeof(MensajeProceso));
+        memcpy(o->pendientes, &o->enviados[desde], mover * sizeof(MensajeProceso));
+        o->num_pendientes += mover;
+        o->num_enviados = desde;
+    }
+
+    while (o->num_filas > 0 && comparar_eventos(&o->filas[o->num_filas - 1].clave, clave) >= 0) o->num_filas--;
+    while (o->num_resumenes > 0 && comparar_eventos(&o->resumenes[o->num_resumenes - 1].clave, clave) >= 0) {
+        o->num_resumenes--;
+    }
+
+    // Hasta la clave todo sale igual que antes
+    long long desde_copia = o->elementos;
+    o->reejecutando = 1;
+    Evento siguiente;
+    int tipo;
+    while (!procesos_abortados && (tipo = siguiente_elemento(o, &siguiente)) != ELEMENTO_NINGUNO &&
+           comparar_eventos(&siguiente, clave) < 0) {
+        procesar_elemento(o, tipo, &siguiente);
+    }
+    o->reejecutando = 0;
+
+    o->reejecutados += o->elementos - desde_copia;
+    o->deshechos += elementos_previos - o->elementos;
+}
+
+static int buscar_entrada(const EstadoOptimista* o, const Evento* clave) {
+    for (int k = o->num_entradas - 1; k >= 0; k--) {
+        if (comparar_eventos(&o->entradas[k].clave, clave) == 0) return k;
+    }
+    return -1;
+}
+
+// Pasa lo que llegó por el canal a la lista ordenada de entradas
+int recibir_mensajes(EstadoOptimista* o) {
+    ProcesoLogico* p = o->proceso;
+    CanalMensajes* c = p->entrada;
+    int recibidos = 0;
+    while (!procesos_abortados) {
+        omp_set_lock(&c->lock);
+        if (c->num == 0) {
+            omp_unset_lock(&c->lock);
+            break;
+        }
+        MensajeProceso m = c->datos[c->inicio];
+        c->inicio = (c->inicio + 1) % c->capacidad;
+        c->num--;
+        omp_unset_lock(&c->lock);
+        mensaje_recibido(p);
+        recibidos++;
+
+        if (m.tipo == MENSAJE_ANULACION) {
+            // FIFO: el original ya llegó
+            o->anulados++;
+            int k = buscar_entrada(o, &m.clave);
+            if (k < 0) continue;
+            if (k < o->procesadas) volver_atras(o, &m.clave);
+            o->num_entradas--;
+            memmove(&o->entradas[k], &o->entradas[k + 1], (o->num_entradas - k) * sizeof(MensajeProceso));
+            continue;
+        }
+
+        if (comparar_eventos(&m.clave, &o->lvt) < 0) {
+            o->rezagados++;
+            volver_atras(o, &m.clave);
+        }
+        if (!reservar((void**)&o->entradas, o->num_entradas + 1, &o->cap_entradas, sizeof(MensajeProceso))) break;
+        int k = o->num_entradas;
+        while (k > o->procesadas && comparar_eventos(&o->entradas[k - 1].clave, &m.clave) > 0) {
+            o->entradas[k] = o->entradas[k - 1];
+            k--;
+        }
+        o->entradas[k] = m;
+        o->num_entradas++;
+    }
+    return recibidos;
+}
+
+static inline void publicar_horizonte(EstadoOptimista* o, double tiempo) {
+    __atomic_store(&o->horizonte, &tiempo, __ATOMIC_RELEASE);
+}
+
+static inline double leer_horizonte(EstadoOptimista* o) {
+    double tiempo;
+    __atomic_load(&o->horizonte, &tiempo, __ATOMIC_ACQUIRE);
+    return tiempo;
+}
+
+// Procesa lo que permite la ronda sin esperar a la otra calle más que por
+// la ventana; devuelve 1 si avanzó
+int avanzar_calle_optimista(ProcesoLogico* p) {
+    EstadoOptimista* o = &optimistas[p->indice];
+    EstadoOptimista* otra = &optimistas[(p->indice == NORTE_A_SUR) ? ESTE_A_OESTE : NORTE_A_SUR];
+    int progreso = recibir_mensajes(o) > 0;
+    int hechos = 0;
+
+    while (!procesos_abortados) {
+        Evento clave;
+        int tipo = siguiente_elemento(o, &clave);
+        if (tipo == ELEMENTO_NINGUNO || !clave_permitida(&clave)) break;
+
+        if (!con_cota_serial &&
+            clave.tiempo > leer_horizonte(otra) + VENTANA_OPTIMISTA) {
+            publicar_horizonte(o, clave.tiempo);
+            o->esperas++;
+            return progreso;
+        }
+
+        procesar_elemento(o, tipo, &clave);
+        progreso = 1;
+        if (++hechos == EVENTOS_POR_PROMESA) {
+            hechos = 0;
+            publicar_horizonte(o, clave.tiempo);
+            recibir_mensajes(o);
+        }
+    }
+
+    // Todo lo permitido está hecho: lo pendiente que cae en la ronda ya no
+    // se va a generar
+    while (o->num_pendientes > 0 && clave_permitida(&o->pendientes[0].clave)) {
+        resolver_pendientes(o, &o->pendientes[0].clave, 1);
+    }
+    publicar_horizonte(o, INFINITY);
+    entrar_en_reposo(p);
+    return progreso;
+}
+
+// ----------------------------------------------------------------------------
+// GVT
+// ----------------------------------------------------------------------------
+
+// Mezcla las trazas retenidas de las dos calles, cada una ya en orden de
+// clave, y las escribe en ese orden
+void escribir_filas_retenidas(const FilaRetenida* ns, int num_ns, const FilaRetenida* eo, int num_eo) {
+    int i = 0, j = 0;
+    while (i < num_ns || j < num_eo) {
+        int de_ns = (j == num_eo) || (i < num_ns && comparar_eventos(&ns[i].clave, &eo[j].clave) < 0);
+        escribir_fila_estado(de_ns ? &ns[i++].fila : &eo[j++].fila);
+    }
+}
+
+// Fossil collection con todo lo procesado ya definitivo: escribe las salidas
+// retenidas (las trazas de las dos calles en orden de clave), devuelve al
+// pool los que salieron y libera las copias. Quien sigue simulando toma
+// después una base con el estado actual.
+void confirmar_optimistas() {
+    escribir_filas_retenidas(optimistas[NORTE_A_SUR].filas, optimistas[NORTE_A_SUR].num_filas,
+                             optimistas[ESTE_A_OESTE].filas, optimistas[ESTE_A_OESTE].num_filas);
+
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        EstadoOptimista* o = &optimistas[d];
+        o->num_filas = 0;
+        for (int k = 0; k < o->num_resumenes; k++) emitir_resumen(&o->resumenes[k].datos);
+        o->num_resumenes = 0;
+        for (int k = 0; k < o->num_salidos; k++) devolver_vehiculo(o->salidos[k].vehiculo);
+        o->num_salidos = 0;
+
+        o->num_entradas -= o->procesadas;
+        memmove(o->entradas, &o->entradas[o->procesadas], o->num_entradas * sizeof(MensajeProceso));
+        o->procesadas = 0;
+        o->num_enviados = 0;
+
+        for (int k = 0; k < o->num_copias; k++) liberar_copia(&o->copias[k]);
+        o->num_copias = 0;
+    }
+}
+
+void iniciar_optimistas(const CursorFases* plan) {
+    memset(optimistas, 0, sizeof(optimistas));
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        EstadoOptimista* o = &optimistas[d];
+        o->proceso = &procesos[d];
+        o->fases = *plan;
+        o->lvt = clave_en(-INFINITY);
+        o->horizonte = 0.0;
+        procesos[d].vista.especulativo = o;
+        tomar_copia(o);
+    }
+}
+
+void imprimir_optimistas() {
+    printf("Time Warp: copia de estado cada %d elementos, ventana de %.1f s\n",
+           EVENTOS_POR_COPIA, VENTANA_OPTIMISTA);
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        EstadoOptimista* o = &optimistas[d];
+        ProcesoLogico* p = o->proceso;
+        printf("  Calle %s: %lld eventos confirmados, %lld elementos procesados (%lld deshechos, %lld reejecutados), "
+               "%lld rezagados, %lld vueltas atrás, %lld esperas de ventana\n",
+               (d == NORTE_A_SUR) ? "NS" : "EO", p->eventos, o->procesados_total, o->deshechos,
+               o->reejecutados, o->rezagados, o->vueltas_atras, o->esperas);
+        printf("    %lld mensajes enviados, %lld antimensajes, %lld reenvíos evitados, %lld anulaciones recibidas; "
+               "copias: %lld, %lld registros de vehículo copiados y %lld compartidos\n",
+               p->vista.salida->mensajes - o->antimensajes, o->antimensajes, o->confirmados, o->anulados,
+               o->copias_tomadas, o->registros_copiados, o->registros_compartidos);
+    }
+}
+
+void liberar_optimistas() {
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        EstadoOptimista* o = &optimistas[d];
+        for (int k = 0; k < o->num_copias; k++) liberar_copia(&o->copias[k]);
+        free(o->copias);
+        free(o->entradas);
+        free(o->enviados);
+        free(o->pendientes);
+        free(o->filas);
+        free(o->resumenes);
+        free(o->salidos);
+        memset(o, 0, sizeof(EstadoOptimista));
+    }
+}
+
+// ============================================================================
+// RONDAS Y REPORTES DE LOS PROCESOS LÓGICOS
+// ============================================================================
+
+// MODO_CONSERVADOR: trazas de cada calle en la ronda, en orden de clave. Cada
+// calle escribe solo en la suya; la parte serial las mezcla al cerrar la ronda
+typedef struct {
+    FilaRetenida* filas;
+    int num_filas, cap_filas;
+} TrazasRonda;
+
+TrazasRonda trazas_ronda[2];
+
+void retener_estado_ronda(const AlmacenCalle* c, int i) {
+    if (!trazas_abiertas) return;
+    TrazasRonda* r = &trazas_ronda[c->vehiculos[i]->direccion];
+    if (!reservar((void**)&r->filas, r->num_filas + 1, &r->cap_filas, sizeof(FilaRetenida))) return;
+    FilaRetenida* f = &r->filas[r->num_filas++];
+    f->clave = vista->evento_en_curso;
+    f->fila = fila_estado_vehiculo(c, i);
+}
+
+void escribir_trazas_ronda() {
+    escribir_filas_retenidas(trazas_ronda[NORTE_A_SUR].filas, trazas_ronda[NORTE_A_SUR].num_filas,
+                             trazas_ronda[ESTE_A_OESTE].filas, trazas_ronda[ESTE_A_OESTE].num_filas);
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) trazas_ronda[d].num_filas = 0;
+}
+
+int avanzar_proceso(ProcesoLogico* p) {
+    vista = &p->vista;
+    if (p->indice == PROCESO_CRUCE) return avanzar_cruce(p);
+    return (config.modo_simulacion == MODO_OPTIMISTA) ? avanzar_calle_optimista(p) : avanzar_calle(p);
 }
 
-void cerrar_csv_estados() {
-    omp_destroy_lock(&lock_csv);
-    if (csv_estados) {
-        fclose(csv_estados);
-        csv_estados = NULL;
+void iniciar_procesos_logicos() {
+    memset(procesos, 0, sizeof(procesos));
+    memset(trazas_ronda, 0, sizeof(trazas_ronda));
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        iniciar_canal(&canal_hacia_cruce[d]);
+        iniciar_canal(&canal_desde_cruce[d]);
     }
-    if (csv_interseccion) {
-        fclose(csv_interseccion);
-        csv_interseccion = NULL;
+
+    for (int k = 0; k < NUM_PROCESOS_LOGICOS; k++) {
+        ProcesoLogico* p = &procesos[k];
+        p->indice = k;
+        p->vista.fase = NORTE_SUR_VERDE;
+        p->ultimo = clave_en(-INFINITY);
+        p->frontera = clave_en(-INFINITY);
     }
-    printf("Archivos CSV cerrados.\n");
-}
 
-// ============================================================================
-// DECLARACIONES DE FUNCIONES
-// ============================================================================
+    // Los mismos eventos iniciales que bucle_eventos_maestro, cada uno en
+    // la cola de su calle
+    int id_inicial[2] = {PRIMER_ID_AUTO(NORTE_A_SUR), PRIMER_ID_AUTO(ESTE_A_OESTE)};
+    double llegada_inicial[2] = {0.0, 0.5};
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        ProcesoLogico* p = &procesos[d];
+        inicializar_cola_eventos(&p->cola);
+        // Sin caja, cada calle lee directamente lo que manda la otra
+        p->entrada = (config.modo_simulacion == MODO_OPTIMISTA)
+                     ? &canal_hacia_cruce[(d == NORTE_A_SUR) ? ESTE_A_OESTE : NORTE_A_SUR]
+                     : &canal_desde_cruce[d];
+        p->vista.salida = &canal_hacia_cruce[d];
+        p->id_auto = id_inicial[d];
+        p->llegadas_pendientes = llegadas_abiertas(0, llegada_inicial[d]);
+        if (p->llegadas_pendientes) {
+            Evento entrada = {
+                .tiempo = llegada_inicial[d], .tipo = (d == NORTE_A_SUR) ? ENTRADA_NORTE : ENTRADA_ESTE,
+                .id_auto = p->id_auto, .direccion = d, .prioridad = 1
+            };
+            insertar_evento_desde(&p->cola, entrada, 0.0);
+        }
+        p->terminado = !p->llegadas_pendientes;
+    }
 
-void generar_estadisticas_interseccion(Vehiculo** vehiculos_ns, Vehiculo** vehiculos_eo);
-void procesar_eventos_interseccion_paralelo(void);
-void configurar_interseccion(void);
+    ProcesoLogico* cruce = &procesos[PROCESO_CRUCE];
+    vista = &cruce->vista;
+    double primer_cambio = iniciar_semaforo();
+    vista = &vista_global;
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        cruce->envio[d].clave = clave_cambio(primer_cambio, 0.0);
+        cruce->envio[d].fase = NORTE_SUR_VERDE;
+        cruce->envio[d].verde_anterior = NORTE_SUR_VERDE;
+    }
+    if (config.modo_simulacion == MODO_OPTIMISTA) iniciar_optimistas(&cruce->envio[NORTE_A_SUR]);
 
-// ============================================================================
-// ACTUALIZACIÓN DE VEHÍCULOS CON PARALELISMO
-// ============================================================================
+    ultimo_reporte_procesos = 0.0;
+    con_cota_serial = 0;
+    procesos_abortados = 0;
+    rondas_procesos = 0;
+}
 
-void actualizar_vehiculo_interseccion(Vehiculo* v, double dt) {
-    if (!v || v->estado == SALIENDO) return;
-    
-    v->actualizaciones_count++;
-    v->thread_id = omp_get_thread_num();
-    
-    double velocidad_anterior = v->velocidad;
-    EstadoVehiculo estado_anterior = v->estado;
-    
-    double longitud_calle = (v->direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
-    double pos_interseccion = config.posicion_interseccion;
-    double inicio_interseccion = pos_interseccion - config.ancho_interseccion/2;
-    double fin_interseccion = pos_interseccion + config.ancho_interseccion/2;
-    
-    // Lógica específica para intersección
-    if (v->posicion < inicio_interseccion - 10.0) {
-        // Comportamiento normal antes de la intersección
-        if (v->velocidad < params.velocidad_maxima - 0.2) {
-            v->estado = ACELERANDO;
-            v->aceleracion = params.aceleracion_maxima;
-        } else {
-            v->estado = VELOCIDAD_CONSTANTE;
-            v->aceleracion = 0.0;
+// Siguiente clave en el orden global con todos los procesos quietos
+Evento siguiente_clave_global() {
+    Evento siguiente = clave_cambio(semaforo.proximo_cambio, semaforo.ultimo_cambio);
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        Evento e;
+        if (ver_siguiente_evento(&procesos[d].cola, &e) && comparar_eventos(&e, &siguiente) < 0) siguiente = e;
+        CanalMensajes* c = &canal_desde_cruce[d];
+        if (c->num > 0 && comparar_eventos(&c->datos[c->inicio].clave, &siguiente) < 0) {
+            siguiente = c->datos[c->inicio].clave;
         }
-        
-        // Verificar vehículo adelante
-        Vehiculo* adelante = encontrar_vehiculo_adelante_interseccion(v->posicion, v->direccion, v);
-        if (adelante) {
-            double distancia = adelante->posicion - v->posicion - params.longitud_vehiculo;
-            if (distancia < params.distancia_seguridad_min * 1.5) {
-                v->estado = DESACELERANDO;
-                v->aceleracion = params.desaceleracion_suave;
-            }
+    }
+    return siguiente;
+}
+
+void reportar_procesos(const Evento* k) {
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        procesos[d].vista.tiempo_actual = k->tiempo;
+        procesos[d].vista.evento_en_curso = *k;
+    }
+
+    // Las dos calles tienen la misma fase y ocupación en k
+    vista = &procesos[NORTE_A_SUR].vista;
+    sincronizar_todos();
+    imprimir_estado_interseccion();
+    registrar_estado_interseccion();
+    ultimo_reporte_procesos = k->tiempo;
+
+    long long vehiculos_previstos = vehiculos_previstos_por_calle() * 2;
+    int completados_total = interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo;
+    double porcentaje = (double)completados_total / vehiculos_previstos * 100.0;
+    printf(">>> PROGRESO: %.1f%% completado (%d/%lld vehículos) - Tiempo: %.1fs <<<\n\n",
+           porcentaje, completados_total, vehiculos_previstos, k->tiempo);
+}
+
+// Parte serial de la ronda (thread 0): procesa de a uno los eventos globales
+// hasta el que dispara el reporte. Devuelve 1 al terminar la simulación.
+int cerrar_ronda() {
+    rondas_procesos++;
+    while (1) {
+        // La caja aplica los cambios de fase que las calles dejaron atrás
+        // después de su última pasada
+        avanzar_proceso(&procesos[PROCESO_CRUCE]);
+        if (procesos_abortados) return 1;
+        if (procesos[NORTE_A_SUR].terminado && procesos[ESTE_A_OESTE].terminado) {
+            escribir_trazas_ronda();
+            return 1;
         }
-        
-    } else if (v->posicion >= inicio_interseccion - 10.0 && v->posicion < inicio_interseccion) {
-        // Aproximándose a la intersección
-        if (puede_cruzar_interseccion(v)) {
-            v->estado = ACELERANDO;
-            v->aceleracion = params.aceleracion_maxima * 0.8;
-        } else {
-            v->estado = ESPERANDO_PASO;
-            v->aceleracion = params.desaceleracion_maxima;
-            v->tiempo_esperando_interseccion += dt;
-            
-            if (v->velocidad <= 0.1) {
-                v->velocidad = 0.0;
-                v->estado = DETENIDO;
-                v->aceleracion = 0.0;
-                v->tiempo_total_detenido += dt;
-            }
+
+        Evento k = siguiente_clave_global();
+        cota_serial = k;
+        con_cota_serial = 1;
+        int progreso;
+        do {
+            progreso = 0;
+            for (int n = 0; n < NUM_PROCESOS_LOGICOS; n++) progreso |= avanzar_proceso(&procesos[n]);
+        } while (progreso && !procesos_abortados);
+        con_cota_serial = 0;
+
+        if (k.tiempo - ultimo_reporte_procesos >= PERIODO_REPORTE) {
+            escribir_trazas_ronda();
+            reportar_procesos(&k);
+            return 0;
         }
-        
-    } else if (v->posicion >= inicio_interseccion && v->posicion <= fin_interseccion) {
-        // En la intersección
-        if (v->estado != CRUZANDO_INTERSECCION) {
-            entrar_interseccion(v);
+    }
+}
+
+// Siguiente clave en el orden global con las calles optimistas quietas
+Evento siguiente_clave_optimista() {
+    Evento siguiente = clave_cambio(semaforo.proximo_cambio, semaforo.ultimo_cambio);
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        Evento e;
+        if (siguiente_elemento(&optimistas[d], &e) != ELEMENTO_NINGUNO && comparar_eventos(&e, &siguiente) < 0) {
+            siguiente = e;
         }
-        v->aceleracion = params.aceleracion_maxima * 0.6; // Velocidad controlada en intersección
-        
-    } else if (v->posicion > fin_interseccion) {
-        // Después de la intersección
-        if (v->estado == CRUZANDO_INTERSECCION) {
-            salir_interseccion(v);
+    }
+    return siguiente;
+}
+
+// cerrar_ronda para MODO_OPTIMISTA: el semáforo global sigue el plan que ya
+// aplicaron las calles, y al reportar lo procesado pasa a ser definitivo
+int cerrar_ronda_optimista() {
+    rondas_procesos++;
+    ProcesoLogico* cruce = &procesos[PROCESO_CRUCE];
+    while (1) {
+        Evento ultimo = procesos[NORTE_A_SUR].ultimo;
+        if (comparar_eventos(&procesos[ESTE_A_OESTE].ultimo, &ultimo) > 0) ultimo = procesos[ESTE_A_OESTE].ultimo;
+        vista = &cruce->vista;
+        aplicar_cambios_semaforo(cruce, &ultimo);
+        if (procesos_abortados) return 1;
+        if (procesos[NORTE_A_SUR].terminado && procesos[ESTE_A_OESTE].terminado) {
+            confirmar_optimistas();
+            return 1;
         }
-        
-        if (v->velocidad < params.velocidad_maxima - 0.2) {
-            v->estado = ACELERANDO;
-            v->aceleracion = params.aceleracion_maxima;
-        } else {
-            v->estado = VELOCIDAD_CONSTANTE;
-            v->aceleracion = 0.0;
+
+        Evento k = siguiente_clave_optimista();
+        cota_serial = k;
+        con_cota_serial = 1;
+        int progreso;
+        do {
+            progreso = 0;
+            for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) progreso |= avanzar_proceso(&procesos[d]);
+        } while (progreso && !procesos_abortados);
+        vista = &cruce->vista;
+        aplicar_cambios_semaforo(cruce, &ultimo);
+        con_cota_serial = 0;
+
+        if (k.tiempo - ultimo_reporte_procesos >= PERIODO_REPORTE) {
+            // Las trazas de k salen antes del reporte, y la base se toma
+            // después: reportar sincroniza los vehículos en flujo libre
+            confirmar_optimistas();
+            reportar_procesos(&k);
+            for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+                tomar_copia(&optimistas[d]);
+                Evento siguiente;
+                siguiente_elemento(&optimistas[d], &siguiente);
+                publicar_horizonte(&optimistas[d], siguiente.tiempo);
+            }
+            return 0;
         }
     }
-    
-    // Actualizar física
-    double nueva_velocidad = v->velocidad + v->aceleracion * dt;
-    if (nueva_velocidad < 0.0) nueva_velocidad = 0.0;
-    if (nueva_velocidad > params.velocidad_maxima) nueva_velocidad = params.velocidad_maxima;
-    
-    if (nueva_velocidad < 0.1 && v->aceleracion < 0) {
-        nueva_velocidad = 0.0;
+}
+
+void ejecutar_procesos_logicos() {
+    iniciar_procesos_logicos();
+
+    // En MODO_OPTIMISTA la caja no tiene thread: solo la parte serial
+    int optimista = (config.modo_simulacion == MODO_OPTIMISTA);
+    int activos = optimista ? 2 : NUM_PROCESOS_LOGICOS;
+    int hilos = omp_get_max_threads();
+    if (hilos > activos) hilos = activos;
+    if (optimista) {
+        printf("Procesos lógicos optimistas: calle NS y calle EO en %d thread(s)\n", hilos);
+    } else {
+        printf("Procesos lógicos: calle NS, calle EO y caja en %d thread(s)\n", hilos);
     }
-    
-    double nueva_posicion = v->posicion + nueva_velocidad * dt;
-    
-    // Verificar colisiones
-    Vehiculo* adelante = encontrar_vehiculo_adelante_interseccion(v->posicion, v->direccion, v);
-    int puede_avanzar = 1;
-    
-    if (adelante) {
-        double distancia_resultante = adelante->posicion - nueva_posicion - params.longitud_vehiculo;
-        if (distancia_resultante < params.distancia_seguridad_min * 0.8) {
-            puede_avanzar = 0;
+
+    int fin = 0;
+    #pragma omp parallel num_threads(hilos)
+    {
+        int t = omp_get_thread_num();
+        int n = omp_get_num_threads();
+        while (1) {
+            #pragma omp master
+            {
+                // Los mensajes que dejó la parte serial también cuentan
+                trabajo_ronda = activos;
+                for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+                    trabajo_ronda += canal_hacia_cruce[d].num + canal_desde_cruce[d].num;
+                }
+                for (int k = 0; k < activos; k++) procesos[k].en_reposo = 0;
+            }
+            #pragma omp barrier
+
+            while (__atomic_load_n(&trabajo_ronda, __ATOMIC_ACQUIRE) > 0 && !procesos_abortados) {
+                int progreso = 0;
+                for (int k = t; k < activos; k += n) progreso |= avanzar_proceso(&procesos[k]);
+                // Bloqueado: con más threads que núcleos, que corra el que tiene trabajo
+                if (!progreso) sched_yield();
+            }
+            #pragma omp barrier
+
+            #pragma omp master
+            fin = optimista ? cerrar_ronda_optimista() : cerrar_ronda();
+            #pragma omp barrier
+            if (fin) break;
         }
+        vista = &vista_global;
     }
-    
-    // Actualizar posición y velocidad
-    if (puede_avanzar) {
-        v->velocidad = nueva_velocidad;
-        v->posicion = nueva_posicion;
-        v->distancia_recorrida += nueva_velocidad * dt;
-    } else {
-        v->velocidad = 0.0;
-        v->estado = DETENIDO;
-        v->aceleracion = 0.0;
-        v->tiempo_total_detenido += dt;
-    }
-    
-    // Registrar cambios de estado
-    if (estado_anterior != v->estado) {
-        v->tiempo_en_estado = 0.0;
-        v->ultimo_cambio_estado = interseccion.tiempo_actual;
-    } else {
-        v->tiempo_en_estado += dt;
+
+    // Totales en la vista global, como en los otros modos
+    vista_global.tiempo_actual = 0.0;
+    eventos_procesados = 0;
+    for (int k = 0; k < NUM_PROCESOS_LOGICOS; k++) {
+        ProcesoLogico* p = &procesos[k];
+        eventos_procesados += p->eventos;
+        vista_global.actualizaciones += p->vista.actualizaciones;
+        vista_global.pasos_analiticos += p->vista.pasos_analiticos;
+        vista_global.pasos_detenidos += p->vista.pasos_detenidos;
+        if (k != PROCESO_CRUCE && p->eventos > 0 && p->ultimo.tiempo > vista_global.tiempo_actual) {
+            vista_global.tiempo_actual = p->ultimo.tiempo;
+        }
     }
-    
-    // Estadísticas
-    if (v->estado == DETENIDO) v->tiempo_total_detenido += dt;
-    if (v->velocidad < params.velocidad_maxima / 2.0) v->tiempo_lento += dt;
-    if (v->velocidad > 0 && velocidad_anterior == 0) {
-        v->eventos_reanudacion++;
+    vista_global.fase = procesos[PROCESO_CRUCE].vista.fase;
+}
+
+void imprimir_procesos_logicos() {
+    printf("Procesos lógicos: %d rondas entre reportes\n", rondas_procesos);
+    if (config.modo_simulacion == MODO_OPTIMISTA) {
+        imprimir_optimistas();
+        return;
     }
-    
-    // Calcular velocidad promedio
-    if (v->actualizaciones_count > 0) {
-        double tiempo_transcurrido = interseccion.tiempo_actual - v->tiempo_entrada;
-        if (tiempo_transcurrido > 0) {
-            v->velocidad_promedio = v->distancia_recorrida / tiempo_transcurrido;
-        }
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        ProcesoLogico* p = &procesos[d];
+        printf("  Calle %s: %lld eventos, %lld mensajes aplicados, %lld cambios de ocupación enviados, "
+               "%lld promesas nulas, %lld bloqueos, cola máx %d\n",
+               (d == NORTE_A_SUR) ? "NS" : "EO", p->eventos, p->mensajes,
+               canal_hacia_cruce[d].mensajes, canal_hacia_cruce[d].promesas, p->bloqueos,
+               p->cola.max_size_alcanzado);
     }
+    ProcesoLogico* cruce = &procesos[PROCESO_CRUCE];
+    printf("  Caja: %lld cambios de fase, %lld mensajes reenviados, %lld promesas nulas, %lld bloqueos\n",
+           cruce->eventos, cruce->mensajes,
+           canal_desde_cruce[NORTE_A_SUR].promesas + canal_desde_cruce[ESTE_A_OESTE].promesas, cruce->bloqueos);
 }
 
-// ============================================================================
-// FUNCIÓN PRINCIPAL DE SIMULACIÓN PARALELA
-// ============================================================================
+void liberar_procesos_logicos() {
+    for (int d = NORTE_A_SUR; d <= ESTE_A_OESTE; d++) {
+        destruir_cola_eventos(&procesos[d].cola);
+        destruir_canal(&canal_hacia_cruce[d]);
+        destruir_canal(&canal_desde_cruce[d]);
+        free(trazas_ronda[d].filas);
+    }
+    memset(trazas_ronda, 0, sizeof(trazas_ronda));
+    if (config.modo_simulacion == MODO_OPTIMISTA) liberar_optimistas();
+}
 
 void procesar_eventos_interseccion_paralelo() {
     ColaEventos cola;
     inicializar_cola_eventos(&cola);
     
-    // Arrays para todos los vehículos (para estadísticas finales)
-    Vehiculo** todos_vehiculos_ns = (Vehiculo**)calloc(config.max_autos_por_calle, sizeof(Vehiculo*));
-    Vehiculo** todos_vehiculos_eo = (Vehiculo**)calloc(config.max_autos_por_calle, sizeof(Vehiculo*));
-    
-    if (!todos_vehiculos_ns || !todos_vehiculos_eo) {
-        fprintf(stderr, "ERROR: No se pudo asignar memoria para arrays de vehículos\n");
-        return;
-    }
-    
-    // Eventos iniciales
-    int id_auto_ns = 1, id_auto_eo = 1001; // IDs diferentes para cada calle
-    
-    Evento entrada_ns = {0.0, ENTRADA_NORTE, id_auto_ns, NORTE_A_SUR, NULL, 1};
-    Evento entrada_eo = {0.5, ENTRADA_ESTE, id_auto_eo, ESTE_A_OESTE, NULL, 1};
-    
-    insertar_evento_thread_safe(&cola, entrada_ns);
-    insertar_evento_thread_safe(&cola, entrada_eo);
-    
-    double ultimo_reporte = 0.0;
-    int max_vehiculos_total = config.max_autos_por_calle * 2;
+    // Los completados se resumen al salir; sus vehículos vuelven al pool
+    inicializar_resumenes();
     
     printf("Iniciando simulación paralela de intersección...\n");
-    printf("Threads configurados: %d\n", omp_get_max_threads());
-    
-    // BUCLE PRINCIPAL PARALELO
-    while ((cola.size > 0 || interseccion.num_vehiculos_ns > 0 || interseccion.num_vehiculos_eo > 0) &&
-           (interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo) < max_vehiculos_total) {
-        
-        Evento* e = obtener_siguiente_evento_thread_safe(&cola);
-        
-        if (!e) {
-            // Verificar si hay vehículos activos
-            if (interseccion.num_vehiculos_ns > 0 || interseccion.num_vehiculos_eo > 0) {
-                printf("ADVERTENCIA: Sin eventos pero vehículos activos en t=%.2f\n", interseccion.tiempo_actual);
-            }
-            break;
-        }
-        
-        omp_set_lock(&interseccion.lock_sistema);
-        interseccion.tiempo_actual = e->tiempo;
-        omp_unset_lock(&interseccion.lock_sistema);
-        
-        actualizar_semaforo_interseccion(interseccion.tiempo_actual);
-        
-        omp_set_lock(&lock_eventos);
-        eventos_procesados++;
-        omp_unset_lock(&lock_eventos);
-        
-        // Protección contra bucles infinitos
-        if (eventos_procesados > max_vehiculos_total * 10000) {
-            printf("ADVERTENCIA: Demasiados eventos procesados. Verificando progreso...\n");
-            break;
-        }
-        
-        // PROCESAR ENTRADA NORTE-SUR
-        if (e->tipo == ENTRADA_NORTE && interseccion.total_vehiculos_creados_ns < config.max_autos_por_calle) {
-            // Verificar espacio
-            int puede_entrar = 1;
-            omp_set_lock(&interseccion.lock_sistema);
-            for (int i = 0; i < interseccion.num_vehiculos_ns; i++) {
-                Vehiculo* v = interseccion.vehiculos_norte_sur[i];
-                if (v && v->posicion < params.longitud_vehiculo + params.distancia_seguridad_min) {
-                    puede_entrar = 0;
-                    break;
-                }
-            }
-            omp_unset_lock(&interseccion.lock_sistema);
-            
-            if (puede_entrar) {
-                Vehiculo* v = (Vehiculo*)calloc(1, sizeof(Vehiculo));
-                if (v) {
-                    v->id = id_auto_ns;
-                    v->direccion = NORTE_A_SUR;
-                    v->estado = ENTRANDO;
-                    v->aceleracion = params.aceleracion_maxima;
-                    v->tiempo_entrada = e->tiempo;
-                    v->ultimo_cambio_estado = e->tiempo;
-                    v->thread_id = omp_get_thread_num();
-                    
-                    omp_set_lock(&interseccion.lock_sistema);
-                    todos_vehiculos_ns[interseccion.total_vehiculos_creados_ns] = v;
-                    interseccion.vehiculos_norte_sur[interseccion.num_vehiculos_ns++] = v;
-                    interseccion.total_vehiculos_creados_ns++;
-                    omp_unset_lock(&interseccion.lock_sistema);
-                    
-                    // Programar actualización
-                    Evento act = {e->tiempo + config.paso_simulacion, ACTUALIZACION_VEHICULO, v->id, NORTE_A_SUR, v, 0};
-                    insertar_evento_thread_safe(&cola, act);
-                    
-                    id_auto_ns++;
-                    
-                    // Programar siguiente entrada
-                    if (interseccion.total_vehiculos_creados_ns < config.max_autos_por_calle) {
-                        Evento sig = {e->tiempo + config.intervalo_entrada_vehiculos, ENTRADA_NORTE, id_auto_ns, NORTE_A_SUR, NULL, 1};
-                        insertar_evento_thread_safe(&cola, sig);
-                    }
-                }
-            } else {
-                // Reintentar entrada
-                if (interseccion.total_vehiculos_creados_ns < config.max_autos_por_calle) {
-                    Evento reintento = {e->tiempo + 1.0, ENTRADA_NORTE, id_auto_ns, NORTE_A_SUR, NULL, 1};
-                    insertar_evento_thread_safe(&cola, reintento);
-                }
-            }
-        }
+    if (config.modo_simulacion == MODO_CONSERVADOR || config.modo_simulacion == MODO_OPTIMISTA) {
+        // Cada calle con su cola (ver PROCESOS LÓGICOS CONSERVADORES y TIME WARP)
+        ejecutar_procesos_logicos();
+    } else {
+        // Una sola región paralela para toda la corrida (ver EQUIPO PERSISTENTE)
+        int tam_equipo = (config.modo_simulacion == MODO_TICK) ? omp_get_max_threads() : 1;
+        printf("Threads del equipo: %d%s\n", tam_equipo,
+               (config.modo_simulacion == MODO_TICK) ? "" : " (MODO_EVENTOS procesa la cola en serie)");
         
-        // PROCESAR ENTRADA ESTE-OESTE
-        else if (e->tipo == ENTRADA_ESTE && interseccion.total_vehiculos_creados_eo < config.max_autos_por_calle) {
-            // Verificar espacio
-            int puede_entrar = 1;
-            omp_set_lock(&interseccion.lock_sistema);
-            for (int i = 0; i < interseccion.num_vehiculos_eo; i++) {
-                Vehiculo* v = interseccion.vehiculos_este_oeste[i];
-                if (v && v->posicion < params.longitud_vehiculo + params.distancia_seguridad_min) {
-                    puede_entrar = 0;
-                    break;
-                }
-            }
-            omp_unset_lock(&interseccion.lock_sistema);
-            
-            if (puede_entrar) {
-                Vehiculo* v = (Vehiculo*)calloc(1, sizeof(Vehiculo));
-                if (v) {
-                    v->id = id_auto_eo;
-                    v->direccion = ESTE_A_OESTE;
-                    v->estado = ENTRANDO;
-                    v->aceleracion = params.aceleracion_maxima;
-                    v->tiempo_entrada = e->tiempo;
-                    v->ultimo_cambio_estado = e->tiempo;
-                    v->thread_id = omp_get_thread_num();
-                    
-                    omp_set_lock(&interseccion.lock_sistema);
-                    todos_vehiculos_eo[interseccion.total_vehiculos_creados_eo] = v;
-                    interseccion.vehiculos_este_oeste[interseccion.num_vehiculos_eo++] = v;
-                    interseccion.total_vehiculos_creados_eo++;
-                    omp_unset_lock(&interseccion.lock_sistema);
-                    
-                    // Programar actualización
-                    Evento act = {e->tiempo + config.paso_simulacion, ACTUALIZACION_VEHICULO, v->id, ESTE_A_OESTE, v, 0};
-                    insertar_evento_thread_safe(&cola, act);
-                    
-                    id_auto_eo++;
-                    
-                    // Programar siguiente entrada
-                    if (interseccion.total_vehiculos_creados_eo < config.max_autos_por_calle) {
-                        Evento sig = {e->tiempo + config.intervalo_entrada_vehiculos, ENTRADA_ESTE, id_auto_eo, ESTE_A_OESTE, NULL, 1};
-                        insertar_evento_thread_safe(&cola, sig);
-                    }
-                }
+        #pragma omp parallel num_threads(tam_equipo)
+        {
+            if (omp_get_thread_num() == 0) {
+                bucle_eventos_maestro(&cola);
+                terminar_lotes();
             } else {
-                // Reintentar entrada
-                if (interseccion.total_vehiculos_creados_eo < config.max_autos_por_calle) {
-                    Evento reintento = {e->tiempo + 1.0, ENTRADA_ESTE, id_auto_eo, ESTE_A_OESTE, NULL, 1};
-                    insertar_evento_thread_safe(&cola, reintento);
-                }
-            }
-        }
-        
-        // PROCESAR ACTUALIZACIÓN DE VEHÍCULO
-        else if (e->tipo == ACTUALIZACION_VEHICULO) {
-            Vehiculo* v = e->vehiculo;
-            
-            if (v && v->estado != SALIENDO) {
-                double dt = config.paso_simulacion;
-                
-                // Actualizar vehículo usando paralelismo
-                #pragma omp task firstprivate(v, dt)
-                {
-                    actualizar_vehiculo_interseccion(v, dt);
-                    registrar_estado_vehiculo_thread_safe(v);
-                }
-                #pragma omp taskwait
-                
-                // Verificar salida del sistema
-                double longitud_calle = (v->direccion == NORTE_A_SUR) ? config.longitud_calle_ns : config.longitud_calle_eo;
-                
-                if (v->posicion >= longitud_calle) {
-                    v->tiempo_salida = interseccion.tiempo_actual;
-                    v->estado = SALIENDO;
-                    
-                    double tiempo_total = v->tiempo_salida - v->tiempo_entrada;
-                    printf("[%.2f] Vehículo %d (%s) completa recorrido en %.2fs\n",
-                           interseccion.tiempo_actual, v->id,
-                           (v->direccion == NORTE_A_SUR) ? "NS" : "EO", tiempo_total);
-                    
-                    // Remover de vehículos activos
-                    omp_set_lock(&interseccion.lock_sistema);
-                    if (v->direccion == NORTE_A_SUR) {
-                        for (int i = 0; i < interseccion.num_vehiculos_ns; i++) {
-                            if (interseccion.vehiculos_norte_sur[i] == v) {
-                                interseccion.vehiculos_norte_sur[i] = interseccion.vehiculos_norte_sur[interseccion.num_vehiculos_ns - 1];
-                                interseccion.vehiculos_norte_sur[interseccion.num_vehiculos_ns - 1] = NULL;
-                                interseccion.num_vehiculos_ns--;
-                                interseccion.total_vehiculos_completados_ns++;
-                                break;
-                            }
-                        }
-                    } else {
-                        for (int i = 0; i < interseccion.num_vehiculos_eo; i++) {
-                            if (interseccion.vehiculos_este_oeste[i] == v) {
-                                interseccion.vehiculos_este_oeste[i] = interseccion.vehiculos_este_oeste[interseccion.num_vehiculos_eo - 1];
-                                interseccion.vehiculos_este_oeste[interseccion.num_vehiculos_eo - 1] = NULL;
-                                interseccion.num_vehiculos_eo--;
-                                interseccion.total_vehiculos_completados_eo++;
-                                break;
-                            }
-                        }
-                    }
-                    omp_unset_lock(&interseccion.lock_sistema);
-                } else {
-                    // Programar siguiente actualización
-                    Evento siguiente = {e->tiempo + config.paso_simulacion, ACTUALIZACION_VEHICULO, v->id, v->direccion, v, 0};
-                    insertar_evento_thread_safe(&cola, siguiente);
-                }
+                servir_lotes();
             }
         }
-        
-        // REPORTES PERIÓDICOS
-        if (interseccion.tiempo_actual - ultimo_reporte >= 20.0) {
-            imprimir_estado_interseccion();
-            registrar_estado_interseccion();
-            ultimo_reporte = interseccion.tiempo_actual;
-            
-            int completados_total = interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo;
-            double porcentaje = (double)completados_total / max_vehiculos_total * 100.0;
-            printf(">>> PROGRESO: %.1f%% completado (%d/%d vehículos) - Tiempo: %.1fs <<<\n\n", 
-                   porcentaje, completados_total, max_vehiculos_total, interseccion.tiempo_actual);
-        }
-        
-        free(e);
     }
     
     // REPORTES FINALES
     printf("\n=== SIMULACIÓN DE INTERSECCIÓN COMPLETADA ===\n");
-    printf("Eventos procesados: %d\n", eventos_procesados);
-    printf("Tiempo total: %.2f segundos\n", interseccion.tiempo_actual);
+    printf("Eventos procesados: %lld\n", eventos_procesados);
+    if (config.modo_avance == AVANCE_ANALITICO && config.modo_simulacion != MODO_TICK) {
+        printf("Pasos avanzados analíticamente: %lld\n", vista->pasos_analiticos);
+        printf("Pasos detenidos acreditados sin evento: %lld\n", vista->pasos_detenidos);
+    }
+    printf("Tiempo total: %.2f segundos\n", vista->tiempo_actual);
     printf("Vehículos Norte-Sur: %d creados, %d completados\n", 
            interseccion.total_vehiculos_creados_ns, interseccion.total_vehiculos_completados_ns);
     printf("Vehículos Este-Oeste: %d creados, %d completados\n", 
            interseccion.total_vehiculos_creados_eo, interseccion.total_vehiculos_completados_eo);
-    printf("Ciclos de semáforo: %d\n", semaforo.ciclos_completados);
+    if (config.control_interseccion == CONTROL_RESERVAS) {
+        printf("Reservas de cruce: %lld concedidas (%lld sin espera), espera media %.2f s, %lld sin hueco en el horizonte\n",
+               gestor.concedidas, gestor.sin_espera,
+               (gestor.concedidas > 0) ? gestor.espera_total / gestor.concedidas : 0.0, gestor.sin_hueco);
+    } else {
+        printf("Ciclos de semáforo: %d\n", semaforo.ciclos_completados);
+    }
+    if (config.modo_simulacion == MODO_CONSERVADOR || config.modo_simulacion == MODO_OPTIMISTA) {
+        imprimir_procesos_logicos();
+    } else {
+        printf("Cola de eventos: máximo %d pendientes, %d asignaciones de memoria de la cola\n",
+               cola.max_size_alcanzado, cola.asignaciones_cola);
+    }
+    
+    printf("Pool de vehículos: máximo %d en uso, %d bloques de %d\n",
+           pool.max_en_uso, pool.num_bloques, VEHICULOS_POR_BLOQUE);
     
     // Generar estadísticas finales
-    generar_estadisticas_interseccion(todos_vehiculos_ns, todos_vehiculos_eo);
+    generar_estadisticas_interseccion();
+    cerrar_resumenes();
     
-    // Limpieza
+    // Limpieza; los que no llegaron a salir se liberan con sus bloques
     destruir_cola_eventos(&cola);
-    
-    for (int i = 0; i < interseccion.total_vehiculos_creados_ns; i++) {
-        if (todos_vehiculos_ns[i]) free(todos_vehiculos_ns[i]);
-    }
-    for (int i = 0; i < interseccion.total_vehiculos_creados_eo; i++) {
-        if (todos_vehiculos_eo[i]) free(todos_vehiculos_eo[i]);
+    if (config.modo_simulacion == MODO_CONSERVADOR || config.modo_simulacion == MODO_OPTIMISTA) {
+        liberar_procesos_logicos();
     }
-    
-    free(todos_vehiculos_ns);
-    free(todos_vehiculos_eo);
+    liberar_pool_vehiculos();
 }
 
 // ============================================================================
 // ESTADÍSTICAS FINALES PARA INTERSECCIÓN
 // ============================================================================
 
-void generar_estadisticas_interseccion(Vehiculo** vehiculos_ns, Vehiculo** vehiculos_eo) {
+// Promedios y distribución de los completados de una dirección
+void imprimir_resumen_direccion(const char* titulo, const SumideroResumenes* r) {
+    if (r->completados == 0) return;
+    
+    printf("%s:\n", titulo);
+    printf("  Tiempo promedio: %.2f s\n", r->recorrido.media);
+    printf("  Velocidad promedio: %.2f m/s (%.1f km/h)\n", r->velocidad.media, r->velocidad.media * 3.6);
+    printf("  Tiempo espera en intersección: %.2f s\n", r->espera.media);
+    printf("  Tiempo cruzando: %.2f s\n", r->cruce.media);
+    estadistica_imprimir("Tiempo de recorrido", &r->recorrido, "s");
+    estadistica_imprimir("Tiempo detenido", &r->detenido, "s");
+    estadistica_imprimir("Espera en intersección", &r->espera, "s");
+    estadistica_imprimir("Velocidad promedio", &r->velocidad, "m/s");
+}
+
+void escribir_estadisticas_flujo(FILE* csv, const char* grupo, const SumideroResumenes* r) {
+    if (r->completados == 0) return;
+    estadistica_csv(csv, grupo, "TiempoRecorrido", &r->recorrido);
+    estadistica_csv(csv, grupo, "TiempoDetenido", &r->detenido);
+    estadistica_csv(csv, grupo, "TiempoEspera", &r->espera);
+    estadistica_csv(csv, grupo, "TiempoCruce", &r->cruce);
+    estadistica_csv(csv, grupo, "VelocidadPromedio", &r->velocidad);
+}
+
+void escribir_histogramas_flujo(FILE* csv, const char* grupo, const SumideroResumenes* r) {
+    estadistica_csv_histograma(csv, grupo, "TiempoRecorrido", &r->recorrido);
+    estadistica_csv_histograma(csv, grupo, "TiempoDetenido", &r->detenido);
+    estadistica_csv_histograma(csv, grupo, "TiempoEspera", &r->espera);
+    estadistica_csv_histograma(csv, grupo, "VelocidadPromedio", &r->velocidad);
+}
+
+void generar_estadisticas_interseccion() {
     printf("\n==== ESTADÍSTICAS FINALES DE INTERSECCIÓN ====\n");
     
     // Obtener directorio del código fuente usando __FILE__
@@ -1118,87 +4134,50 @@ void generar_estadisticas_interseccion(Vehiculo** vehiculos_ns, Vehiculo** vehic
     
     // Encabezado
     fprintf(csv, "# ESTADISTICAS_INTERSECCION\n");
-    fprintf(csv, "TiempoTotal,%.2f\n", interseccion.tiempo_actual);
+    fprintf(csv, "TiempoTotal,%.2f\n", vista->tiempo_actual);
     fprintf(csv, "VehiculosNS,%d,%d\n", interseccion.total_vehiculos_creados_ns, interseccion.total_vehiculos_completados_ns);
     fprintf(csv, "VehiculosEO,%d,%d\n", interseccion.total_vehiculos_creados_eo, interseccion.total_vehiculos_completados_eo);
     fprintf(csv, "CiclosSemaforo,%d\n", semaforo.ciclos_completados);
+    if (config.control_interseccion == CONTROL_RESERVAS) {
+        fprintf(csv, "ReservasCruce,%lld,%lld,%.2f\n", gestor.concedidas, gestor.sin_espera,
+                (gestor.concedidas > 0) ? gestor.espera_total / gestor.concedidas : 0.0);
+    }
     fprintf(csv, "# DATOS_VEHICULOS\n");
     fprintf(csv, "ID,Direccion,Entrada,Interseccion,Salida,TiempoEspera,TiempoCruce,VelProm\n");
     
-    // Procesar vehículos Norte-Sur
-    if (interseccion.total_vehiculos_completados_ns > 0) {
-        double tiempo_promedio_ns = 0.0, velocidad_promedio_ns = 0.0;
-        double tiempo_espera_promedio_ns = 0.0, tiempo_cruce_promedio_ns = 0.0;
-        
-        for (int i = 0; i < interseccion.total_vehiculos_creados_ns; i++) {
-            if (vehiculos_ns[i] && vehiculos_ns[i]->estado == SALIENDO) {
-                Vehiculo* v = vehiculos_ns[i];
-                double tiempo_recorrido = v->tiempo_salida - v->tiempo_entrada;
-                tiempo_promedio_ns += tiempo_recorrido;
-                
-                if (tiempo_recorrido > 0) {
-                    velocidad_promedio_ns += config.longitud_calle_ns / tiempo_recorrido;
-                }
-                
-                tiempo_espera_promedio_ns += v->tiempo_esperando_interseccion;
-                tiempo_cruce_promedio_ns += v->tiempo_cruzando;
-                
-                // Guardar en CSV
-                fprintf(csv, "%d,NS,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
-                        v->id, v->tiempo_entrada, v->tiempo_llegada_interseccion,
-                        v->tiempo_salida, v->tiempo_esperando_interseccion,
-                        v->tiempo_cruzando, v->velocidad_promedio);
-            }
-        }
-        
-        tiempo_promedio_ns /= interseccion.total_vehiculos_completados_ns;
-        velocidad_promedio_ns /= interseccion.total_vehiculos_completados_ns;
-        tiempo_espera_promedio_ns /= interseccion.total_vehiculos_completados_ns;
-        tiempo_cruce_promedio_ns /= interseccion.total_vehiculos_completados_ns;
-        
-        printf("NORTE-SUR:\n");
-        printf("  Tiempo promedio: %.2f s\n", tiempo_promedio_ns);
-        printf("  Velocidad promedio: %.2f m/s (%.1f km/h)\n", velocidad_promedio_ns, velocidad_promedio_ns * 3.6);
-        printf("  Tiempo espera en intersección: %.2f s\n", tiempo_espera_promedio_ns);
-        printf("  Tiempo cruzando: %.2f s\n", tiempo_cruce_promedio_ns);
+    // Filas de cada dirección, en orden de salida
+    volcar_resumenes(&resumenes[NORTE_A_SUR], csv);
+    volcar_resumenes(&resumenes[ESTE_A_OESTE], csv);
+    
+    imprimir_resumen_direccion("NORTE-SUR", &resumenes[NORTE_A_SUR]);
+    imprimir_resumen_direccion("ESTE-OESTE", &resumenes[ESTE_A_OESTE]);
+    
+    // Ambas direcciones juntas, fusionando las estadísticas de cada una
+    SumideroResumenes total;
+    memset(&total, 0, sizeof(total));
+    for (int d = 0; d < 2; d++) {
+        SumideroResumenes* r = &resumenes[d];
+        total.completados += r->completados;
+        estadistica_fusionar(&total.recorrido, &r->recorrido);
+        estadistica_fusionar(&total.detenido, &r->detenido);
+        estadistica_fusionar(&total.espera, &r->espera);
+        estadistica_fusionar(&total.cruce, &r->cruce);
+        estadistica_fusionar(&total.velocidad, &r->velocidad);
+    }
+    if (resumenes[NORTE_A_SUR].completados > 0 && resumenes[ESTE_A_OESTE].completados > 0) {
+        imprimir_resumen_direccion("TOTAL", &total);
     }
     
-    // Procesar vehículos Este-Oeste
-    if (interseccion.total_vehiculos_completados_eo > 0) {
-        double tiempo_promedio_eo = 0.0, velocidad_promedio_eo = 0.0;
-        double tiempo_espera_promedio_eo = 0.0, tiempo_cruce_promedio_eo = 0.0;
-        
-        for (int i = 0; i < interseccion.total_vehiculos_creados_eo; i++) {
-            if (vehiculos_eo[i] && vehiculos_eo[i]->estado == SALIENDO) {
-                Vehiculo* v = vehiculos_eo[i];
-                double tiempo_recorrido = v->tiempo_salida - v->tiempo_entrada;
-                tiempo_promedio_eo += tiempo_recorrido;
-                
-                if (tiempo_recorrido > 0) {
-                    velocidad_promedio_eo += config.longitud_calle_eo / tiempo_recorrido;
-                }
-                
-                tiempo_espera_promedio_eo += v->tiempo_esperando_interseccion;
-                tiempo_cruce_promedio_eo += v->tiempo_cruzando;
-                
-                // Guardar en CSV
-                fprintf(csv, "%d,EO,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
-                        v->id, v->tiempo_entrada, v->tiempo_llegada_interseccion,
-                        v->tiempo_salida, v->tiempo_esperando_interseccion,
-                        v->tiempo_cruzando, v->velocidad_promedio);
-            }
-        }
-        
-        tiempo_promedio_eo /= interseccion.total_vehiculos_completados_eo;
-        velocidad_promedio_eo /= interseccion.total_vehiculos_completados_eo;
-        tiempo_espera_promedio_eo /= interseccion.total_vehiculos_completados_eo;
-        tiempo_cruce_promedio_eo /= interseccion.total_vehiculos_completados_eo;
-        
-        printf("ESTE-OESTE:\n");
-        printf("  Tiempo promedio: %.2f s\n", tiempo_promedio_eo);
-        printf("  Velocidad promedio: %.2f m/s (%.1f km/h)\n", velocidad_promedio_eo, velocidad_promedio_eo * 3.6);
-        printf("  Tiempo espera en intersección: %.2f s\n", tiempo_espera_promedio_eo);
-        printf("  Tiempo cruzando: %.2f s\n", tiempo_cruce_promedio_eo);
+    if (total.completados > 0) {
+        fprintf(csv, "# ESTADISTICAS_FLUJO\n");
+        estadistica_csv_encabezado(csv);
+        escribir_estadisticas_flujo(csv, "NS", &resumenes[NORTE_A_SUR]);
+        escribir_estadisticas_flujo(csv, "EO", &resumenes[ESTE_A_OESTE]);
+        escribir_estadisticas_flujo(csv, "Total", &total);
+        fprintf(csv, "# HISTOGRAMAS\n");
+        fprintf(csv, "Grupo,Metrica,Desde,Hasta,Vehiculos\n");
+        escribir_histogramas_flujo(csv, "NS", &resumenes[NORTE_A_SUR]);
+        escribir_histogramas_flujo(csv, "EO", &resumenes[ESTE_A_OESTE]);
     }
     
     fclose(csv);
@@ -1299,13 +4278,24 @@ int validar_configuracion_interseccion() {
     
     printf("\n=== VALIDACIÓN DE CONFIGURACIÓN ===\n");
     
-    // Validar vehículos por calle
-    if (config.max_autos_por_calle <= 0 || config.max_autos_por_calle > 1000) {
-        fprintf(stderr, "ERROR: max_autos_por_calle debe estar entre 1 y 1000 (actual: %d)\n", 
+    // Validar vehículos por calle y cierre de llegadas
+    if (config.max_autos_por_calle < 0) {
+        fprintf(stderr, "ERROR: max_autos_por_calle debe ser 0 (sin tope) o positivo (actual: %d)\n", 
                 config.max_autos_por_calle);
         errores++;
     }
     
+    if (config.tiempo_limite_simulacion < 0.0 || config.tiempo_limite_simulacion > TIEMPO_LIMITE_MAXIMO) {
+        fprintf(stderr, "ERROR: tiempo_limite_simulacion debe estar entre 0 (sin límite) y %.0fs (actual: %.1f)\n", 
+                TIEMPO_LIMITE_MAXIMO, config.tiempo_limite_simulacion);
+        errores++;
+    }
+    
+    if (config.max_autos_por_calle == 0 && config.tiempo_limite_simulacion == 0.0) {
+        fprintf(stderr, "ERROR: Sin tope de vehículos hace falta un tiempo límite de llegadas\n");
+        errores++;
+    }
+    
     // Validar longitudes de calles
     if (config.longitud_calle_ns < 50.0 || config.longitud_calle_ns > 2000.0) {
         fprintf(stderr, "ERROR: longitud_calle_ns debe estar entre 50 y 2000m (actual: %.1f)\n", 
@@ -1359,7 +4349,24 @@ int validar_configuracion_interseccion() {
                 config.intervalo_entrada_vehiculos);
         errores++;
     }
-    
+
+    if (config.num_hilos < 0 || config.num_hilos > MAX_HILOS) {
+        fprintf(stderr, "ERROR: num_hilos debe estar entre 0 (por defecto) y %d (actual: %d)\n",
+                MAX_HILOS, config.num_hilos);
+        errores++;
+    } else if (config.num_hilos > omp_get_num_procs()) {
+        printf("ADVERTENCIA: %d threads para %d núcleos; la barrera entre pasos TICK espera a threads sin CPU.\n",
+               config.num_hilos, omp_get_num_procs());
+    }
+
+    // Los procesos lógicos solo se comunican la ocupación y la fase; las
+    // reservas dependen del orden global de las solicitudes
+    if ((config.modo_simulacion == MODO_CONSERVADOR || config.modo_simulacion == MODO_OPTIMISTA) &&
+        config.control_interseccion != CONTROL_SEMAFORO) {
+        fprintf(stderr, "ERROR: Los modos de procesos lógicos requieren el control por semáforo\n");
+        errores++;
+    }
+
     // Validar parámetros físicos
     if (params.velocidad_maxima <= 0 || params.velocidad_maxima > 30.0) {
         fprintf(stderr, "ERROR: velocidad_maxima debe estar entre 1 y 30 m/s (actual: %.1f)\n", 
@@ -1407,17 +4414,20 @@ int validar_configuracion_interseccion() {
                distancia_frenado, distancia_disponible_eo);
     }
     
-    // Estimación de memoria
-    size_t memoria_estimada = config.max_autos_por_calle * 2 * sizeof(Vehiculo) + 
-                             config.max_autos_por_calle * 2 * sizeof(Vehiculo*) + 
+    // Estimación de memoria: la ocupan los vehículos que caben a la vez en las
+    // calles, no el total de la corrida
+    double espacio_vehiculo = params.longitud_vehiculo + params.distancia_seguridad_min;
+    size_t max_simultaneos = (size_t)((config.longitud_calle_ns + config.longitud_calle_eo) / espacio_vehiculo) + 2;
+    size_t memoria_estimada = max_simultaneos * (sizeof(Vehiculo) + 2 * (8 * sizeof(double) + 2 * sizeof(int) + sizeof(Vehiculo*))) + 
                              sizeof(SistemaInterseccion);
     double memoria_mb = memoria_estimada / (1024.0 * 1024.0);
     
     if (memoria_mb > 200.0) {
         printf("ADVERTENCIA: Memoria estimada: %.1f MB. Simulación puede ser lenta.\n", memoria_mb);
     } else {
-        printf("Memoria estimada: %.2f MB\n", memoria_mb);
+        printf("Memoria estimada: %.2f MB (hasta %zu vehículos a la vez)\n", memoria_mb, max_simultaneos);
     }
+    printf("Vehículos previstos: %lld por calle\n", vehiculos_previstos_por_calle());
     
     if (errores > 0) {
         fprintf(stderr, "\nSe encontraron %d errores en la configuración.\n", errores);
@@ -1440,8 +4450,8 @@ void configurar_interseccion() {
     if (respuesta == 's' || respuesta == 'S') {
         printf("\n--- CONFIGURACIÓN DE VEHÍCULOS ---\n");
         config.max_autos_por_calle = leer_entero_validado_interseccion(
-            "Número máximo de autos por calle", 
-            config.max_autos_por_calle, 1, 1000
+            "Número máximo de autos por calle (0 = sin tope, hasta el tiempo límite)", 
+            config.max_autos_por_calle, 0, MAX_AUTOS_CONFIGURABLE
         );
         
         config.intervalo_entrada_vehiculos = leer_double_validado_interseccion(
@@ -1449,6 +4459,11 @@ void configurar_interseccion() {
             config.intervalo_entrada_vehiculos, 0.1, 10.0
         );
         
+        config.tiempo_limite_simulacion = leer_double_validado_interseccion(
+            "Tiempo límite de llegadas (segundos, 0 = sin límite)",
+            config.tiempo_limite_simulacion, 0.0, TIEMPO_LIMITE_MAXIMO
+        );
+        
         printf("\n--- CONFIGURACIÓN DE CALLES ---\n");
         config.longitud_calle_ns = leer_double_validado_interseccion(
             "Longitud de la calle Norte-Sur (metros)",
@@ -1529,6 +4544,32 @@ void configurar_interseccion() {
                 "Distancia mínima de seguridad (metros)",
                 params.distancia_seguridad_min, 1.0, 15.0
             );
+            
+            config.modo_simulacion = leer_entero_validado_interseccion(
+                "Modo de simulación (0 = evento por vehículo, 1 = TICK global paralelo, 2 = procesos lógicos conservadores, "
+                "3 = Time Warp optimista)",
+                config.modo_simulacion, MODO_EVENTOS, MODO_OPTIMISTA
+            );
+            
+            config.formato_trazas = leer_entero_validado_interseccion(
+                "Formato de trazas de estados (0 = CSV, 1 = binario .trz)",
+                config.formato_trazas, FORMATO_TRAZA_CSV, FORMATO_TRAZA_BINARIO
+            );
+            
+            config.modo_avance = leer_entero_validado_interseccion(
+                "Avance en flujo libre y colas detenidas, modo evento (0 = paso fijo, 1 = analítico)",
+                config.modo_avance, AVANCE_PASO_FIJO, AVANCE_ANALITICO
+            );
+            
+            config.control_interseccion = leer_entero_validado_interseccion(
+                "Control de la intersección (0 = semáforo, 1 = reservas de cruce)",
+                config.control_interseccion, CONTROL_SEMAFORO, CONTROL_RESERVAS
+            );
+            
+            config.num_hilos = leer_entero_validado_interseccion(
+                "Threads OpenMP para los modos TICK, conservador y optimista (0 = los de OMP_NUM_THREADS o todos los núcleos)",
+                config.num_hilos, 0, MAX_HILOS
+            );
         }
         
         printf("\n--- VALIDANDO CONFIGURACIÓN ---\n");
@@ -1547,18 +4588,42 @@ void configurar_interseccion() {
     
     // Mostrar configuración final
     printf("\n=== CONFIGURACIÓN FINAL ===\n");
-    printf("Vehículos por calle: %d\n", config.max_autos_por_calle);
+    if (config.max_autos_por_calle > 0) {
+        printf("Vehículos por calle: %d\n", config.max_autos_por_calle);
+    } else {
+        printf("Vehículos por calle: sin tope\n");
+    }
+    if (config.tiempo_limite_simulacion > 0.0) {
+        printf("Llegadas hasta: %.1f s (los que entraron completan el recorrido)\n", config.tiempo_limite_simulacion);
+    }
     printf("Longitud Norte-Sur: %.1f m\n", config.longitud_calle_ns);
     printf("Longitud Este-Oeste: %.1f m\n", config.longitud_calle_eo);
     printf("Posición intersección: %.1f m\n", config.posicion_interseccion);
     printf("Ancho intersección: %.1f m\n", config.ancho_interseccion);
     printf("Velocidad máxima: %.1f m/s (%.1f km/h)\n", 
            params.velocidad_maxima, params.velocidad_maxima * 3.6);
-    printf("Semáforo NS: %.1fs, EO: %.1fs, Transición: %.1fs\n", 
-           semaforo.duracion_ns_verde, semaforo.duracion_eo_verde, semaforo.duracion_transicion);
+    if (config.control_interseccion == CONTROL_RESERVAS) {
+        printf("Control: reservas de cruce (ranuras de %.2f s)\n", ANCHO_RANURA_RESERVA);
+    } else {
+        printf("Semáforo NS: %.1fs, EO: %.1fs, Transición: %.1fs\n", 
+               semaforo.duracion_ns_verde, semaforo.duracion_eo_verde, semaforo.duracion_transicion);
+    }
     printf("Intervalo entrada: %.1f s\n", config.intervalo_entrada_vehiculos);
     printf("Paso simulación: %.3f s\n", config.paso_simulacion);
-    printf("Threads OpenMP: %d\n", omp_get_max_threads());
+    printf("Modo de simulación: %s\n", (config.modo_simulacion == MODO_TICK) ? "TICK global paralelo" :
+           (config.modo_simulacion == MODO_CONSERVADOR) ? "Procesos lógicos conservadores" :
+           (config.modo_simulacion == MODO_OPTIMISTA) ? "Time Warp optimista" : "Evento por vehículo");
+    printf("Trazas de estados: %s\n",
+           (config.formato_trazas == FORMATO_TRAZA_BINARIO) ? "binario .trz (exportar con trazaACsv)" : "CSV");
+    if (config.modo_simulacion != MODO_TICK) {
+        printf("Avance en flujo libre y colas detenidas: %s\n",
+               (config.modo_avance == AVANCE_ANALITICO) ? "analítico (la traza omite los pasos triviales)" : "paso fijo");
+    }
+    if (config.num_hilos > 0) {
+        printf("Threads OpenMP: %d\n", config.num_hilos);
+    } else {
+        printf("Threads OpenMP: %d (por defecto)\n", omp_get_max_threads());
+    }
     printf("===============================\n\n");
 }
 
@@ -1578,12 +4643,6 @@ int main() {
     printf("- Estadísticas detalladas por calle\n");
     printf("- Archivos CSV con datos completos\n\n");
     
-    // Configurar OpenMP
-    int num_threads = fmin(4, omp_get_max_threads());
-    omp_set_num_threads(num_threads);
-    
-    printf("Configurando OpenMP con %d threads\n", num_threads);
-    
     // Configuración y validación
     configurar_interseccion();
     
@@ -1592,30 +4651,37 @@ int main() {
         return 1;
     }
     
+    // Configurar OpenMP: el equipo y los buffers de trazas usan este tamaño
+    if (config.num_hilos > 0) omp_set_num_threads(config.num_hilos);
+    printf("Configurando OpenMP con %d threads (%d núcleos disponibles)\n",
+           omp_get_max_threads(), omp_get_num_procs());
+    
     // Inicializar sistema
     inicializar_sistema();
     inicializar_csv_estados();
     
     // Ejecutar simulación de forma secuencial con paralelismo controlado
     printf("Iniciando simulación de intersección...\n\n");
-    clock_t inicio = clock();
+    // Tiempo de pared: clock() suma el CPU de todos los threads
+    double inicio = omp_get_wtime();
     
-    // Ejecutar sin pragma omp parallel
+    // Abre la región paralela persistente
     procesar_eventos_interseccion_paralelo();
     
-    clock_t fin = clock();
-    double tiempo_ejecucion = ((double)(fin - inicio)) / CLOCKS_PER_SEC;
+    double tiempo_ejecucion = omp_get_wtime() - inicio;
     
     // Cerrar archivos
     cerrar_csv_estados();
     
     printf("\n=== MÉTRICAS DE RENDIMIENTO ===\n");
     printf("Tiempo de ejecución: %.3f segundos\n", tiempo_ejecucion);
-    printf("Tiempo simulado: %.2f segundos\n", interseccion.tiempo_actual);
-    printf("Factor de aceleración: %.1fx\n", interseccion.tiempo_actual / tiempo_ejecucion);
-    printf("Eventos procesados: %d\n", eventos_procesados);
+    printf("Tiempo simulado: %.2f segundos\n", vista->tiempo_actual);
+    printf("Factor de aceleración: %.1fx\n", vista->tiempo_actual / tiempo_ejecucion);
+    printf("Eventos procesados: %lld\n", eventos_procesados);
+    printf("Actualizaciones de vehículos: %lld (%.0f por segundo)\n",
+           vista->actualizaciones, vista->actualizaciones / tiempo_ejecucion);
     printf("Throughput total: %.1f vehículos/segundo\n", 
-           (double)(interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo) / interseccion.tiempo_actual);
+           (double)(interseccion.total_vehiculos_completados_ns + interseccion.total_vehiculos_completados_eo) / vista->tiempo_actual);
     
     // Limpiar sistema
     limpiar_sistema();
@@ -0,0 +1,1595 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <string.h>
+#include <omp.h>
+#include "estadisticas.h"
+
+// ============================================================================
+// RED EN CUADRÍCULA DE INTERSECCIONES
+// ============================================================================
+//
+// Generaliza paraleloPrueba.c (dos calles y un semáforo) a una red de F x C
+// intersecciones semaforizadas unidas por tramos de uno o más carriles en
+// cada sentido. Los vehículos entran por los tramos del borde, siguen recto y
+// giran como mucho una vez en alguna intersección de su camino, y salen de
+// la red por otro borde: cada recorrido pasa por varias intersecciones.
+// Cada intersección tiene su propio plan de semáforo (verdes, transición y
+// desfase de la onda verde).
+//
+// Topología: el tramo que llega a la intersección n con rumbo r es el
+// n * NUM_RUMBOS + r. Nace en la vecina de n en el rumbo opuesto o, en el
+// borde, es un tramo de entrada. Cada tramo se alimenta desde una sola
+// intersección (la de su origen), así que las entradas a un tramo siempre
+// llegan en el mismo orden.
+//
+// Avance por paso fijo, como MODO_TICK. Las filas se reparten en bandas, una
+// región por thread. Una región es dueña de sus intersecciones y de los
+// tramos que llegan a ellas: mueve sus vehículos, decide quién cruza y
+// publica la cola de cada tramo. Un vehículo que cruza hacia un tramo de
+// otra región (o de la misma) va al buzón de esa región, que lo agrega al
+// final del tramo después de la barrera. Cada paso tiene dos fases:
+//
+//  1. avanzar: cada región mueve sus tramos; el primero de cada tramo cruza
+//     si tiene verde y lugar en el tramo siguiente según la cola publicada
+//     en el paso anterior (solo puede haber avanzado, así que es seguro).
+//  2. recibir: cada región vacía los buzones dirigidos a ella, en orden de
+//     región de origen, y publica la cola de sus tramos.
+//
+// Carriles: cada carril es su propio anillo ordenado por posición, así que
+// el líder y el seguidor de cualquier posición en un carril vecino salen
+// de una búsqueda binaria. Los cambios de carril siguen MOBIL (Kesting,
+// Treiber y Helbing): el vehículo cambia si lo que gana, más una fracción
+// (cortesía) de lo que ganan o pierden el nuevo seguidor y el que queda
+// detrás de él, supera un umbral, y solo si el nuevo seguidor no tiene que
+// frenar más que un límite. Quien gira en la próxima intersección prefiere
+// el carril de ese lado. Las aceleraciones son las del mismo modelo de
+// seguimiento que mueve a los vehículos. Los cambios se deciden al final de
+// la fase 2, en cada región para sus tramos y todos sobre el mismo estado
+// (un carril no ve las decisiones de su vecino), y después se aplican en
+// orden de carril volviendo a comprobar la seguridad.
+//
+// Nada depende del orden entre threads ni del número de regiones: la
+// evolución de la red es la misma con cualquier número de threads. Las
+// estadísticas de cada región se fusionan al final (estadisticas.h).
+//
+// Réplicas: con más de una, cada thread corre réplicas completas de la
+// misma configuración con una sola región y su propia copia del estado
+// global (threadprivate), sin barreras ni memoria compartida entre ellas.
+// La réplica k usa el flujo aleatorio semilla + k, así que cada una da lo
+// mismo con cualquier número de threads, y al final se informa la media de
+// cada métrica entre réplicas con su intervalo de confianza del 95%.
+//
+// Compilar: gcc -O2 -fopenmp -o redCuadricula redCuadricula.c -lm
+
+// ============================================================================
+// DEFINICIÓN DE CONSTANTES
+// ============================================================================
+
+typedef enum {
+    RUMBO_NORTE = 0,   // Hacia la fila anterior
+    RUMBO_SUR,
+    RUMBO_ESTE,        // Hacia la columna siguiente
+    RUMBO_OESTE
+} Rumbo;
+
+#define NUM_RUMBOS 4
+
+#define GIRO_RECTO 0
+#define GIRO_DERECHA 1
+#define GIRO_IZQUIERDA 2
+
+typedef enum {
+    NORTE_SUR_VERDE,
+    ESTE_OESTE_VERDE,
+    TRANSICION
+} EstadoSemaforo;
+
+#define VEHICULOS_POR_BLOQUE 1024
+#define PERIODO_REPORTE 60.0     // Segundos simulados entre reportes de progreso
+#define MAX_HILOS 256
+#define MAX_LADO_RED 300          // Filas o columnas
+#define MAX_CARRILES 4            // Por sentido en cada tramo
+#define MAX_REPLICAS 10000
+
+// ============================================================================
+// ESTRUCTURAS DE DATOS
+// ============================================================================
+
+typedef struct {
+    int filas;
+    int columnas;
+    double longitud_tramo;        // Entre intersecciones vecinas (metros)
+    int carriles;                 // Por sentido; el 0 es el de la derecha
+    double intervalo_entrada;     // Entre llegadas de cada tramo de entrada
+    double duracion_llegadas;     // Las llegadas cierran en este instante
+    double tiempo_maximo;         // Corte aunque queden vehículos en la red
+    double paso_simulacion;
+    double proporcion_giro;       // Vehículos que giran una vez, mitad a cada lado
+    double verde_ns;
+    double verde_eo;
+    double transicion;
+    double desfase_onda;          // Desfase entre intersecciones vecinas
+    double variacion_plan;        // Variación relativa de los verdes entre intersecciones
+    int num_hilos;                // Regiones o réplicas a la vez; 0 = los threads que da OpenMP
+    int replicas;                 // Corridas independientes; 1 = una sola repartida en regiones
+    int semilla;                  // Flujo aleatorio de la primera réplica
+} ConfiguracionRed;
+
+typedef struct {
+    double velocidad_maxima;
+    double aceleracion_maxima;
+    double desaceleracion_maxima;  // Positiva
+    double distancia_seguridad_min;
+    double longitud_vehiculo;
+} ParametrosVehiculo;
+
+// MOBIL; aceleraciones en m/s^2
+typedef struct {
+    double cortesia;              // Peso de lo que ganan o pierden los demás
+    double umbral;                // Ganancia mínima para cambiar
+    double frenado_seguro;        // Lo más que puede tener que frenar el nuevo seguidor
+    double sesgo_giro;            // Hacia el carril del lado del próximo giro
+    double tiempo_entre_cambios;  // Segundos mínimos entre dos cambios del mismo vehículo
+} ParametrosCambioCarril;
+
+// Plan de una intersección: verde NS, transición, verde EO, transición
+typedef struct {
+    double verde_ns;
+    double verde_eo;
+    double transicion;
+    double desfase;
+} PlanSemaforo;
+
+// Métricas frías del vehículo; la cinemática vive en su tramo
+typedef struct Vehiculo {
+    long long id;
+    Rumbo rumbo;
+    int cruces;              // Intersecciones cruzadas
+    int giro_en;             // Cruce en el que gira
+    int giro;                // GIRO_*
+    double tiempo_entrada;
+    double tiempo_detenido;
+    double distancia;
+    double ultimo_cambio;    // Instante del último cambio de carril
+    struct Vehiculo* siguiente_libre;
+} Vehiculo;
+
+// Carriles en SoA como el AlmacenCalle de paraleloPrueba.c, todos con la
+// misma capacidad: en un carril caben a lo sumo longitud / (largo +
+// distancia mínima) vehículos. El carril l del tramo t es el
+// t * carriles + l; cada uno es un anillo ordenado por posición, con el más
+// adelantado en 'primero'.
+typedef struct {
+    double* posicion;         // [carril * capacidad + k]
+    double* velocidad;
+    Vehiculo** vehiculos;
+    int* primero;             // Por carril
+    int* num;
+    double* pub_cola;         // Posición del último al final del paso anterior; INFINITY si vacío
+    double* limite_entrada;   // Hasta dónde puede quedar el próximo que entre (región de origen)
+    double* proxima_llegada;  // Por tramo, solo los de entrada
+    long long* llegadas;      // Tramos de entrada: vehículos creados
+    int capacidad;
+    int carriles;             // Por tramo
+    int num_tramos;
+    int num_carriles;
+} AlmacenTramos;
+
+typedef struct BloqueVehiculos {
+    struct BloqueVehiculos* siguiente;
+    Vehiculo vehiculos[VEHICULOS_POR_BLOQUE];
+} BloqueVehiculos;
+
+// Vehículo que cruza hacia un tramo de otra región
+typedef struct {
+    Vehiculo* vehiculo;
+    int carril;
+    double posicion;
+    double velocidad;
+} Traspaso;
+
+typedef struct {
+    Traspaso* datos;
+    int num;
+    int capacidad;
+} Buzon;
+
+// Cambio decidido para un vehículo del tramo, entre carriles del tramo
+typedef struct {
+    Vehiculo* vehiculo;
+    int origen;
+    int destino;
+    double posicion;
+} CambioCarril;
+
+// Banda de filas [fila_inicio, fila_fin) con su pool de vehículos y sus
+// métricas. Un vehículo se crea en una región y vuelve al pool de la región
+// por la que sale.
+typedef struct {
+    int fila_inicio;
+    int fila_fin;
+    BloqueVehiculos* bloques;
+    Vehiculo* libres;
+    int num_bloques;
+
+    long long creados;
+    long long completados;
+    long long en_red;                 // Vehículos en sus tramos al final del paso
+    long long llegadas_demoradas;     // Pasos en que una llegada no tuvo lugar
+    long long actualizaciones;
+    long long traspasos_frontera;     // Cruces hacia otra región
+    long long cambios_carril;
+    int sin_memoria;
+    CambioCarril* cambios;            // Decisiones del tramo en curso
+
+    EstadisticaFlujo recorrido;
+    EstadisticaFlujo detenido;
+    EstadisticaFlujo velocidad;
+    EstadisticaFlujo cruces;
+} Region;
+
+// Métricas que resume cada réplica; entre réplicas cada una es una observación
+typedef enum {
+    REPLICA_RECORRIDO = 0,
+    REPLICA_RECORRIDO_P95,
+    REPLICA_DETENIDO,
+    REPLICA_VELOCIDAD,
+    REPLICA_COMPLETADOS,
+    REPLICA_MAXIMO_EN_RED,
+    REPLICA_CAMBIOS_CARRIL,
+    NUM_METRICAS_REPLICA
+} MetricaReplica;
+
+typedef struct {
+    int flujo;
+    int error;
+    double valores[NUM_METRICAS_REPLICA];
+    double tiempo_simulado;
+    double tiempo_ejecucion;
+} ResultadoReplica;
+
+// ============================================================================
+// VARIABLES GLOBALES
+// ============================================================================
+
+ConfiguracionRed config = {
+    .filas = 10,
+    .columnas = 10,
+    .longitud_tramo = 150.0,
+    .carriles = 2,
+    .intervalo_entrada = 4.0,
+    .duracion_llegadas = 600.0,
+    .tiempo_maximo = 3600.0,
+    .paso_simulacion = 0.5,
+    .proporcion_giro = 0.4,
+    .verde_ns = 30.0,
+    .verde_eo = 25.0,
+    .transicion = 3.0,
+    .desfase_onda = 10.0,
+    .variacion_plan = 0.2,
+    .num_hilos = 0,
+    .replicas = 1,
+    .semilla = 0
+};
+
+ParametrosVehiculo params = {
+    .velocidad_maxima = 10.0,
+    .aceleracion_maxima = 2.5,
+    .desaceleracion_maxima = 4.0,
+    .distancia_seguridad_min = 4.0,
+    .longitud_vehiculo = 5.0
+};
+
+ParametrosCambioCarril cambio = {
+    .cortesia = 0.2,
+    .umbral = 0.2,
+    .frenado_seguro = 4.0,
+    .sesgo_giro = 0.3,
+    .tiempo_entre_cambios = 3.0
+};
+
+PlanSemaforo* planes = NULL;        // Por intersección
+AlmacenTramos tramos = {0};
+int* region_de_fila = NULL;
+Region* regiones = NULL;
+int num_regiones = 0;
+Buzon* buzones = NULL;              // [origen * num_regiones + destino]
+
+double tiempo_actual = 0.0;
+long long pasos_simulados = 0;
+long long max_en_red = 0;
+uint64_t clave_flujo = 0;           // Del flujo aleatorio de la corrida; 0 en el flujo 0
+
+// Cada réplica corre en un thread con su propia red
+#pragma omp threadprivate(config, planes, tramos, region_de_fila, regiones, num_regiones, buzones, \
+                          tiempo_actual, pasos_simulados, max_en_red, clave_flujo)
+
+int en_replicas = 0;                // Sin reportes de progreso de cada corrida
+
+// ============================================================================
+// TOPOLOGÍA
+// ============================================================================
+
+static inline int num_nodos() {
+    return config.filas * config.columnas;
+}
+
+static inline Rumbo rumbo_opuesto(Rumbo r) {
+    static const Rumbo opuesto[NUM_RUMBOS] = {RUMBO_SUR, RUMBO_NORTE, RUMBO_OESTE, RUMBO_ESTE};
+    return opuesto[r];
+}
+
+static inline Rumbo rumbo_girado(Rumbo r, int giro) {
+    static const Rumbo derecha[NUM_RUMBOS] = {RUMBO_ESTE, RUMBO_OESTE, RUMBO_SUR, RUMBO_NORTE};
+    static const Rumbo izquierda[NUM_RUMBOS] = {RUMBO_OESTE, RUMBO_ESTE, RUMBO_NORTE, RUMBO_SUR};
+    if (giro == GIRO_DERECHA) return derecha[r];
+    if (giro == GIRO_IZQUIERDA) return izquierda[r];
+    return r;
+}
+
+// Intersección vecina de 'nodo' en el rumbo r, o -1 fuera de la red
+static inline int vecino(int nodo, Rumbo r) {
+    int f = nodo / config.columnas;
+    int c = nodo % config.columnas;
+    switch (r) {
+        case RUMBO_NORTE: f--; break;
+        case RUMBO_SUR:   f++; break;
+        case RUMBO_ESTE:  c++; break;
+        case RUMBO_OESTE: c--; break;
+    }
+    if (f < 0 || f >= config.filas || c < 0 || c >= config.columnas) return -1;
+    return f * config.columnas + c;
+}
+
+static inline int tramo_hacia(int nodo, Rumbo r) {
+    return nodo * NUM_RUMBOS + r;
+}
+
+static inline int nodo_de_tramo(int tramo) {
+    return tramo / NUM_RUMBOS;
+}
+
+// Tramo por el que se sale de 'nodo' con rumbo r, o -1 si se sale de la red
+static inline int tramo_saliente(int nodo, Rumbo r) {
+    int siguiente = vecino(nodo, r);
+    return (siguiente < 0) ? -1 : tramo_hacia(siguiente, r);
+}
+
+static inline int es_tramo_de_entrada(int tramo) {
+    return vecino(nodo_de_tramo(tramo), rumbo_opuesto((Rumbo)(tramo % NUM_RUMBOS))) < 0;
+}
+
+static inline int region_de_nodo(int nodo) {
+    return region_de_fila[nodo / config.columnas];
+}
+
+// Intersecciones que cruza en línea recta quien entra por el tramo
+int cruces_en_linea(int tramo) {
+    Rumbo r = (Rumbo)(tramo % NUM_RUMBOS);
+    int nodo = nodo_de_tramo(tramo);
+    int f = nodo / config.columnas;
+    int c = nodo % config.columnas;
+    switch (r) {
+        case RUMBO_NORTE: return f + 1;
+        case RUMBO_SUR:   return config.filas - f;
+        case RUMBO_ESTE:  return config.columnas - c;
+        default:          return c + 1;
+    }
+}
+
+// ============================================================================
+// DECISIONES SIN rand()
+// ============================================================================
+//
+// Los giros, los desfases de llegada y las variaciones de plan salen de un
+// hash (splitmix64) de un identificador estable, no de un generador
+// compartido: cada decisión es la misma con cualquier número de threads y
+// cualquier reparto de regiones.
+//
+// El hash es un generador basado en contador, como Philox: el identificador
+// y la sal son el contador y la clave del flujo lo cifra. Cada réplica usa
+// otro flujo sin jumps ni estado que avanzar. Los planes de los semáforos
+// son parte del escenario y no cambian con el flujo.
+
+static inline uint64_t mezclar(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Uniforme en [0, 1)
+static inline double uniforme(uint64_t clave, uint64_t sal) {
+    return (mezclar(clave * 0x100000001B3ULL + sal) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Como uniforme, en el flujo de la corrida
+static inline double uniforme_en_flujo(uint64_t clave, uint64_t sal) {
+    return (mezclar((clave * 0x100000001B3ULL + sal) ^ clave_flujo) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// El flujo 0 deja la entrada del hash como está
+void fijar_flujo(int flujo) {
+    clave_flujo = mezclar((uint64_t)flujo) ^ mezclar(0);
+}
+
+// ============================================================================
+// SEMÁFOROS
+// ============================================================================
+
+void iniciar_planes() {
+    for (int n = 0; n < num_nodos(); n++) {
+        int f = n / config.columnas;
+        int c = n % config.columnas;
+        PlanSemaforo* p = &planes[n];
+        double variacion_ns = 1.0 + config.variacion_plan * (2.0 * uniforme(n, 1) - 1.0);
+        double variacion_eo = 1.0 + config.variacion_plan * (2.0 * uniforme(n, 2) - 1.0);
+        p->verde_ns = config.verde_ns * variacion_ns;
+        p->verde_eo = config.verde_eo * variacion_eo;
+        p->transicion = config.transicion;
+        // Onda verde en diagonal
+        double ciclo = p->verde_ns + p->verde_eo + 2.0 * p->transicion;
+        p->desfase = fmod((f + c) * config.desfase_onda, ciclo);
+    }
+}
+
+// El plan es cíclico y no depende del tráfico: la fase sale del instante
+static inline EstadoSemaforo fase_en(const PlanSemaforo* p, double t) {
+    double ciclo = p->verde_ns + p->verde_eo + 2.0 * p->transicion;
+    double u = fmod(t + p->desfase, ciclo);
+    if (u < p->verde_ns) return NORTE_SUR_VERDE;
+    u -= p->verde_ns;
+    if (u < p->transicion) return TRANSICION;
+    u -= p->transicion;
+    if (u < p->verde_eo) return ESTE_OESTE_VERDE;
+    return TRANSICION;
+}
+
+static inline int tiene_verde(const PlanSemaforo* p, Rumbo r, double t) {
+    EstadoSemaforo fase = fase_en(p, t);
+    if (r == RUMBO_NORTE || r == RUMBO_SUR) return fase == NORTE_SUR_VERDE;
+    return fase == ESTE_OESTE_VERDE;
+}
+
+// ============================================================================
+// MEMORIA: TRAMOS, POOLS Y BUZONES
+// ============================================================================
+
+static inline int carril_de(int tramo, int l) {
+    return tramo * tramos.carriles + l;
+}
+
+static inline int tramo_de_carril(int carril) {
+    return carril / tramos.carriles;
+}
+
+static inline int indice_en_carril(int carril, int k) {
+    int i = tramos.primero[carril] + k;
+    if (i >= tramos.capacidad) i -= tramos.capacidad;
+    return carril * tramos.capacidad + i;
+}
+
+// Lugar del carril para la posición x: el primero que no está delante de x.
+// Quien quede en x tiene de líder al k - 1 y de seguidor al k.
+int buscar_en_carril(int carril, double x) {
+    int desde = 0, hasta = tramos.num[carril];
+    while (desde < hasta) {
+        int medio = (desde + hasta) / 2;
+        if (tramos.posicion[indice_en_carril(carril, medio)] > x) {
+            desde = medio + 1;
+        } else {
+            hasta = medio;
+        }
+    }
+    return desde;
+}
+
+// Inserta en el lugar k corriendo hacia atrás a los que siguen
+void insertar_en_carril(int carril, int k, Vehiculo* v, double posicion, double velocidad) {
+    for (int j = tramos.num[carril]; j > k; j--) {
+        int a = indice_en_carril(carril, j);
+        int b = indice_en_carril(carril, j - 1);
+        tramos.vehiculos[a] = tramos.vehiculos[b];
+        tramos.posicion[a] = tramos.posicion[b];
+        tramos.velocidad[a] = tramos.velocidad[b];
+    }
+    int i = indice_en_carril(carril, k);
+    tramos.vehiculos[i] = v;
+    tramos.posicion[i] = posicion;
+    tramos.velocidad[i] = velocidad;
+    tramos.num[carril]++;
+}
+
+// Quita el del lugar k; el primero sale sin mover a nadie
+void quitar_de_carril(int carril, int k) {
+    int n = tramos.num[carril];
+    if (k == 0) {
+        tramos.vehiculos[indice_en_carril(carril, 0)] = NULL;
+        tramos.primero[carril] = (tramos.primero[carril] + 1) % tramos.capacidad;
+    } else {
+        for (int j = k; j < n - 1; j++) {
+            int a = indice_en_carril(carril, j);
+            int b = indice_en_carril(carril, j + 1);
+            tramos.vehiculos[a] = tramos.vehiculos[b];
+            tramos.posicion[a] = tramos.posicion[b];
+            tramos.velocidad[a] = tramos.velocidad[b];
+        }
+        tramos.vehiculos[indice_en_carril(carril, n - 1)] = NULL;
+    }
+    tramos.num[carril]--;
+}
+
+int crear_tramos() {
+    int n = num_nodos() * NUM_RUMBOS;
+    int m = n * config.carriles;
+    int capacidad = (int)(config.longitud_tramo / (params.longitud_vehiculo + params.distancia_seguridad_min)) + 2;
+    size_t celdas = (size_t)m * capacidad;
+
+    tramos.num_tramos = n;
+    tramos.carriles = config.carriles;
+    tramos.num_carriles = m;
+    tramos.capacidad = capacidad;
+    tramos.posicion = (double*)malloc(celdas * sizeof(double));
+    tramos.velocidad = (double*)malloc(celdas * sizeof(double));
+    tramos.vehiculos = (Vehiculo**)calloc(celdas, sizeof(Vehiculo*));
+    tramos.primero = (int*)calloc(m, sizeof(int));
+    tramos.num = (int*)calloc(m, sizeof(int));
+    tramos.pub_cola = (double*)malloc(m * sizeof(double));
+    tramos.limite_entrada = (double*)malloc(m * sizeof(double));
+    tramos.proxima_llegada = (double*)malloc(n * sizeof(double));
+    tramos.llegadas = (long long*)calloc(n, sizeof(long long));
+    if (!tramos.posicion || !tramos.velocidad || !tramos.vehiculos || !tramos.primero || !tramos.num ||
+        !tramos.pub_cola || !tramos.limite_entrada || !tramos.proxima_llegada || !tramos.llegadas) {
+        return 0;
+    }
+
+    for (int c = 0; c < m; c++) {
+        tramos.pub_cola[c] = INFINITY;
+        tramos.limite_entrada[c] = INFINITY;
+    }
+    for (int t = 0; t < n; t++) {
+        // Las llegadas de los distintos bordes no coinciden
+        tramos.proxima_llegada[t] = es_tramo_de_entrada(t) ? uniforme_en_flujo(t, 3) * config.intervalo_entrada : INFINITY;
+    }
+    return 1;
+}
+
+void liberar_tramos() {
+    free(tramos.posicion);
+    free(tramos.velocidad);
+    free(tramos.vehiculos);
+    free(tramos.primero);
+    free(tramos.num);
+    free(tramos.pub_cola);
+    free(tramos.limite_entrada);
+    free(tramos.proxima_llegada);
+    free(tramos.llegadas);
+    memset(&tramos, 0, sizeof(tramos));
+}
+
+// Cada región usa su pool sin lock: solo su thread lo toca
+Vehiculo* obtener_vehiculo(Region* reg) {
+    if (!reg->libres) {
+        BloqueVehiculos* bloque = (BloqueVehiculos*)malloc(sizeof(BloqueVehiculos));
+        if (!bloque) return NULL;
+        bloque->siguiente = reg->bloques;
+        reg->bloques = bloque;
+        reg->num_bloques++;
+        for (int i = VEHICULOS_POR_BLOQUE - 1; i >= 0; i--) {
+            bloque->vehiculos[i].siguiente_libre = reg->libres;
+            reg->libres = &bloque->vehiculos[i];
+        }
+    }
+    Vehiculo* v = reg->libres;
+    reg->libres = v->siguiente_libre;
+    memset(v, 0, sizeof(Vehiculo));
+    return v;
+}
+
+void devolver_vehiculo(Region* reg, Vehiculo* v) {
+    v->siguiente_libre = reg->libres;
+    reg->libres = v;
+}
+
+static inline void buzon_agregar(Buzon* b, const Traspaso* t, Region* reg) {
+    if (b->num == b->capacidad) {
+        int nueva = (b->capacidad > 0) ? b->capacidad * 2 : 256;
+        Traspaso* datos = (Traspaso*)realloc(b->datos, nueva * sizeof(Traspaso));
+        if (!datos) {
+            reg->sin_memoria = 1;
+            return;
+        }
+        b->datos = datos;
+        b->capacidad = nueva;
+    }
+    b->datos[b->num++] = *t;
+}
+
+// Bandas de filas lo más parejas posible
+int crear_regiones(int hilos) {
+    num_regiones = (hilos < config.filas) ? hilos : config.filas;
+    regiones = (Region*)calloc(num_regiones, sizeof(Region));
+    region_de_fila = (int*)malloc(config.filas * sizeof(int));
+    buzones = (Buzon*)calloc((size_t)num_regiones * num_regiones, sizeof(Buzon));
+    if (!regiones || !region_de_fila || !buzones) return 0;
+
+    for (int r = 0; r < num_regiones; r++) {
+        Region* reg = &regiones[r];
+        // A lo sumo un cambio por vehículo del tramo
+        reg->cambios = (CambioCarril*)malloc((size_t)tramos.carriles * tramos.capacidad * sizeof(CambioCarril));
+        if (!reg->cambios) return 0;
+        reg->fila_inicio = (int)((long long)config.filas * r / num_regiones);
+        reg->fila_fin = (int)((long long)config.filas * (r + 1) / num_regiones);
+        for (int f = reg->fila_inicio; f < reg->fila_fin; f++) region_de_fila[f] = r;
+        estadistica_iniciar(&reg->recorrido);
+        estadistica_iniciar(&reg->detenido);
+        estadistica_iniciar(&reg->velocidad);
+        estadistica_iniciar(&reg->cruces);
+    }
+    return 1;
+}
+
+// También tras un crear_regiones fallido: num_regiones ya está fijado aunque
+// 'regiones' o 'buzones' no se hayan podido reservar
+void liberar_regiones() {
+    for (int r = 0; regiones && r < num_regiones; r++) {
+        while (regiones[r].bloques) {
+            BloqueVehiculos* siguiente = regiones[r].bloques->siguiente;
+            free(regiones[r].bloques);
+            regiones[r].bloques = siguiente;
+        }
+        free(regiones[r].cambios);
+    }
+    for (int b = 0; buzones && b < num_regiones * num_regiones; b++) free(buzones[b].datos);
+    free(buzones);
+    free(regiones);
+    free(region_de_fila);
+    buzones = NULL;
+    regiones = NULL;
+    region_de_fila = NULL;
+    num_regiones = 0;
+}
+
+// Planes, tramos y regiones de una corrida
+int preparar_red(int hilos) {
+    planes = (PlanSemaforo*)malloc(num_nodos() * sizeof(PlanSemaforo));
+    if (!planes || !crear_tramos() || !crear_regiones(hilos)) return 0;
+    iniciar_planes();
+    return 1;
+}
+
+void liberar_red() {
+    liberar_regiones();
+    liberar_tramos();
+    free(planes);
+    planes = NULL;
+}
+
+// ============================================================================
+// MOVIMIENTO DE LOS VEHÍCULOS
+// ============================================================================
+
+// Velocidad para el próximo paso con 'hueco' metros libres por delante:
+// la mayor que permite frenar a tiempo (Gipps) sin pasar de la máxima
+static inline double velocidad_segura(double velocidad, double hueco, double dt) {
+    double v = velocidad + params.aceleracion_maxima * dt;
+    if (v > params.velocidad_maxima) v = params.velocidad_maxima;
+    if (hueco < INFINITY) {
+        double b = params.desaceleracion_maxima;
+        double h = (hueco > 0.0) ? hueco : 0.0;
+        double frenado = -b * dt + sqrt(b * b * dt * dt + 2.0 * b * h);
+        if (frenado < v) v = frenado;
+    }
+    return (v > 0.0) ? v : 0.0;
+}
+
+// Huecos de quien está en 'posicion' detrás de un líder: el físico y el que
+// usa para elegir velocidad, porque el líder también necesita frenar
+static inline double hueco_tras(double posicion, double lider_posicion, double lider_velocidad,
+                                double* hueco_fisico) {
+    double separacion = params.longitud_vehiculo + params.distancia_seguridad_min;
+    *hueco_fisico = lider_posicion - separacion - posicion;
+    return *hueco_fisico + lider_velocidad * lider_velocidad / (2.0 * params.desaceleracion_maxima);
+}
+
+// Velocidad del próximo paso sin pasar del hueco físico; deja el avance
+static inline double paso_con_hueco(double velocidad, double hueco, double hueco_fisico, double dt,
+                                    double* avance) {
+    double v = velocidad_segura(velocidad, hueco, dt);
+    *avance = v * dt;
+    if (*avance > hueco_fisico) {
+        *avance = (hueco_fisico > 0.0) ? hueco_fisico : 0.0;
+        v = *avance / dt;
+    }
+    return v;
+}
+
+// Rumbo con el que el vehículo sale de la próxima intersección
+static inline Rumbo rumbo_al_cruzar(const Vehiculo* v) {
+    return (v->cruces == v->giro_en) ? rumbo_girado(v->rumbo, v->giro) : v->rumbo;
+}
+
+// Carril del tramo siguiente con más lugar para quien entra ahora; el mismo
+// índice si empatan. -1 si ninguno tiene lugar.
+static inline int carril_de_entrada(int tramo, int preferido) {
+    if (preferido >= tramos.carriles) preferido = tramos.carriles - 1;
+    int mejor = carril_de(tramo, preferido);
+    for (int l = 0; l < tramos.carriles; l++) {
+        int c = carril_de(tramo, l);
+        if (tramos.limite_entrada[c] > tramos.limite_entrada[mejor]) mejor = c;
+    }
+    return (tramos.limite_entrada[mejor] >= 0.0) ? mejor : -1;
+}
+
+// Hay lugar después del cruce en algún carril: fuera de la red siempre
+static inline int hay_lugar(const Vehiculo* v, int nodo) {
+    int siguiente = tramo_saliente(nodo, rumbo_al_cruzar(v));
+    return siguiente < 0 || carril_de_entrada(siguiente, 0) >= 0;
+}
+
+// Lo que le queda hasta detenerse en la línea; INFINITY si puede cruzar
+static inline double hasta_la_linea(const Vehiculo* v, double posicion, int verde, int nodo) {
+    return (verde && hay_lugar(v, nodo)) ? INFINITY : config.longitud_tramo - posicion;
+}
+
+void salir_de_la_red(Region* reg, Vehiculo* v) {
+    double recorrido = tiempo_actual - v->tiempo_entrada;
+    estadistica_agregar(&reg->recorrido, recorrido);
+    estadistica_agregar(&reg->detenido, v->tiempo_detenido);
+    estadistica_agregar(&reg->velocidad, (recorrido > 0.0) ? v->distancia / recorrido : 0.0);
+    estadistica_agregar(&reg->cruces, v->cruces);
+    reg->completados++;
+    devolver_vehiculo(reg, v);
+}
+
+// El primero del carril pasa la intersección: sale de la red o va al buzón
+// de la región dueña del tramo siguiente
+void cruzar(Region* reg, int r, int carril, int nodo) {
+    int i = indice_en_carril(carril, 0);
+    Vehiculo* v = tramos.vehiculos[i];
+    double sobrante = tramos.posicion[i] - config.longitud_tramo;
+    double velocidad = tramos.velocidad[i];
+    quitar_de_carril(carril, 0);
+
+    v->rumbo = rumbo_al_cruzar(v);
+    v->cruces++;
+    int siguiente = tramo_saliente(nodo, v->rumbo);
+    if (siguiente < 0) {
+        salir_de_la_red(reg, v);
+        return;
+    }
+
+    // Es el único que alimenta ese tramo en este paso
+    int destino_carril = carril_de_entrada(siguiente, carril % tramos.carriles);
+    double limite = tramos.limite_entrada[destino_carril];
+    double posicion = (sobrante < limite) ? sobrante : limite;
+    tramos.limite_entrada[destino_carril] = posicion - params.longitud_vehiculo - params.distancia_seguridad_min;
+
+    int destino = region_de_nodo(nodo_de_tramo(siguiente));
+    if (destino != r) reg->traspasos_frontera++;
+    Traspaso t = {v, destino_carril, posicion, velocidad};
+    buzon_agregar(&buzones[r * num_regiones + destino], &t, reg);
+}
+
+// Un paso de los vehículos del carril, del primero al último. Cada uno sigue
+// a su líder ya movido; el primero se detiene en la línea de la intersección
+// salvo que tenga verde y lugar del otro lado.
+void avanzar_carril(Region* reg, int r, int carril, int nodo, double dt) {
+    int n = tramos.num[carril];
+    if (n == 0) return;
+
+    Rumbo rumbo = (Rumbo)(tramo_de_carril(carril) % NUM_RUMBOS);
+    const PlanSemaforo* plan = &planes[nodo];
+    int verde = tiene_verde(plan, rumbo, tiempo_actual);
+    double lider_posicion = 0.0, lider_velocidad = 0.0;
+
+    for (int k = 0; k < n; k++) {
+        int i = indice_en_carril(carril, k);
+        Vehiculo* v = tramos.vehiculos[i];
+        double posicion = tramos.posicion[i];
+
+        double hueco, hueco_fisico;
+        if (k == 0) {
+            hueco = hueco_fisico = hasta_la_linea(v, posicion, verde, nodo);
+        } else {
+            hueco = hueco_tras(posicion, lider_posicion, lider_velocidad, &hueco_fisico);
+        }
+
+        double avance;
+        double velocidad = paso_con_hueco(tramos.velocidad[i], hueco, hueco_fisico, dt, &avance);
+
+        tramos.posicion[i] = posicion + avance;
+        tramos.velocidad[i] = velocidad;
+        v->distancia += avance;
+        if (velocidad < 0.1) v->tiempo_detenido += dt;
+        lider_posicion = tramos.posicion[i];
+        lider_velocidad = velocidad;
+    }
+    reg->actualizaciones += n;
+
+    // Los que pasaron la línea cruzan; uno que la pasó detrás de otro sin
+    // haber pedido paso espera en ella
+    while (tramos.num[carril] > 0) {
+        int i = indice_en_carril(carril, 0);
+        if (tramos.posicion[i] <= config.longitud_tramo) break;
+        if (!verde || !hay_lugar(tramos.vehiculos[i], nodo)) {
+            tramos.posicion[i] = config.longitud_tramo;
+            tramos.velocidad[i] = 0.0;
+            break;
+        }
+        cruzar(reg, r, carril, nodo);
+    }
+}
+
+// Llegada por un tramo de entrada, al carril con la cola más adelantada; si
+// no hay lugar espera al próximo paso
+void generar_llegada(Region* reg, int tramo) {
+    if (tiempo_actual < tramos.proxima_llegada[tramo] || tiempo_actual >= config.duracion_llegadas) return;
+
+    double separacion = params.longitud_vehiculo + params.distancia_seguridad_min;
+    int carril = carril_de(tramo, 0);
+    double cola = INFINITY;
+    for (int l = 0; l < tramos.carriles; l++) {
+        int c = carril_de(tramo, l);
+        double cola_c = (tramos.num[c] > 0) ? tramos.posicion[indice_en_carril(c, tramos.num[c] - 1)] : INFINITY;
+        if (l == 0 || cola_c > cola) {
+            carril = c;
+            cola = cola_c;
+        }
+    }
+    int n = tramos.num[carril];
+    if (n > 0 && cola < separacion) {
+        reg->llegadas_demoradas++;
+        return;
+    }
+    if (n == tramos.capacidad) return;
+
+    Vehiculo* v = obtener_vehiculo(reg);
+    if (!v) {
+        reg->sin_memoria = 1;
+        return;
+    }
+
+    // Identificador estable: no depende del reparto en regiones
+    long long k = tramos.llegadas[tramo]++;
+    v->id = k * tramos.num_tramos + tramo;
+    v->rumbo = (Rumbo)(tramo % NUM_RUMBOS);
+    v->tiempo_entrada = tiempo_actual;
+    v->ultimo_cambio = -INFINITY;
+    double u = uniforme_en_flujo((uint64_t)v->id, 4);
+    if (u < config.proporcion_giro) {
+        v->giro = (u < config.proporcion_giro / 2.0) ? GIRO_DERECHA : GIRO_IZQUIERDA;
+        v->giro_en = (int)(uniforme_en_flujo((uint64_t)v->id, 5) * cruces_en_linea(tramo));
+    } else {
+        v->giro = GIRO_RECTO;
+        v->giro_en = -1;
+    }
+
+    insertar_en_carril(carril, n, v, 0.0, 0.0);
+    reg->creados++;
+    tramos.proxima_llegada[tramo] += config.intervalo_entrada;
+}
+
+// ============================================================================
+// CAMBIOS DE CARRIL (MOBIL)
+// ============================================================================
+
+// Aceleración del próximo paso de quien va en 'posicion' a 'velocidad' con
+// el lugar k_lider del carril por delante; sin líder (k_lider < 0) frena
+// para la línea a 'linea' metros
+static inline double aceleracion_en_carril(double posicion, double velocidad, int carril, int k_lider,
+                                           double linea, double dt) {
+    double hueco, hueco_fisico, avance;
+    if (k_lider < 0) {
+        hueco = hueco_fisico = linea;
+    } else {
+        int i = indice_en_carril(carril, k_lider);
+        hueco = hueco_tras(posicion, tramos.posicion[i], tramos.velocidad[i], &hueco_fisico);
+    }
+    return (paso_con_hueco(velocidad, hueco, hueco_fisico, dt, &avance) - velocidad) / dt;
+}
+
+// Aceleración de quien va en 'posicion' detrás de otro en (lider_posicion,
+// lider_velocidad), esté o no en su carril
+static inline double aceleracion_tras(double posicion, double velocidad, double lider_posicion,
+                                      double lider_velocidad, double dt) {
+    double hueco_fisico, avance;
+    double hueco = hueco_tras(posicion, lider_posicion, lider_velocidad, &hueco_fisico);
+    return (paso_con_hueco(velocidad, hueco, hueco_fisico, dt, &avance) - velocidad) / dt;
+}
+
+// Carril del lado del giro si gira en la próxima intersección; -1 si sigue recto
+static inline int carril_del_giro(const Vehiculo* v) {
+    if (v->cruces != v->giro_en || v->giro == GIRO_RECTO) return -1;
+    return (v->giro == GIRO_DERECHA) ? 0 : tramos.carriles - 1;
+}
+
+// Quien quede en 'posicion' en el carril destino tiene lugar físico y el
+// nuevo seguidor no frena más de lo seguro. Deja en *k su lugar y en
+// *ganancia_seguidor lo que cambia la aceleración del nuevo seguidor.
+int cambio_seguro(int destino, double posicion, double velocidad, int verde, int nodo, double dt,
+                  int* k, double* ganancia_seguidor) {
+    double separacion = params.longitud_vehiculo + params.distancia_seguridad_min;
+    int n = tramos.num[destino];
+    if (n == tramos.capacidad) return 0;
+
+    int j = buscar_en_carril(destino, posicion);
+    if (j > 0 && tramos.posicion[indice_en_carril(destino, j - 1)] - separacion < posicion) return 0;
+
+    *ganancia_seguidor = 0.0;
+    if (j < n) {
+        int i = indice_en_carril(destino, j);
+        double seguidor_posicion = tramos.posicion[i];
+        double seguidor_velocidad = tramos.velocidad[i];
+        if (posicion - separacion < seguidor_posicion) return 0;
+        double despues = aceleracion_tras(seguidor_posicion, seguidor_velocidad, posicion, velocidad, dt);
+        if (despues < -cambio.frenado_seguro) return 0;
+        double linea = (j == 0) ? hasta_la_linea(tramos.vehiculos[i], seguidor_posicion, verde, nodo) : 0.0;
+        double antes = aceleracion_en_carril(seguidor_posicion, seguidor_velocidad, destino, j - 1, linea, dt);
+        *ganancia_seguidor = despues - antes;
+    }
+    *k = j;
+    return 1;
+}
+
+// Decide con el estado al final del paso todos los cambios del tramo y
+// después los aplica en orden de carril; cada cambio se vuelve a comprobar
+// porque otro del mismo tramo pudo ocupar el lugar
+void cambiar_carriles(Region* reg, int tramo, double dt) {
+    int nodo = nodo_de_tramo(tramo);
+    int verde = tiene_verde(&planes[nodo], (Rumbo)(tramo % NUM_RUMBOS), tiempo_actual);
+    int num_cambios = 0;
+
+    for (int l = 0; l < tramos.carriles; l++) {
+        int carril = carril_de(tramo, l);
+        int n = tramos.num[carril];
+        for (int k = 0; k < n; k++) {
+            int i = indice_en_carril(carril, k);
+            Vehiculo* v = tramos.vehiculos[i];
+            if (tiempo_actual - v->ultimo_cambio < cambio.tiempo_entre_cambios) continue;
+
+            double posicion = tramos.posicion[i];
+            double velocidad = tramos.velocidad[i];
+            // También sirve en el carril vecino si allí quedaría primero
+            double linea = hasta_la_linea(v, posicion, verde, nodo);
+            double actual = aceleracion_en_carril(posicion, velocidad, carril, k - 1, linea, dt);
+
+            // El que queda detrás gana o pierde al cambiar de líder
+            double ganancia_atras = 0.0;
+            if (k + 1 < n) {
+                int a = indice_en_carril(carril, k + 1);
+                double atras_posicion = tramos.posicion[a];
+                double atras_velocidad = tramos.velocidad[a];
+                double antes = aceleracion_tras(atras_posicion, atras_velocidad, posicion, velocidad, dt);
+                double linea_atras = (k == 0)
+                    ? hasta_la_linea(tramos.vehiculos[a], atras_posicion, verde, nodo) : 0.0;
+                double despues = aceleracion_en_carril(atras_posicion, atras_velocidad, carril, k - 1,
+                                                       linea_atras, dt);
+                ganancia_atras = despues - antes;
+            }
+
+            int preferido = carril_del_giro(v);
+            int mejor = -1;
+            double mejor_incentivo = cambio.umbral;
+            for (int lado = -1; lado <= 1; lado += 2) {
+                int l2 = l + lado;
+                if (l2 < 0 || l2 >= tramos.carriles) continue;
+                int destino = carril_de(tramo, l2);
+                int j;
+                double ganancia_seguidor;
+                if (!cambio_seguro(destino, posicion, velocidad, verde, nodo, dt, &j, &ganancia_seguidor)) continue;
+
+                double nueva = aceleracion_en_carril(posicion, velocidad, destino, j - 1, linea, dt);
+                double incentivo = nueva - actual + cambio.cortesia * (ganancia_seguidor + ganancia_atras);
+                if (preferido >= 0) {
+                    incentivo += (abs(l2 - preferido) < abs(l - preferido)) ? cambio.sesgo_giro : -cambio.sesgo_giro;
+                }
+                if (incentivo > mejor_incentivo) {
+                    mejor_incentivo = incentivo;
+                    mejor = destino;
+                }
+            }
+            if (mejor >= 0) {
+                CambioCarril c = {v, carril, mejor, posicion};
+                reg->cambios[num_cambios++] = c;
+            }
+        }
+    }
+
+    for (int m = 0; m < num_cambios; m++) {
+        CambioCarril* c = &reg->cambios[m];
+        int k = buscar_en_carril(c->origen, c->posicion);
+        int i = indice_en_carril(c->origen, k);
+        double velocidad = tramos.velocidad[i];
+        int j;
+        double ganancia_seguidor;
+        if (!cambio_seguro(c->destino, c->posicion, velocidad, verde, nodo, dt, &j, &ganancia_seguidor)) continue;
+
+        quitar_de_carril(c->origen, k);
+        insertar_en_carril(c->destino, j, c->vehiculo, c->posicion, velocidad);
+        c->vehiculo->ultimo_cambio = tiempo_actual;
+        reg->cambios_carril++;
+    }
+}
+
+// ============================================================================
+// FASES DE CADA PASO
+// ============================================================================
+
+// Fase 1: la región mueve los tramos que llegan a sus intersecciones
+void avanzar_region(int r, double dt) {
+    Region* reg = &regiones[r];
+    int nodo_inicio = reg->fila_inicio * config.columnas;
+    int nodo_fin = reg->fila_fin * config.columnas;
+    double separacion = params.longitud_vehiculo + params.distancia_seguridad_min;
+
+    for (int nodo = nodo_inicio; nodo < nodo_fin; nodo++) {
+        // Esta intersección es la única que alimenta sus tramos salientes
+        for (int s = 0; s < NUM_RUMBOS; s++) {
+            int saliente = tramo_saliente(nodo, (Rumbo)s);
+            if (saliente < 0) continue;
+            for (int l = 0; l < tramos.carriles; l++) {
+                int c = carril_de(saliente, l);
+                tramos.limite_entrada[c] = tramos.pub_cola[c] - separacion;
+            }
+        }
+        for (int s = 0; s < NUM_RUMBOS; s++) {
+            int tramo = tramo_hacia(nodo, (Rumbo)s);
+            for (int l = 0; l < tramos.carriles; l++) avanzar_carril(reg, r, carril_de(tramo, l), nodo, dt);
+            if (es_tramo_de_entrada(tramo)) generar_llegada(reg, tramo);
+        }
+    }
+}
+
+// Fase 2: agrega al final de sus carriles los que cruzaron hacia la región,
+// decide los cambios de carril y publica la cola de cada carril
+void recibir_traspasos(int r, double dt) {
+    Region* reg = &regiones[r];
+    for (int origen = 0; origen < num_regiones; origen++) {
+        Buzon* b = &buzones[origen * num_regiones + r];
+        for (int k = 0; k < b->num; k++) {
+            Traspaso* t = &b->datos[k];
+            insertar_en_carril(t->carril, tramos.num[t->carril], t->vehiculo, t->posicion, t->velocidad);
+        }
+        b->num = 0;
+    }
+
+    int tramo_inicio = reg->fila_inicio * config.columnas * NUM_RUMBOS;
+    int tramo_fin = reg->fila_fin * config.columnas * NUM_RUMBOS;
+    if (tramos.carriles > 1) {
+        for (int tramo = tramo_inicio; tramo < tramo_fin; tramo++) cambiar_carriles(reg, tramo, dt);
+    }
+
+    long long en_red = 0;
+    for (int c = carril_de(tramo_inicio, 0); c < carril_de(tramo_fin, 0); c++) {
+        int n = tramos.num[c];
+        tramos.pub_cola[c] = (n > 0) ? tramos.posicion[indice_en_carril(c, n - 1)] : INFINITY;
+        en_red += n;
+    }
+    reg->en_red = en_red;
+}
+
+// ============================================================================
+// FUNCIÓN PRINCIPAL DE SIMULACIÓN PARALELA
+// ============================================================================
+
+void simular_red() {
+    double dt = config.paso_simulacion;
+    int fin = 0;
+    double proximo_reporte = PERIODO_REPORTE;
+
+    if (!en_replicas) printf("Regiones: %d bandas de filas, un thread cada una\n", num_regiones);
+
+    // Un solo equipo para toda la corrida: dos barreras por paso. La red es
+    // threadprivate (réplicas), así que el equipo recibe la del thread que
+    // lo lanza.
+    #pragma omp parallel num_threads(num_regiones) \
+        copyin(config, planes, tramos, region_de_fila, regiones, num_regiones, buzones, \
+               tiempo_actual, pasos_simulados, clave_flujo)
+    {
+        int r = omp_get_thread_num();
+        recibir_traspasos(r, dt);
+        #pragma omp barrier
+
+        while (!fin) {
+            avanzar_region(r, dt);
+            #pragma omp barrier
+
+            recibir_traspasos(r, dt);
+            #pragma omp barrier
+
+            // Cada thread avanza su copia del reloj
+            tiempo_actual = ++pasos_simulados * dt;
+
+            #pragma omp master
+            {
+                long long en_red = 0, completados = 0, creados = 0;
+                int sin_memoria = 0;
+                for (int k = 0; k < num_regiones; k++) {
+                    en_red += regiones[k].en_red;
+                    completados += regiones[k].completados;
+                    creados += regiones[k].creados;
+                    sin_memoria |= regiones[k].sin_memoria;
+                }
+                if (en_red > max_en_red) max_en_red = en_red;
+
+                if (tiempo_actual >= proximo_reporte && !en_replicas) {
+                    printf(">>> t = %.0f s: %lld vehículos en la red, %lld creados, %lld completados <<<\n",
+                           tiempo_actual, en_red, creados, completados);
+                    proximo_reporte += PERIODO_REPORTE;
+                }
+                if (sin_memoria) {
+                    fprintf(stderr, "ERROR: Sin memoria para los vehículos de la red\n");
+                    fin = 1;
+                }
+                if ((tiempo_actual >= config.duracion_llegadas && en_red == 0) ||
+                    tiempo_actual >= config.tiempo_maximo) {
+                    fin = 1;
+                }
+            }
+            #pragma omp barrier
+        }
+    }
+}
+
+// ============================================================================
+// ESTADÍSTICAS FINALES
+// ============================================================================
+
+// Suma de los contadores y fusión de las métricas de todas las regiones
+void sumar_regiones(Region* total) {
+    memset(total, 0, sizeof(Region));
+    for (int r = 0; r < num_regiones; r++) {
+        Region* reg = &regiones[r];
+        total->creados += reg->creados;
+        total->completados += reg->completados;
+        total->en_red += reg->en_red;
+        total->llegadas_demoradas += reg->llegadas_demoradas;
+        total->actualizaciones += reg->actualizaciones;
+        total->traspasos_frontera += reg->traspasos_frontera;
+        total->cambios_carril += reg->cambios_carril;
+        total->sin_memoria |= reg->sin_memoria;
+        estadistica_fusionar(&total->recorrido, &reg->recorrido);
+        estadistica_fusionar(&total->detenido, &reg->detenido);
+        estadistica_fusionar(&total->velocidad, &reg->velocidad);
+        estadistica_fusionar(&total->cruces, &reg->cruces);
+    }
+}
+
+// Archivo de resultados junto al código fuente, como los demás simuladores
+void nombre_resultados(char* nombre_archivo, size_t tamano, const char* prefijo) {
+    char dir_path[1024];
+    strncpy(dir_path, __FILE__, sizeof(dir_path) - 1);
+    dir_path[sizeof(dir_path) - 1] = '\0';
+    char *last_sep = strrchr(dir_path, '\\');
+    if (!last_sep) last_sep = strrchr(dir_path, '/');
+    if (last_sep) {
+        *last_sep = '\0';
+    } else {
+        strcpy(dir_path, ".");
+    }
+
+    char timestamp[64];
+    time_t ahora = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", localtime(&ahora));
+    snprintf(nombre_archivo, tamano, "%s/%s_%s.csv", dir_path, prefijo, timestamp);
+}
+
+void generar_estadisticas_red(double tiempo_ejecucion) {
+    Region total;
+    sumar_regiones(&total);
+
+    printf("\n=== SIMULACIÓN DE LA RED COMPLETADA ===\n");
+    printf("Red: %d x %d intersecciones, %d tramos de %.0f m con %d carriles\n",
+           config.filas, config.columnas, tramos.num_tramos, config.longitud_tramo, tramos.carriles);
+    printf("Tiempo simulado: %.2f s en %lld pasos\n", tiempo_actual, pasos_simulados);
+    printf("Vehículos: %lld creados, %lld completados, %lld quedaron en la red, máximo %lld a la vez\n",
+           total.creados, total.completados, total.en_red, max_en_red);
+    printf("Llegadas demoradas por falta de lugar: %lld pasos\n", total.llegadas_demoradas);
+    printf("Cruces entre regiones: %lld\n", total.traspasos_frontera);
+    printf("Cambios de carril: %lld\n", total.cambios_carril);
+    for (int r = 0; r < num_regiones; r++) {
+        Region* reg = &regiones[r];
+        printf("  Región %d (filas %d-%d): %lld creados, %lld completados, %lld actualizaciones, "
+               "%lld cruces a otras regiones, %lld cambios de carril, %d bloques de vehículos\n",
+               r, reg->fila_inicio, reg->fila_fin - 1, reg->creados, reg->completados,
+               reg->actualizaciones, reg->traspasos_frontera, reg->cambios_carril, reg->num_bloques);
+    }
+    if (total.completados > 0) {
+        printf("Vehículos completados:\n");
+        estadistica_imprimir("Tiempo de recorrido", &total.recorrido, "s");
+        estadistica_imprimir("Tiempo detenido", &total.detenido, "s");
+        estadistica_imprimir("Velocidad promedio", &total.velocidad, "m/s");
+        estadistica_imprimir("Intersecciones", &total.cruces, "");
+    }
+
+    printf("\n=== MÉTRICAS DE RENDIMIENTO ===\n");
+    printf("Tiempo de ejecución: %.3f segundos\n", tiempo_ejecucion);
+    printf("Factor de aceleración: %.1fx\n", tiempo_actual / tiempo_ejecucion);
+    printf("Actualizaciones de vehículos: %lld (%.0f por segundo)\n",
+           total.actualizaciones, total.actualizaciones / tiempo_ejecucion);
+
+    char nombre_archivo[1200];
+    nombre_resultados(nombre_archivo, sizeof(nombre_archivo), "resultados_red");
+    FILE* csv = fopen(nombre_archivo, "w");
+    if (!csv) {
+        printf("ERROR: No se pudo crear archivo CSV: %s\n", nombre_archivo);
+        perror("Razón");
+        return;
+    }
+
+    fprintf(csv, "# ESTADISTICAS_RED\n");
+    fprintf(csv, "Filas,%d\nColumnas,%d\nLongitudTramo,%.2f\nCarriles,%d\n",
+            config.filas, config.columnas, config.longitud_tramo, tramos.carriles);
+    fprintf(csv, "TiempoTotal,%.2f\n", tiempo_actual);
+    fprintf(csv, "VehiculosCreados,%lld\nVehiculosCompletados,%lld\nVehiculosEnRed,%lld\nMaximoEnRed,%lld\n",
+            total.creados, total.completados, total.en_red, max_en_red);
+    fprintf(csv, "LlegadasDemoradas,%lld\nCrucesEntreRegiones,%lld\nCambiosCarril,%lld\n",
+            total.llegadas_demoradas, total.traspasos_frontera, total.cambios_carril);
+    fprintf(csv, "# REGIONES\n");
+    fprintf(csv, "Region,FilaInicio,FilaFin,Creados,Completados,Actualizaciones,CrucesAOtras,CambiosCarril\n");
+    for (int r = 0; r < num_regiones; r++) {
+        Region* reg = &regiones[r];
+        fprintf(csv, "%d,%d,%d,%lld,%lld,%lld,%lld,%lld\n", r, reg->fila_inicio, reg->fila_fin - 1,
+                reg->creados, reg->completados, reg->actualizaciones, reg->traspasos_frontera,
+                reg->cambios_carril);
+    }
+    if (total.completados > 0) {
+        fprintf(csv, "# ESTADISTICAS_FLUJO\n");
+        estadistica_csv_encabezado(csv);
+        estadistica_csv(csv, "Red", "TiempoRecorrido", &total.recorrido);
+        estadistica_csv(csv, "Red", "TiempoDetenido", &total.detenido);
+        estadistica_csv(csv, "Red", "VelocidadPromedio", &total.velocidad);
+        estadistica_csv(csv, "Red", "Intersecciones", &total.cruces);
+        fprintf(csv, "# HISTOGRAMAS\n");
+        fprintf(csv, "Grupo,Metrica,Desde,Hasta,Vehiculos\n");
+        estadistica_csv_histograma(csv, "Red", "TiempoRecorrido", &total.recorrido);
+        estadistica_csv_histograma(csv, "Red", "TiempoDetenido", &total.detenido);
+        estadistica_csv_histograma(csv, "Red", "VelocidadPromedio", &total.velocidad);
+    }
+    fclose(csv);
+    printf("\nResultados guardados en: %s\n", nombre_archivo);
+}
+
+// ============================================================================
+// RÉPLICAS INDEPENDIENTES
+// ============================================================================
+
+static const char* nombres_metricas_replica[NUM_METRICAS_REPLICA] = {
+    "TiempoRecorrido", "TiempoRecorridoP95", "TiempoDetenido", "VelocidadPromedio",
+    "Completados", "MaximoEnRed", "CambiosCarril"
+};
+
+static const char* descripciones_metricas_replica[NUM_METRICAS_REPLICA] = {
+    "Tiempo de recorrido (s)", "p95 del recorrido (s)", "Tiempo detenido (s)", "Velocidad promedio (m/s)",
+    "Vehículos completados", "Máximo en la red", "Cambios de carril"
+};
+
+// Una corrida completa en el thread que la llama, con una sola región y la
+// red en las variables threadprivate del thread
+void ejecutar_replica(int flujo, ResultadoReplica* res) {
+    memset(res, 0, sizeof(ResultadoReplica));
+    res->flujo = flujo;
+    tiempo_actual = 0.0;
+    pasos_simulados = 0;
+    max_en_red = 0;
+    fijar_flujo(flujo);
+    if (!preparar_red(1)) {
+        res->error = 1;
+        liberar_red();
+        return;
+    }
+
+    double inicio = omp_get_wtime();
+    simular_red();
+    res->tiempo_ejecucion = omp_get_wtime() - inicio;
+    res->tiempo_simulado = tiempo_actual;
+
+    Region total;
+    sumar_regiones(&total);
+    res->error = total.sin_memoria;
+    res->valores[REPLICA_RECORRIDO] = total.recorrido.media;
+    res->valores[REPLICA_RECORRIDO_P95] = estadistica_cuantil(&total.recorrido, 0.95);
+    res->valores[REPLICA_DETENIDO] = total.detenido.media;
+    res->valores[REPLICA_VELOCIDAD] = total.velocidad.media;
+    res->valores[REPLICA_COMPLETADOS] = (double)total.completados;
+    res->valores[REPLICA_MAXIMO_EN_RED] = (double)max_en_red;
+    res->valores[REPLICA_CAMBIOS_CARRIL] = (double)total.cambios_carril;
+    liberar_red();
+}
+
+// Una réplica por thread a la vez; la réplica k usa el flujo semilla + k
+void ejecutar_replicas(ResultadoReplica* resultados) {
+    int terminadas = 0;
+    en_replicas = 1;
+
+    #pragma omp parallel for schedule(dynamic, 1) copyin(config)
+    for (int k = 0; k < config.replicas; k++) {
+        ejecutar_replica(config.semilla + k, &resultados[k]);
+        #pragma omp critical
+        {
+            terminadas++;
+            printf(">>> Réplica %d (flujo %d) terminada en %.2f s: %d de %d <<<\n",
+                   k, resultados[k].flujo, resultados[k].tiempo_ejecucion, terminadas, config.replicas);
+        }
+    }
+    en_replicas = 0;
+}
+
+void generar_estadisticas_replicas(const ResultadoReplica* resultados, double tiempo_ejecucion) {
+    EstadisticaFlujo metricas[NUM_METRICAS_REPLICA];
+    for (int m = 0; m < NUM_METRICAS_REPLICA; m++) estadistica_iniciar(&metricas[m]);
+
+    // En orden de réplica: el resumen no depende de cuál terminó antes
+    int fallidas = 0;
+    double tiempo_replicas = 0.0;
+    for (int k = 0; k < config.replicas; k++) {
+        const ResultadoReplica* res = &resultados[k];
+        tiempo_replicas += res->tiempo_ejecucion;
+        if (res->error) {
+            fallidas++;
+            continue;
+        }
+        for (int m = 0; m < NUM_METRICAS_REPLICA; m++) estadistica_agregar(&metricas[m], res->valores[m]);
+    }
+
+    printf("\n=== RÉPLICAS COMPLETADAS ===\n");
+    printf("Red: %d x %d intersecciones, %d carriles, flujos %d a %d\n", config.filas, config.columnas,
+           config.carriles, config.semilla, config.semilla + config.replicas - 1);
+    printf("Réplicas: %d válidas", config.replicas - fallidas);
+    if (fallidas > 0) printf(", %d sin memoria (excluidas)", fallidas);
+    printf("\n");
+    printf("Media entre réplicas con intervalo de confianza del 95%%:\n");
+    for (int m = 0; m < NUM_METRICAS_REPLICA; m++) {
+        const EstadisticaFlujo* e = &metricas[m];
+        double ic = estadistica_ic95(e);
+        printf("  %-26s %10.2f ± %-8.2f (desv %.2f, min %.2f, max %.2f)\n", descripciones_metricas_replica[m],
+               e->media, ic, estadistica_desviacion(e), e->minimo, e->maximo);
+    }
+
+    printf("\n=== MÉTRICAS DE RENDIMIENTO ===\n");
+    printf("Tiempo de ejecución: %.3f segundos con %d threads (%.3f sumando lo que tardó cada réplica)\n",
+           tiempo_ejecucion, omp_get_max_threads(), tiempo_replicas);
+    printf("Réplicas por segundo: %.2f\n", config.replicas / tiempo_ejecucion);
+
+    char nombre_archivo[1200];
+    nombre_resultados(nombre_archivo, sizeof(nombre_archivo), "resultados_replicas");
+    FILE* csv = fopen(nombre_archivo, "w");
+    if (!csv) {
+        printf("ERROR: No se pudo crear archivo CSV: %s\n", nombre_archivo);
+        perror("Razón");
+        return;
+    }
+
+    fprintf(csv, "# ESTADISTICAS_REPLICAS\n");
+    fprintf(csv, "Filas,%d\nColumnas,%d\nLongitudTramo,%.2f\nCarriles,%d\n",
+            config.filas, config.columnas, config.longitud_tramo, config.carriles);
+    fprintf(csv, "Replicas,%d\nFallidas,%d\nPrimerFlujo,%d\n", config.replicas, fallidas, config.semilla);
+    fprintf(csv, "TiempoEjecucion,%.3f\nTiempoReplicas,%.3f\n", tiempo_ejecucion, tiempo_replicas);
+    fprintf(csv, "# REPLICAS\n");
+    fprintf(csv, "Replica,Flujo,Error,TiempoSimulado,TiempoEjecucion");
+    for (int m = 0; m < NUM_METRICAS_REPLICA; m++) fprintf(csv, ",%s", nombres_metricas_replica[m]);
+    fprintf(csv, "\n");
+    for (int k = 0; k < config.replicas; k++) {
+        const ResultadoReplica* res = &resultados[k];
+        fprintf(csv, "%d,%d,%d,%.2f,%.3f", k, res->flujo, res->error, res->tiempo_simulado, res->tiempo_ejecucion);
+        for (int m = 0; m < NUM_METRICAS_REPLICA; m++) fprintf(csv, ",%.4f", res->valores[m]);
+        fprintf(csv, "\n");
+    }
+    fprintf(csv, "# INTERVALOS\n");
+    fprintf(csv, "Metrica,N,Media,Desviacion,Minimo,Maximo,IC95Inferior,IC95Superior\n");
+    for (int m = 0; m < NUM_METRICAS_REPLICA; m++) {
+        const EstadisticaFlujo* e = &metricas[m];
+        double ic = estadistica_ic95(e);
+        fprintf(csv, "%s,%lld,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", nombres_metricas_replica[m], e->n, e->media,
+                estadistica_desviacion(e), e->minimo, e->maximo, e->media - ic, e->media + ic);
+    }
+    fclose(csv);
+    printf("\nResultados guardados en: %s\n", nombre_archivo);
+}
+
+// ============================================================================
+// CONFIGURACIÓN INTERACTIVA
+// ============================================================================
+
+int leer_entero_validado(const char* mensaje, int valor_actual, int min, int max) {
+    int valor;
+    char buffer[100];
+
+    do {
+        printf("%s (actual: %d, rango: %d-%d): ", mensaje, valor_actual, min, max);
+
+        if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
+            printf("Error de lectura. Usando valor actual.\n");
+            return valor_actual;
+        }
+
+        if (buffer[0] == '\n') {
+            return valor_actual;
+        }
+
+        if (sscanf(buffer, "%d", &valor) != 1) {
+            printf("ERROR: Debe ingresar un número entero válido.\n");
+        } else if (valor < min || valor > max) {
+            printf("ERROR: El valor debe estar entre %d y %d.\n", min, max);
+        } else {
+            return valor;
+        }
+    } while (1);
+}
+
+double leer_double_validado(const char* mensaje, double valor_actual, double min, double max) {
+    double valor;
+    char buffer[100];
+
+    do {
+        printf("%s (actual: %.2f, rango: %.2f-%.2f): ", mensaje, valor_actual, min, max);
+
+        if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
+            printf("Error de lectura. Usando valor actual.\n");
+            return valor_actual;
+        }
+
+        if (buffer[0] == '\n') {
+            return valor_actual;
+        }
+
+        if (sscanf(buffer, "%lf", &valor) != 1) {
+            printf("ERROR: Debe ingresar un número decimal válido.\n");
+        } else if (valor < min || valor > max) {
+            printf("ERROR: El valor debe estar entre %.2f y %.2f.\n", min, max);
+        } else {
+            return valor;
+        }
+    } while (1);
+}
+
+char leer_si_no(const char* mensaje) {
+    char buffer[100];
+
+    do {
+        printf("%s (s/n): ", mensaje);
+
+        if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
+            printf("Error de lectura. Usando 'n' por defecto.\n");
+            return 'n';
+        }
+
+        char respuesta = buffer[0];
+        if (respuesta == 's' || respuesta == 'S' || respuesta == 'n' || respuesta == 'N') {
+            return respuesta;
+        }
+        printf("ERROR: Debe ingresar 's' para sí o 'n' para no.\n");
+    } while (1);
+}
+
+void configurar_red() {
+    printf("\n=== CONFIGURACIÓN DE LA RED ===\n");
+    char respuesta = leer_si_no("¿Desea modificar la configuración por defecto?");
+    if (respuesta == 's' || respuesta == 'S') {
+        config.filas = leer_entero_validado("Filas de intersecciones", config.filas, 1, MAX_LADO_RED);
+        config.columnas = leer_entero_validado("Columnas de intersecciones", config.columnas, 1, MAX_LADO_RED);
+        config.longitud_tramo = leer_double_validado(
+            "Longitud de cada tramo entre intersecciones (metros)", config.longitud_tramo, 30.0, 2000.0);
+        config.carriles = leer_entero_validado("Carriles por sentido en cada tramo", config.carriles, 1, MAX_CARRILES);
+        config.intervalo_entrada = leer_double_validado(
+            "Intervalo entre llegadas por cada tramo de entrada (segundos)", config.intervalo_entrada, 0.5, 120.0);
+        config.duracion_llegadas = leer_double_validado(
+            "Llegadas abiertas hasta (segundos)", config.duracion_llegadas, 1.0, 86400.0);
+        config.tiempo_maximo = leer_double_validado(
+            "Tiempo máximo de simulación (segundos)", config.tiempo_maximo, 1.0, 864000.0);
+        config.paso_simulacion = leer_double_validado(
+            "Paso de simulación (segundos)", config.paso_simulacion, 0.05, 1.0);
+        config.proporcion_giro = leer_double_validado(
+            "Proporción de vehículos que giran una vez", config.proporcion_giro, 0.0, 1.0);
+        config.verde_ns = leer_double_validado("Verde Norte-Sur (segundos)", config.verde_ns, 5.0, 300.0);
+        config.verde_eo = leer_double_validado("Verde Este-Oeste (segundos)", config.verde_eo, 5.0, 300.0);
+        config.transicion = leer_double_validado("Transición (segundos)", config.transicion, 1.0, 30.0);
+        config.desfase_onda = leer_double_validado(
+            "Desfase entre intersecciones vecinas (segundos)", config.desfase_onda, 0.0, 300.0);
+        config.variacion_plan = leer_double_validado(
+            "Variación de los verdes entre intersecciones (fracción)", config.variacion_plan, 0.0, 0.5);
+        config.num_hilos = leer_entero_validado(
+            "Threads / regiones (0 = los de OMP_NUM_THREADS o todos los núcleos)", config.num_hilos, 0, MAX_HILOS);
+        config.replicas = leer_entero_validado(
+            "Réplicas independientes (1 = una corrida repartida en regiones)", config.replicas, 1, MAX_REPLICAS);
+        config.semilla = leer_entero_validado(
+            "Flujo aleatorio de la primera réplica", config.semilla, 0, 1000000000);
+    }
+
+    printf("\n=== CONFIGURACIÓN FINAL ===\n");
+    printf("Red: %d x %d intersecciones, tramos de %.1f m con %d carriles por sentido\n",
+           config.filas, config.columnas, config.longitud_tramo, config.carriles);
+    printf("Llegadas cada %.2f s por tramo de entrada hasta t = %.0f s (máximo %.0f s)\n",
+           config.intervalo_entrada, config.duracion_llegadas, config.tiempo_maximo);
+    printf("Paso de simulación: %.3f s\n", config.paso_simulacion);
+    printf("Giran una vez: %.0f%%\n", config.proporcion_giro * 100.0);
+    printf("Semáforos: NS %.1f s, EO %.1f s, transición %.1f s, desfase %.1f s, variación %.0f%%\n",
+           config.verde_ns, config.verde_eo, config.transicion, config.desfase_onda, config.variacion_plan * 100.0);
+    if (config.replicas > 1) {
+        printf("Réplicas: %d, flujos %d a %d, una por thread a la vez\n",
+               config.replicas, config.semilla, config.semilla + config.replicas - 1);
+    } else {
+        printf("Flujo aleatorio: %d\n", config.semilla);
+    }
+}
+
+int validar_configuracion_red() {
+    int errores = 0;
+    if (config.duracion_llegadas > config.tiempo_maximo) {
+        fprintf(stderr, "ERROR: Las llegadas no pueden durar más que el tiempo máximo (%.0f > %.0f)\n",
+                config.duracion_llegadas, config.tiempo_maximo);
+        errores++;
+    }
+    // El primero de un tramo no debe pasar la línea en un paso sin haberla visto
+    if (params.velocidad_maxima * config.paso_simulacion >= params.longitud_vehiculo + params.distancia_seguridad_min) {
+        fprintf(stderr, "ERROR: El paso de simulación es demasiado largo para la velocidad máxima\n");
+        errores++;
+    }
+    if (errores > 0) fprintf(stderr, "\nSe encontraron %d errores en la configuración.\n", errores);
+    return errores == 0;
+}
+
+// ============================================================================
+// FUNCIÓN PRINCIPAL
+// ============================================================================
+
+int main() {
+    printf("=== SIMULACIÓN DE RED EN CUADRÍCULA CON PARALELISMO OpenMP ===\n");
+    printf("Características:\n");
+    printf("- Intersecciones semaforizadas en F x C, cada una con su plan\n");
+    printf("- Recorridos por varias intersecciones con un giro\n");
+    printf("- Tramos de varios carriles con cambios de carril MOBIL\n");
+    printf("- Regiones por bandas de filas con buzones de traspaso\n");
+    printf("- Estadísticas en flujo fusionadas por región\n");
+    printf("- Réplicas independientes en paralelo con intervalos de confianza\n\n");
+
+    configurar_red();
+    if (!validar_configuracion_red()) {
+        fprintf(stderr, "Configuración inválida. Terminando.\n");
+        return 1;
+    }
+
+    if (config.num_hilos > 0) omp_set_num_threads(config.num_hilos);
+    printf("Configurando OpenMP con %d threads (%d núcleos disponibles)\n",
+           omp_get_max_threads(), omp_get_num_procs());
+
+    if (config.replicas > 1) {
+        ResultadoReplica* resultados = (ResultadoReplica*)calloc(config.replicas, sizeof(ResultadoReplica));
+        if (!resultados) {
+            fprintf(stderr, "ERROR: Sin memoria para las réplicas\n");
+            return 1;
+        }
+        printf("Iniciando %d réplicas, %d a la vez...\n\n", config.replicas, omp_get_max_threads());
+        double inicio = omp_get_wtime();
+        ejecutar_replicas(resultados);
+        generar_estadisticas_replicas(resultados, omp_get_wtime() - inicio);
+        free(resultados);
+        printf("\nRéplicas de la red completadas exitosamente.\n");
+        return 0;
+    }
+
+    fijar_flujo(config.semilla);
+    if (!preparar_red(omp_get_max_threads())) {
+        fprintf(stderr, "ERROR: Sin memoria para la red\n");
+        return 1;
+    }
+    printf("Memoria de tramos: %.1f MB (%d vehículos por carril)\n",
+           (double)tramos.num_carriles * tramos.capacidad * (2 * sizeof(double) + sizeof(Vehiculo*)) / (1024.0 * 1024.0),
+           tramos.capacidad);
+
+    printf("Iniciando simulación de la red...\n\n");
+    double inicio = omp_get_wtime();
+    simular_red();
+    double tiempo_ejecucion = omp_get_wtime() - inicio;
+
+    generar_estadisticas_red(tiempo_ejecucion);
+
+    liberar_red();
+
+    printf("\nSimulación de la red completada exitosamente.\n");
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lectorTrazas.h"
+
+// ============================================================================
+// EXPORTADOR DE TRAZAS BINARIAS (.trz) A CSV
+// ============================================================================
+//
+// Reconstruye el CSV de estados que escribirían estados2.c o paraleloPrueba.c
+// a partir del encabezado del archivo (columnas y nombres de los enums).
+// Los valores ya vienen en centésimas redondeadas como "%.2f", así que se
+// formatean como enteros sin volver a pasar por printf.
+//
+// Compilar: gcc -O2 -o trazaACsv trazaACsv.c -pthread -lm
+// Uso:      ./trazaACsv estados_AAAAMMDD_HHMMSS.trz [salida.csv]
+
+void escribir_entrada(const LectorTrazas* l, const EntradaTraza* e, void* contexto) {
+    lector_trazas_escribir_csv(l, e, (FILE*)contexto);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s archivo.trz [salida.csv]\n", argv[0]);
+        return 1;
+    }
+
+    LectorTrazas lector;
+    if (!lector_trazas_abrir(&lector, argv[1], LECTOR_SIN_INDICE) ||
+        lector.formato != FORMATO_TRAZA_BINARIO) {
+        fprintf(stderr, "ERROR: %s no es una traza binaria válida\n", argv[1]);
+        lector_trazas_cerrar(&lector);
+        return 1;
+    }
+
+    // Salida: argumento o mismo nombre con extensión .csv
+    char nombre_salida[1024];
+    if (argc >= 3) {
+        snprintf(nombre_salida, sizeof(nombre_salida), "%s", argv[2]);
+    } else {
+        snprintf(nombre_salida, sizeof(nombre_salida), "%s", argv[1]);
+        char* punto = strrchr(nombre_salida, '.');
+        if (punto) *punto = '\0';
+        strncat(nombre_salida, ".csv", sizeof(nombre_salida) - strlen(nombre_salida) - 1);
+    }
+
+    // Binario: el CSV sale con los mismos bytes ('\n') en todas las plataformas
+    FILE* salida = fopen(nombre_salida, "wb");
+    if (!salida) {
+        perror(nombre_salida);
+        lector_trazas_cerrar(&lector);
+        return 1;
+    }
+    setvbuf(salida, NULL, _IOFBF, 1 << 20);
+    fprintf(salida, "%s\n", lector.columnas_csv);
+
+    clock_t inicio = clock();
+    long long total = lector_trazas_recorrer(&lector, escribir_entrada, salida);
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    fclose(salida);
+    lector_trazas_cerrar(&lector);
+
+    printf("%lld registros exportados a %s en %.2f s\n", total, nombre_salida, segundos);
+    return 0;
+}
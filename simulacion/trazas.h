@@ -0,0 +1,402 @@
+#ifndef TRAZAS_H
+#define TRAZAS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+
+// ============================================================================
+// ESCRITOR ASÍNCRONO DE TRAZAS
+// ============================================================================
+//
+// Cada hilo productor agrega registros a su propio bloque (solo memcpy, sin
+// locks ni syscalls). Los bloques llenos pasan a un hilo escritor que hace
+// escrituras grandes y secuenciales. El número de bloques es fijo: si el
+// escritor se atrasa, el productor espera a que se libere uno (contrapresión)
+// en vez de consumir más memoria.
+//
+// Dentro de un bloque los registros conservan su orden; entre hilos el archivo
+// queda intercalado por bloques, así que cada registro debe identificarse solo
+// (tiempo, id). num_hilos es el número de productores (hilo 0..num_hilos-1)
+// y dimensiona el pool de bloques.
+//
+// Uso compartido por estados2.c, paraleloPrueba.c y las herramientas de
+// trazas; enlazar con -pthread.
+
+#define TRAZA_TAM_BLOQUE (1 << 20)      // 1 MiB por bloque
+#define TRAZA_BLOQUES_POR_HILO 4
+#define TRAZA_MAX_HILOS 64              // Productores con bloques de repuesto propios
+
+typedef struct {
+    char* datos;
+    size_t usado;
+} BloqueTraza;
+
+typedef struct {
+    FILE* archivo;
+    pthread_t hilo;
+    pthread_mutex_t mutex;
+    pthread_cond_t hay_llenos;
+    pthread_cond_t hay_libres;
+
+    BloqueTraza* bloques;         // Pool fijo de bloques
+    int num_bloques;
+    int* libres;                  // Pila de índices de bloques libres
+    int num_libres;
+    int* llenos;                  // Cola circular de bloques por escribir
+    int inicio_llenos;
+    int num_llenos;
+    int* actual;                  // Bloque en uso por cada productor (-1 = ninguno)
+    int num_hilos;                // Productores
+    int terminar;
+    int sincrono;                 // Sin hilo escritor: los productores escriben cada bloque
+
+    // Estadísticas
+    size_t bytes_escritos;
+    int escrituras;
+    int esperas;                  // Veces que un productor esperó un bloque libre
+} EscritorTrazas;
+
+static inline void* escritor_trazas_hilo(void* arg) {
+    EscritorTrazas* t = (EscritorTrazas*)arg;
+
+    while (1) {
+        pthread_mutex_lock(&t->mutex);
+        while (t->num_llenos == 0 && !t->terminar) {
+            pthread_cond_wait(&t->hay_llenos, &t->mutex);
+        }
+        if (t->num_llenos == 0) {
+            pthread_mutex_unlock(&t->mutex);
+            break;
+        }
+        int b = t->llenos[t->inicio_llenos];
+        t->inicio_llenos = (t->inicio_llenos + 1) % t->num_bloques;
+        t->num_llenos--;
+        pthread_mutex_unlock(&t->mutex);
+
+        // La escritura se hace sin el mutex para no frenar a los productores
+        size_t escritos = fwrite(t->bloques[b].datos, 1, t->bloques[b].usado, t->archivo);
+
+        pthread_mutex_lock(&t->mutex);
+        t->bytes_escritos += escritos;
+        t->escrituras++;
+        t->bloques[b].usado = 0;
+        t->libres[t->num_libres++] = b;
+        pthread_cond_signal(&t->hay_libres);
+        pthread_mutex_unlock(&t->mutex);
+    }
+
+    return NULL;
+}
+
+// Abre el archivo y arranca el hilo escritor; devuelve 0 si falla
+static inline int escritor_trazas_abrir(EscritorTrazas* t, const char* ruta, int num_hilos) {
+    memset(t, 0, sizeof(*t));
+
+    if (num_hilos < 1) num_hilos = 1;
+
+    t->archivo = fopen(ruta, "wb");
+    if (!t->archivo) return 0;
+
+    // Un bloque en uso por productor más los de repuesto, que dejan de
+    // crecer pasados TRAZA_MAX_HILOS productores
+    int con_repuesto = (num_hilos < TRAZA_MAX_HILOS) ? num_hilos : TRAZA_MAX_HILOS;
+    t->num_hilos = num_hilos;
+    t->num_bloques = num_hilos + con_repuesto * (TRAZA_BLOQUES_POR_HILO - 1);
+    t->bloques = (BloqueTraza*)calloc(t->num_bloques, sizeof(BloqueTraza));
+    t->libres = (int*)malloc(t->num_bloques * sizeof(int));
+    t->llenos = (int*)malloc(t->num_bloques * sizeof(int));
+    t->actual = (int*)malloc(num_hilos * sizeof(int));
+    if (!t->bloques || !t->libres || !t->llenos || !t->actual) {
+        fclose(t->archivo);
+        free(t->bloques);
+        free(t->libres);
+        free(t->llenos);
+        free(t->actual);
+        return 0;
+    }
+
+    for (int b = 0; b < t->num_bloques; b++) {
+        t->bloques[b].datos = (char*)malloc(TRAZA_TAM_BLOQUE);
+        if (!t->bloques[b].datos) {
+            // Con menos bloques el escritor sigue funcionando, solo espera más
+            break;
+        }
+        t->libres[t->num_libres++] = b;
+    }
+    if (t->num_libres == 0) {
+        fclose(t->archivo);
+        free(t->bloques);
+        free(t->libres);
+        free(t->llenos);
+        free(t->actual);
+        return 0;
+    }
+    for (int h = 0; h < num_hilos; h++) {
+        t->actual[h] = -1;
+    }
+
+    pthread_mutex_init(&t->mutex, NULL);
+    pthread_cond_init(&t->hay_llenos, NULL);
+    pthread_cond_init(&t->hay_libres, NULL);
+    if (pthread_create(&t->hilo, NULL, escritor_trazas_hilo, t) != 0) {
+        fprintf(stderr, "ADVERTENCIA: Sin hilo escritor de trazas; se escribirán en el momento\n");
+        t->sincrono = 1;
+    }
+
+    return 1;
+}
+
+// Escribe directamente al inicio del archivo (encabezados). Solo es válido
+// antes del primer registro: así queda delante de cualquier bloque.
+static inline void escritor_trazas_encabezado(EscritorTrazas* t, const void* datos, size_t n) {
+    size_t escritos = fwrite(datos, 1, n, t->archivo);
+    pthread_mutex_lock(&t->mutex);
+    t->bytes_escritos += escritos;
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static inline void escritor_trazas_enviar(EscritorTrazas* t, int b) {
+    pthread_mutex_lock(&t->mutex);
+    if (t->sincrono) {
+        // Con el mutex, para que los bloques no se mezclen en el archivo
+        t->bytes_escritos += fwrite(t->bloques[b].datos, 1, t->bloques[b].usado, t->archivo);
+        t->escrituras++;
+        t->bloques[b].usado = 0;
+        t->libres[t->num_libres++] = b;
+        pthread_mutex_unlock(&t->mutex);
+        return;
+    }
+    t->llenos[(t->inicio_llenos + t->num_llenos) % t->num_bloques] = b;
+    t->num_llenos++;
+    pthread_cond_signal(&t->hay_llenos);
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static inline int escritor_trazas_tomar_libre(EscritorTrazas* t) {
+    pthread_mutex_lock(&t->mutex);
+    if (t->num_libres == 0) {
+        t->esperas++;
+        while (t->num_libres == 0) {
+            pthread_cond_wait(&t->hay_libres, &t->mutex);
+        }
+    }
+    int b = t->libres[--t->num_libres];
+    pthread_mutex_unlock(&t->mutex);
+    return b;
+}
+
+// Devuelve espacio para n bytes (n <= TRAZA_TAM_BLOQUE) en el bloque del hilo.
+// Cada valor de 'hilo' (0..num_hilos-1) debe usarlo un solo productor.
+static inline char* escritor_trazas_reservar(EscritorTrazas* t, int hilo, size_t n) {
+    if (hilo < 0 || hilo >= t->num_hilos) {
+        fprintf(stderr, "ERROR: Productor de trazas %d fuera de rango (se abrieron %d)\n", hilo, t->num_hilos);
+        abort();
+    }
+    int b = t->actual[hilo];
+
+    if (b < 0 || t->bloques[b].usado + n > TRAZA_TAM_BLOQUE) {
+        if (b >= 0) escritor_trazas_enviar(t, b);
+        b = escritor_trazas_tomar_libre(t);
+        t->actual[hilo] = b;
+    }
+
+    char* destino = t->bloques[b].datos + t->bloques[b].usado;
+    t->bloques[b].usado += n;
+    return destino;
+}
+
+static inline void escritor_trazas_escribir(EscritorTrazas* t, int hilo, const void* datos, size_t n) {
+    memcpy(escritor_trazas_reservar(t, hilo, n), datos, n);
+}
+
+// Vacía los bloques de todos los hilos, espera al escritor y cierra el archivo.
+// Llamar cuando ya no hay productores activos.
+static inline void escritor_trazas_cerrar(EscritorTrazas* t) {
+    if (!t->archivo) return;
+
+    for (int h = 0; h < t->num_hilos; h++) {
+        int b = t->actual[h];
+        if (b >= 0 && t->bloques[b].usado > 0) {
+            escritor_trazas_enviar(t, b);
+        }
+        t->actual[h] = -1;
+    }
+
+    if (!t->sincrono) {
+        pthread_mutex_lock(&t->mutex);
+        t->terminar = 1;
+        pthread_cond_signal(&t->hay_llenos);
+        pthread_mutex_unlock(&t->mutex);
+        pthread_join(t->hilo, NULL);
+    }
+
+    fclose(t->archivo);
+    t->archivo = NULL;
+
+    for (int b = 0; b < t->num_bloques; b++) {
+        free(t->bloques[b].datos);
+    }
+    free(t->bloques);
+    free(t->libres);
+    free(t->llenos);
+    free(t->actual);
+    t->actual = NULL;
+    pthread_mutex_destroy(&t->mutex);
+    pthread_cond_destroy(&t->hay_llenos);
+    pthread_cond_destroy(&t->hay_libres);
+}
+
+// ============================================================================
+// FORMATO BINARIO DE TRAZAS (.trz)
+// ============================================================================
+//
+// [EncabezadoTraza][texto clave=valor][relleno hasta tam_encabezado][registros]
+//
+// El texto describe la simulación (configuración) y los nombres de los enums,
+// para que trazaACsv pueda reconstruir el CSV sin conocer el simulador:
+//   simulador=calle
+//   csv_columnas=Tiempo,ID,Posicion,Velocidad,Aceleracion,EstadoVehiculo,Semaforo
+//   estados=ENTRANDO,ACELERANDO,...
+//   semaforo=VERDE,AMARILLO,ROJO
+//   paso_simulacion=0.05
+// Los registros son de ancho fijo (el número sale del tamaño del archivo) y se
+// guardan en el orden de bytes de la máquina (little-endian en x86/ARM).
+//
+// Tiempo, posición, velocidad y aceleración se guardan en centésimas enteras,
+// redondeadas igual que printf("%.2f"): el CSV exportado es idéntico byte a
+// byte al que se escribe directamente (salvo un "-0.00", que sale como "0.00")
+// y el registro ocupa 28 bytes.
+
+#define FORMATO_TRAZA_CSV 0
+#define FORMATO_TRAZA_BINARIO 1
+
+#define TRAZA_MAGIA "TRZSIM01"
+#define TRAZA_VERSION 2
+#define TRAZA_ALINEACION_ENCABEZADO 64
+#define TRAZA_MAX_TEXTO 4096
+
+typedef struct {
+    char magia[8];
+    uint32_t version;
+    uint32_t tam_encabezado;   // Bytes hasta el primer registro
+    uint32_t tam_registro;     // sizeof(RegistroTraza)
+    uint32_t tam_texto;        // Bytes de texto que siguen a esta estructura
+} EncabezadoTraza;
+
+typedef struct {
+    int32_t tiempo;            // Centésimas de segundo
+    int32_t id;
+    int32_t posicion;          // Centésimas de metro
+    int32_t velocidad;         // Centésimas de m/s
+    int32_t aceleracion;       // Centésimas de m/s²
+    uint16_t hilo;             // Thread que hizo la actualización (hasta MAX_HILOS)
+    uint8_t estado;            // Índice en la lista 'estados' del encabezado
+    uint8_t semaforo;          // Índice en la lista 'semaforo'
+    uint8_t direccion;         // Índice en la lista 'direcciones' (0 si no aplica)
+    uint8_t reserva[3];        // Sin relleno implícito; siempre 0
+} RegistroTraza;
+
+// Redondea x a centésimas como printf("%.2f"): al más cercano y empates al
+// par. fma da el error exacto de x*100 para decidir los casos en el límite.
+static inline int32_t traza_centesimas(double x) {
+    double y = x * 100.0;
+    double error = fma(x, 100.0, -y);
+    double piso = floor(y);
+    double fraccion = y - piso;
+    int64_t r = (int64_t)piso;
+
+    if (fraccion > 0.5 ||
+        (fraccion == 0.5 && (error > 0.0 || (error == 0.0 && (r & 1))))) {
+        r++;
+    }
+    return (int32_t)r;
+}
+
+static inline double traza_desde_centesimas(int32_t c) {
+    return c / 100.0;
+}
+
+// Escribe c centésimas como "%.2f" (sin pasar por double); devuelve la longitud
+static inline int traza_formatear_centesimas(char* destino, int32_t c) {
+    int n = 0;
+    int64_t v = c;
+    if (v < 0) {
+        destino[n++] = '-';
+        v = -v;
+    }
+    char entero[24];
+    int largo = 0;
+    int64_t parte = v / 100;
+    do {
+        entero[largo++] = (char)('0' + parte % 10);
+        parte /= 10;
+    } while (parte > 0);
+    while (largo > 0) destino[n++] = entero[--largo];
+    destino[n++] = '.';
+    destino[n++] = (char)('0' + (v % 100) / 10);
+    destino[n++] = (char)('0' + v % 10);
+    destino[n] = '\0';
+    return n;
+}
+
+// Escribe el encabezado binario con el texto de descripción dado
+static inline void escritor_trazas_encabezado_binario(EscritorTrazas* t, const char* texto) {
+    EncabezadoTraza e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magia, TRAZA_MAGIA, 8);
+    e.version = TRAZA_VERSION;
+    e.tam_registro = sizeof(RegistroTraza);
+    e.tam_texto = (uint32_t)strlen(texto);
+    e.tam_encabezado = (uint32_t)((sizeof(e) + e.tam_texto + TRAZA_ALINEACION_ENCABEZADO - 1) /
+                                  TRAZA_ALINEACION_ENCABEZADO * TRAZA_ALINEACION_ENCABEZADO);
+
+    char relleno[TRAZA_ALINEACION_ENCABEZADO] = {0};
+    escritor_trazas_encabezado(t, &e, sizeof(e));
+    escritor_trazas_encabezado(t, texto, e.tam_texto);
+    escritor_trazas_encabezado(t, relleno, e.tam_encabezado - sizeof(e) - e.tam_texto);
+}
+
+// Agrega un registro (28 bytes) al bloque del hilo
+static inline void escritor_trazas_registro(EscritorTrazas* t, int hilo, const RegistroTraza* r) {
+    memcpy(escritor_trazas_reservar(t, hilo, sizeof(*r)), r, sizeof(*r));
+}
+
+// Valida el encabezado leído de un archivo .trz y copia el texto
+// (terminado en '\0') en 'texto'. Devuelve 0 si el formato no es válido.
+static inline int traza_validar_encabezado(const EncabezadoTraza* e, const char* texto_origen,
+                                    char* texto, size_t tam_texto) {
+    if (memcmp(e->magia, TRAZA_MAGIA, 8) != 0) return 0;
+    if (e->version != TRAZA_VERSION || e->tam_registro != sizeof(RegistroTraza)) return 0;
+    if (e->tam_texto >= tam_texto || sizeof(*e) + e->tam_texto > e->tam_encabezado) return 0;
+
+    memcpy(texto, texto_origen, e->tam_texto);
+    texto[e->tam_texto] = '\0';
+    return 1;
+}
+
+// Copia en 'valor' el valor de 'clave' en el texto del encabezado; 0 si no está
+static inline int traza_valor(const char* texto, const char* clave, char* valor, size_t tam_valor) {
+    size_t largo = strlen(clave);
+    const char* linea = texto;
+
+    while (linea && *linea) {
+        if (strncmp(linea, clave, largo) == 0 && linea[largo] == '=') {
+            const char* inicio = linea + largo + 1;
+            const char* fin = strchr(inicio, '\n');
+            size_t n = fin ? (size_t)(fin - inicio) : strlen(inicio);
+            if (n >= tam_valor) n = tam_valor - 1;
+            memcpy(valor, inicio, n);
+            valor[n] = '\0';
+            return 1;
+        }
+        linea = strchr(linea, '\n');
+        if (linea) linea++;
+    }
+    return 0;
+}
+
+#endif